@@ -16,8 +16,9 @@
 #include <minizinc/hash.hh>
 #include <minizinc/stl_map_set.hh>
 #include <minizinc/utils.hh>
+#include <algorithm>
 #include <array>
-#include <set>
+#include <vector>
 
 #ifdef _MSC_VER 
 #define _CRT_SECURE_NO_WARNINGS
@@ -124,15 +125,38 @@ namespace MiniZinc {
     return os;
   }
   
+  /// A set of closed intervals kept sorted by left end in a contiguous vector.
+  /// Intervals with equal left ends keep their insertion order, as in a multiset
   template <class N>
-  class SetOfIntervals : public std::multiset<Interval<N> > {
+  class SetOfIntervals : public std::vector<Interval<N> > {
   public:
-    typedef std::multiset<Interval<N> > Base;
+    typedef std::vector<Interval<N> > Base;
     typedef typename Base::iterator iterator;
+    typedef typename Base::const_iterator const_iterator;
     SetOfIntervals() : Base() { }
-    SetOfIntervals(std::initializer_list<Interval<N> > il) : Base( il )  { }
+    SetOfIntervals(std::initializer_list<Interval<N> > il) : Base( il )
+      { std::stable_sort( this->begin(), this->end() ); }
     template <class Iter>
-    SetOfIntervals( Iter i1, Iter i2 ) : Base( i1, i2 )  { }
+    SetOfIntervals( Iter i1, Iter i2 ) : Base( i1, i2 )
+      { std::stable_sort( this->begin(), this->end() ); }
+    /// Insert after all intervals with the same left end
+    iterator insert(const Interval<N>& intv) {
+      return Base::insert( upper_bound( intv ), intv );
+    }
+    /// First interval with left end >= intv.left
+    iterator lower_bound(const Interval<N>& intv) {
+      return std::lower_bound( this->begin(), this->end(), intv );
+    }
+    const_iterator lower_bound(const Interval<N>& intv) const {
+      return std::lower_bound( this->begin(), this->end(), intv );
+    }
+    /// First interval with left end > intv.left
+    iterator upper_bound(const Interval<N>& intv) {
+      return std::upper_bound( this->begin(), this->end(), intv );
+    }
+    const_iterator upper_bound(const Interval<N>& intv) const {
+      return std::upper_bound( this->begin(), this->end(), intv );
+    }
     template <class N1>
     void intersect(const SetOfIntervals<N1>& s2);
     /// Assumes open intervals to cut out from closed
@@ -146,8 +170,6 @@ namespace MiniZinc {
     }
     /// Cut out an open interval from a set of closed ones (except for infinities)
     void cutOut(const Interval<N>& intv);
-    typedef std::pair<iterator, iterator> SplitResult;
-    SplitResult split(iterator& it, N pos);
     bool checkFiniteBounds();
     bool checkDisjunctStrict();
     Interval<N> getBounds() const;
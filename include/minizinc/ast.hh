@@ -137,12 +137,14 @@ namespace MiniZinc {
    */
   class Expression : public ASTNode {
   protected:
+    /// The %MiniZinc type of the expression (placed here to fill alignment padding)
+    Type _type;
     /// The annotations
     Annotation _ann;
     /// The location of the expression
     Location _loc;
-    /// The %MiniZinc type of the expression
-    Type _type;
+    /// Second half of the structural fingerprint (only used by ArrayLit)
+    mutable unsigned long long _fp;
     /// The hash value of the expression
     size_t _hash;
   public:
@@ -192,7 +194,7 @@ namespace MiniZinc {
 
     /// Constructor
     Expression(const Location& loc, const ExpressionId& eid, const Type& t)
-      : ASTNode(eid), _loc(loc), _type(t) {}
+      : ASTNode(eid), _type(t), _loc(loc) {}
 
   public:
     bool isUnboxedInt(void) const {
@@ -493,6 +495,8 @@ namespace MiniZinc {
     ASTExprVec<Expression> _v;
     /// The declared array dimensions
     ASTIntVec _dims;
+    /// Compute the fingerprint
+    void computeFingerprint(void) const;
   public:
     /// The identifier of this expression type
     static const ExpressionId eid = E_ARRAYLIT;
@@ -518,8 +522,8 @@ namespace MiniZinc {
     
     /// Access value
     ASTExprVec<Expression> v(void) const { return _v; }
-    /// Set value
-    void v(const ASTExprVec<Expression>& val) { _v = val; }
+    /// Set value (the fingerprint is recomputed on demand)
+    void v(const ASTExprVec<Expression>& val) { _v = val; _flag_2 = false; }
 
     /// Return number of dimensions
     int dims(void) const;
@@ -529,12 +533,25 @@ namespace MiniZinc {
     int max(int i) const;
     /// Return the length of the array
     int length(void) const;
-    /// Set dimension vector
-    void setDims(ASTIntVec dims) { _dims = dims; }
+    /// Set dimension vector (the fingerprint is recomputed on demand)
+    void setDims(ASTIntVec dims) { _dims = dims; _flag_2 = false; }
+    /// Recompute the fingerprint on demand (after elements of v() were replaced in place)
+    void invalidateFingerprint(void) { _flag_2 = false; }
     /// Check if this array was produced by flattening
     bool flat(void) const { return _flag_1; }
     /// Set whether this array was produced by flattening
     void flat(bool b) { _flag_1 = b; }
+    /// Check if the array only contains integer and Boolean literals
+    bool ground(void) const {
+      if (!_flag_2)
+        computeFingerprint();
+      return _fp != 0;
+    }
+    /// Check if ground arrays \a a0 and \a a1 have the same fingerprint
+    /// (necessary, but not sufficient for equality)
+    static bool sameFingerprint(const ArrayLit* a0, const ArrayLit* a1) {
+      return a0->_hash==a1->_hash && a0->_fp==a1->_fp;
+    }
   };
   /// \brief Array access expression
   class ArrayAccess : public Expression {
@@ -1431,6 +1448,7 @@ namespace MiniZinc {
         ASTString set_eq;
         ASTString set_in;
         ASTString set_card;
+        ASTString array_int_element;
         
         ASTString introduced_var;
       } ids;
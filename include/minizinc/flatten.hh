@@ -27,6 +27,9 @@ namespace MiniZinc {
     }
   };
 
+  class PhaseProfile;
+  class FlatteningProfiler;
+
   /// Options for the flattener
   struct FlatteningOptions {
     /// Keep output in resulting flat model
@@ -37,9 +40,13 @@ namespace MiniZinc {
     enum OutputMode {
       OUTPUT_ITEM, OUTPUT_DZN, OUTPUT_JSON
     } outputMode;
+    /// Record output model generation as a separate phase, if not NULL
+    PhaseProfile* profile;
+    /// Attribute the cost of flattening to source locations and functions, if not NULL
+    FlatteningProfiler* profiler;
     /// Default constructor
     FlatteningOptions(void)
-    : keepOutputInFzn(false), onlyRangeDomains(false), outputMode(OUTPUT_ITEM) {}
+    : keepOutputInFzn(false), onlyRangeDomains(false), outputMode(OUTPUT_ITEM), profile(NULL), profiler(NULL) {}
   };
   
   /// Flatten model \a m
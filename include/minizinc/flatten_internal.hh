@@ -63,6 +63,8 @@ namespace MiniZinc {
   /// Negate context \a c
   BCtx operator -(const BCtx& c);
   
+  class FlatteningProfiler;
+
   class EnvI {
   public:
     Model* orig;
@@ -87,6 +89,8 @@ namespace MiniZinc {
     std::vector<int> modifiedVarDecls;
     int in_redundant_constraint;
     int in_maybe_partial;
+    /// Profiler notified of the call stack, new items and CSE hits, or NULL
+    FlatteningProfiler* profiler;
   protected:
     Map map;
     Model* _flat;
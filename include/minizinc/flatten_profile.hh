@@ -0,0 +1,139 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __MINIZINC_FLATTEN_PROFILE_HH__
+#define __MINIZINC_FLATTEN_PROFILE_HH__
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <minizinc/ast.hh>
+#include <minizinc/stl_map_set.hh>
+#include <minizinc/timer.hh>
+
+namespace MiniZinc {
+
+  /// Attributes the cost of flattening to source locations and functions.
+  ///
+  /// The profiler follows the call stack of the flattener (CallStackItem): a
+  /// call of a function is a frame, and so is the expression that starts the
+  /// flattening of a top-level item. For every function and every source
+  /// location of such a frame it records the number of calls, the time, the
+  /// FlatZinc variables and constraints that were generated and the hits in
+  /// the common subexpression table, both inclusive and exclusive of the frames
+  /// called from it. Recursive frames count only once for the inclusive values.
+  /// The stacks of the folded output start with the location of the item.
+  class FlatteningProfiler {
+  public:
+    struct Cost {
+      double ms = 0.0;
+      unsigned long long int vars = 0;
+      unsigned long long int constraints = 0;
+      unsigned long long int cseHits = 0;
+    };
+    struct Entry {
+      std::string name;
+      unsigned long long int calls = 0;
+      Cost incl;
+      Cost excl;
+      /// Number of active frames, for recursion
+      unsigned int active = 0;
+    };
+
+    FlatteningProfiler(void);
+    /// Starts and stops the measurement of the whole flattening
+    void start(void);
+    void stop(void);
+
+    /// Called when \a e is pushed on the call stack
+    void enter(const Expression* e);
+    /// Called when a comprehension generator is pushed on the call stack
+    void enterGenerator(void);
+    /// Called when the top of the call stack is popped
+    void leave(void);
+    /// Called when an item is added to the flat model
+    void addedItem(const Item* i) {
+      if (i->isa<VarDeclI>())
+        _vars++;
+      else if (i->isa<ConstraintI>())
+        _constraints++;
+    }
+    /// Called on a hit in the common subexpression table
+    void cseHit(void) { _cseHits++; }
+
+    const std::vector<Entry>& functions(void) const { return _functions; }
+    const std::vector<Entry>& locations(void) const { return _locations; }
+    /// Writes the functions and locations, sorted by inclusive time
+    void printReport(std::ostream& os) const;
+    /// Writes the exclusive time of each stack of frames in microseconds, one
+    /// line per stack in the folded format of flame graph tools
+    void printFolded(std::ostream& os) const;
+  private:
+    struct Node {
+      unsigned int parent;
+      std::string name;
+      double ms;
+      UNORDERED_NAMESPACE::unordered_map<uint64_t,unsigned int> children;
+      Node(unsigned int parent0, const std::string& name0)
+        : parent(parent0), name(name0), ms(0.0) {}
+    };
+    struct Frame {
+      /// Index into _functions, or NONE for top-level items and non-frames
+      unsigned int fn;
+      /// Index into _locations, or NONE for non-frames
+      unsigned int loc;
+      unsigned int node;
+      double start;
+      Cost startCost;
+      /// Inclusive cost of the frames called from this one
+      Cost children;
+    };
+    static const unsigned int NONE = 0xFFFFFFFFu;
+
+    Timer _timer;
+    double _startMs;
+    double _totalMs;
+    unsigned long long int _vars;
+    unsigned long long int _constraints;
+    unsigned long long int _cseHits;
+    std::vector<Entry> _functions;
+    std::vector<Entry> _locations;
+    UNORDERED_NAMESPACE::unordered_map<const FunctionI*,unsigned int> _fnIdx;
+    UNORDERED_NAMESPACE::unordered_map<uint64_t,unsigned int> _locIdx;
+    std::vector<std::string> _files;
+    UNORDERED_NAMESPACE::unordered_map<std::string,unsigned int> _fileIdx;
+    /// Recently seen file name strings, checked by content as they may be
+    /// collected and their memory reused
+    struct FileCache {
+      const char* s;
+      unsigned int idx;
+    } _fileCache[64];
+    std::vector<Node> _nodes;
+    std::vector<Frame> _stack;
+    /// Number of frames (as opposed to other expressions) on the stack
+    unsigned int _nFrames;
+
+    Cost now(void) const;
+    unsigned int file(const ASTString& f);
+    unsigned int location(const Location& loc);
+    unsigned int function(const FunctionI* fi);
+    /// Returns the child of \a node for \a key, creating it with \a name
+    unsigned int child(unsigned int node, uint64_t key, const std::string& name);
+    void printEntries(std::ostream& os, const std::string& title,
+                      const std::vector<Entry>& entries) const;
+  };
+
+}
+
+#endif
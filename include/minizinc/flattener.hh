@@ -31,6 +31,9 @@
 #include <minizinc/builtins.hh>
 #include <minizinc/utils.hh>
 #include <minizinc/file_utils.hh>
+#include <minizinc/fzn_binary.hh>
+#include <minizinc/phase_profile.hh>
+#include <minizinc/flatten_profile.hh>
 #include <minizinc/solver_instance.hh>
 #include <minizinc/options.hh>
 
@@ -58,6 +61,10 @@ namespace MiniZinc {
     virtual void set_flag_statistics(bool f) { flag_statistics = f; }
     virtual bool get_flag_statistics() const { return flag_statistics; }
     virtual Env* getEnv() const { assert(pEnv.get()); return pEnv.get(); }
+    /// Collects the resources of each phase, also without --profile-json
+    virtual void set_flag_profile(bool f) { flag_profile = f; }
+    /// The resources of each phase of the last flatten(), NULL if not collected
+    const PhaseProfile* getProfile() const { return profile.get(); }
     
     SolverInstance::Status status = SolverInstance::UNKNOWN;
     
@@ -68,6 +75,7 @@ namespace MiniZinc {
     std::vector<std::string> datafiles;
     std::vector<std::string> includePaths;
     bool is_flatzinc = false;
+    bool is_fzb = false;
 
     bool flag_ignoreStdlib = false;
     bool flag_typecheck = true;
@@ -89,14 +97,28 @@ namespace MiniZinc {
     std::string flag_output_ozn;
     bool flag_output_fzn_stdout = false;
     bool flag_output_ozn_stdout = false;
+    std::string flag_output_fzb;
+    bool flag_profile = false;
+    std::string flag_profile_json;
+    std::string flag_profile_flattening;
+    std::string flag_profile_folded;
     bool flag_instance_check_only = false;
     bool flag_model_check_only = false;
     bool flag_model_interface_only = false;
     FlatteningOptions::OutputMode flag_output_mode = FlatteningOptions::OUTPUT_ITEM;
     FlatteningOptions fopts;
+    OptimizeOptions optopts;
+    OptimizeStatistics optstats;
 
     clock_t starttime01;
     clock_t lasttime;
+    /// Per-phase resources for --profile-json, NULL if not requested
+    std::unique_ptr<PhaseProfile> profile;
+    /// Flattening cost by location and function, NULL if not requested
+    std::unique_ptr<FlatteningProfiler> profiler;
+
+    /// Loads the flat model and output model from a binary FlatZinc file
+    void loadFzb(void);
 
   };
 
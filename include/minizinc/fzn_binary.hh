@@ -0,0 +1,245 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __MINIZINC_FZN_BINARY_HH__
+#define __MINIZINC_FZN_BINARY_HH__
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <minizinc/model.hh>
+#include <minizinc/exception.hh>
+#include <minizinc/stl_map_set.hh>
+
+namespace MiniZinc {
+
+  /// Binary FlatZinc (.fzb): the flat model and the output model in one file.
+  ///
+  /// Layout, all records in the byte order of the writing machine and aligned
+  /// to 8 bytes, so that a mapped file can be used in place:
+  ///   Header                            magic, version, byte order mark
+  ///   Node[nNodes]                      expression pool
+  ///   Var[nVars]                        variable table
+  ///   Constraint[nConstraints]
+  ///   Solve[1]
+  ///   uint64_t[nStrings]                offsets into the string data
+  ///   char[]                            NUL-terminated strings
+  ///   char[]                            output model (.ozn text)
+  ///   Trailer                           offsets and sizes of the sections
+  /// The nodes come first and the tables last so that a writer can stream the
+  /// expressions and only has to keep the (small) tables in memory.
+  ///
+  /// Expressions are trees of nodes. An array or set node refers to a
+  /// contiguous run of element nodes; a call node refers to an array node with
+  /// its arguments. Children always precede their parents.
+  ///
+  /// The output model refers to functions of the standard library and has to
+  /// be typechecked against it anyway, so it is stored as text.
+  namespace FznBinary {
+
+    /// Increased on every incompatible change of the layout
+    const uint32_t VERSION = 1;
+    /// Node or string index meaning "none"
+    const uint32_t NONE = 0xFFFFFFFFu;
+
+    enum NodeKind {
+      N_BOOL,               ///< v.i is 0 or 1
+      N_INT,                ///< v.i, or an infinity in flags
+      N_FLOAT,              ///< v.f, or an infinity in flags
+      N_STRING,             ///< a is a string index
+      N_VAR,                ///< a is a variable index
+      N_ANNID,              ///< identifier without a declaration, a is a string index
+      N_ABSENT,             ///< <>
+      N_ARRAY,              ///< a elements from node v.ref.first, type v.ref.type
+      N_INTSET,             ///< a ranges, 2*a N_INT nodes from v.ref.first
+      N_FLOATSET,           ///< a ranges, 2*a N_FLOAT nodes from v.ref.first
+      N_CALL                ///< name a, arguments in array node v.ref.first, type v.ref.type
+    };
+    enum NodeFlags { NF_PLUS_INF = 1, NF_MINUS_INF = 2 };
+
+    struct Node {
+      uint8_t kind;
+      uint8_t flags;
+      uint16_t reserved;
+      uint32_t a;
+      union {
+        int64_t i;
+        double f;
+        struct {
+          uint32_t first;
+          int32_t type;     ///< Type::toInt()
+        } ref;
+      } v;
+    };
+
+    enum VarFlags { VF_INTRODUCED = 1 };
+
+    struct Var {
+      uint32_t name;        ///< string index
+      int32_t type;         ///< Type::toInt()
+      uint32_t domain;      ///< set node, or NONE
+      uint32_t rhs;         ///< node, or NONE
+      uint32_t ann;         ///< array node of annotations, or NONE
+      uint32_t index;       ///< for arrays: array node of one set per dimension
+      uint32_t flags;
+      uint32_t seq;         ///< position of the declaration in the model
+    };
+
+    /// A constraint which is not a call (true, false or a Boolean variable) has
+    /// no name, and args is the node of the whole constraint
+    struct Constraint {
+      uint32_t name;        ///< string index of the predicate, or NONE
+      uint32_t args;        ///< array node
+      uint32_t ann;         ///< array node of annotations, or NONE
+      uint32_t reserved;
+    };
+
+    struct Solve {
+      uint32_t st;          ///< SolveI::SolveType
+      uint32_t objective;   ///< node, or NONE
+      uint32_t ann;         ///< array node of annotations, or NONE
+      uint32_t reserved;
+    };
+
+    struct Header {
+      char magic[8];
+      uint32_t version;
+      uint32_t byteOrder;
+    };
+
+    struct Section {
+      uint64_t offset;
+      uint64_t count;       ///< records, or bytes for string data and output
+    };
+
+    struct Trailer {
+      Section nodes, vars, constraints, solve, strings, stringData, output;
+      char magic[8];
+    };
+
+  }
+
+  class FznBinaryError : public Exception {
+  public:
+    FznBinaryError(const std::string& msg) : Exception(msg) {}
+    ~FznBinaryError(void) throw() {}
+    virtual const char* what(void) const throw() {
+      return "MiniZinc: binary FlatZinc error";
+    }
+  };
+
+  /// Writes binary FlatZinc. Items can be added one at a time; the expression
+  /// nodes go to the stream right away, everything else is written by finish().
+  /// The stream does not have to be seekable.
+  class FznBinaryWriter {
+  public:
+    FznBinaryWriter(std::ostream& os);
+    ~FznBinaryWriter(void);
+    /// Adds a variable declaration, constraint or solve item. Removed items and
+    /// other kinds of items are skipped
+    void add(const Item* i);
+    /// Adds all items of \a flat
+    void add(const Model* flat);
+    /// Sets the output model
+    void output(const Model* ozn);
+    /// Writes the tables and the trailer
+    void finish(void);
+  private:
+    std::ostream& _os;
+    std::string _buf;
+    uint32_t _nNodes;
+    uint32_t _nDecls;
+    bool _fSolve;
+    bool _fFinished;
+    std::vector<FznBinary::Var> _vars;
+    /// Whether each variable has been declared, or only referenced so far
+    std::vector<bool> _declared;
+    std::vector<FznBinary::Constraint> _constraints;
+    FznBinary::Solve _solve;
+    UNORDERED_NAMESPACE::unordered_map<const VarDecl*,uint32_t> _varIdx;
+    UNORDERED_NAMESPACE::unordered_map<std::string,uint32_t> _strIdx;
+    std::vector<uint64_t> _strOffsets;
+    std::string _strData;
+    std::string _ozn;
+
+    uint32_t str(const std::string& s);
+    uint32_t var(const VarDecl* vd);
+    /// Returns the node for \a e after writing all of its children
+    FznBinary::Node encode(const Expression* e);
+    FznBinary::Node encodeArray(const std::vector<const Expression*>& v, Type t);
+    FznBinary::Node encodeRanges(const IntSetVal* isv);
+    FznBinary::Node encodeRanges(const FloatSetVal* fsv);
+    FznBinary::Node encodeInt(const IntVal& i);
+    FznBinary::Node encodeFloat(const FloatVal& f);
+    uint32_t emit(const FznBinary::Node& n);
+    uint32_t emitAnn(const Annotation& ann);
+    void flush(void);
+  };
+
+  /// Read-only view of a binary FlatZinc file. The file is mapped into memory
+  /// where the platform supports it, so solver front-ends can walk the tables
+  /// without building an AST. Node indices are checked on access.
+  class FznBinaryFile {
+  public:
+    /// Opens and checks \a filename
+    FznBinaryFile(const std::string& filename);
+    /// Uses \a size bytes at \a data, which have to stay valid and be 8-byte aligned
+    FznBinaryFile(const char* data, size_t size);
+    ~FznBinaryFile(void);
+
+    uint32_t nVars(void) const { return _nVars; }
+    const FznBinary::Var& var(uint32_t i) const { return _vars[i]; }
+    uint32_t nConstraints(void) const { return _nConstraints; }
+    const FznBinary::Constraint& constraint(uint32_t i) const { return _constraints[i]; }
+    const FznBinary::Solve& solve(void) const { return *_solve; }
+    uint32_t nNodes(void) const { return _nNodes; }
+    const FznBinary::Node& node(uint32_t i) const;
+    /// Element \a j of an array or set node
+    const FznBinary::Node& elem(const FznBinary::Node& n, uint32_t j) const;
+    const char* str(uint32_t i) const;
+    /// The output model as text
+    std::string output(void) const;
+  private:
+    const char* _data;
+    size_t _size;
+    /// Non-NULL if the file was mapped
+    void* _map;
+    /// Holds the file if it could not be mapped
+    std::vector<uint64_t> _copy;
+    const FznBinary::Node* _nodes;
+    uint32_t _nNodes;
+    const FznBinary::Var* _vars;
+    uint32_t _nVars;
+    const FznBinary::Constraint* _constraints;
+    uint32_t _nConstraints;
+    const FznBinary::Solve* _solve;
+    const uint64_t* _strOffsets;
+    uint32_t _nStrings;
+    const char* _strData;
+    size_t _strSize;
+    const char* _ozn;
+    size_t _oznSize;
+
+    void init(void);
+    FznBinaryFile(const FznBinaryFile&);
+    FznBinaryFile& operator =(const FznBinaryFile&);
+  };
+
+  /// Adds the variables, constraints and solve item of \a f to the flat model of \a env
+  void loadFznBinary(Env& env, const FznBinaryFile& f);
+
+}
+
+#endif
@@ -148,6 +148,8 @@ namespace MiniZinc {
     static void unlock(void);
     /// Test if garbage collector is locked
     static bool locked(void);
+    /// Collect garbage now, unless the garbage collector is locked
+    static void collect(void);
     /// Add model \a m to root set
     static void add(Model* m);
     /// Remove model \a m from root set
@@ -162,6 +164,16 @@ namespace MiniZinc {
     
     /// Return maximum allocated memory (high water mark)
     static size_t maxMem(void);
+    /// Return maximum allocated memory since the last resetPeakMem()
+    static size_t peakMem(void);
+    /// Start a new peak memory measurement at the current allocation
+    static void resetPeakMem(void);
+    /// Return currently allocated memory
+    static size_t allocedMem(void);
+    /// Return number of garbage collections so far
+    static unsigned long int collections(void);
+    /// Return total time spent in garbage collection (in milliseconds)
+    static double collectionTime(void);
   };
 
   /// Automatic garbage collection lock
@@ -0,0 +1,89 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __MINIZINC_LNS_HH__
+#define __MINIZINC_LNS_HH__
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <minizinc/solver_instance_base.hh>
+
+namespace MiniZinc {
+
+  /// Large neighbourhood search on top of a solver instance.
+  ///
+  /// The solver instance has to implement next(), resetWithConstraints() and
+  /// processPermanentConstraints(). Each iteration fixes a random part of the
+  /// neighbourhood variables to their values in the incumbent, resets the solver
+  /// with these equalities and searches the rest under the solver's node and time
+  /// limits (its "nodes" and "time" parameters). Improving solutions are printed
+  /// through the Solns2Out object of the solver instance, and the objective bound
+  /// is added as a permanent constraint.
+  ///
+  /// The neighbourhood variables are those of a relax_and_reconstruct search
+  /// annotation, or else all int and bool variables of the flat model. The share of
+  /// fixed variables adapts: it goes up after an iteration which hit the limit
+  /// without improving, and down after one which searched its neighbourhood
+  /// completely without finding anything better.
+  ///
+  /// Parameters, read from the options of the solver instance:
+  ///   lns_iterations      number of iterations, 0 = no limit
+  ///   lns_time            total time in ms, 0 = no limit
+  ///   lns_nodes           node limit per iteration
+  ///   lns_iteration_time  time limit per iteration in ms, 0 = none
+  ///   lns_fix             percentage of fixed variables at the start
+  ///   lns_adapt           change of that percentage after each iteration
+  ///   seed                random seed
+  class LNS {
+  public:
+    LNS(SolverInstanceBase2& si);
+    /// Runs the search and returns SAT, OPT (if a complete neighbourhood was
+    /// exhausted), UNSAT, or UNKNOWN
+    SolverInstance::Status run(void);
+    /// Prints a summary in the format of the solver statistics
+    void printStatistics(std::ostream& os) const;
+
+    /// Statistics
+    int nIterations = 0;
+    int nImproving = 0;             // iterations which improved the incumbent
+    int nExhausted = 0;             // iterations which searched their neighbourhood completely
+    int nSolutions = 0;
+    double dTime = 0.0;             // ms
+  private:
+    SolverInstanceBase2& _si;
+    /// The neighbourhood variables and their values in the incumbent
+    std::vector<VarDecl*> _vars;
+    std::vector<long long int> _vals;
+    /// Objective, NULL for satisfaction problems
+    Expression* _obj = NULL;
+    bool _fMax = false;
+    bool _fIntObj = true;
+    long long int _intObj = 0;
+    double _floatObj = 0.0;
+    std::mt19937 _rnd;
+    bool _fVerbose = false;
+    bool _fStats = false;
+
+    void collectVars(void);
+    /// Records the solution of the last call to next(), prints it and tightens the bound
+    void storeSolution(void);
+    /// Searches with the temporary constraints in \a m and the given limits, for the
+    /// first solution only if \a fFirst. Returns the status of the last call to
+    /// next(): UNSAT if the search space was exhausted
+    SolverInstance::Status search(Model& m, long long int nodes, long long int timeMs,
+                                  bool fFirst, bool& fImproved);
+  };
+
+}
+
+#endif
@@ -42,6 +42,49 @@ namespace MiniZinc {
     /// Map from identifiers to function declarations
     FnMap fnmap;
 
+    /// Key for the overload resolution cache
+    struct FnCacheKey {
+      /// Function identifier (the key stored in \a fnmap)
+      ASTString id;
+      /// Argument types, encoded using Type::toInt
+      std::vector<int> t;
+      /// Whether enums were matched strictly
+      bool strictEnums;
+      /// Whether the lookup was by types only (no ambiguity check)
+      bool byType;
+      bool operator ==(const FnCacheKey& k) const {
+        return id==k.id && strictEnums==k.strictEnums && byType==k.byType && t==k.t;
+      }
+    };
+    /// Hash function for overload resolution cache keys
+    struct FnCacheKeyHash {
+      size_t operator ()(const FnCacheKey& k) const {
+        size_t h = k.id.hash() ^ (k.strictEnums ? 0x9e3779b9 : 0) ^ (k.byType ? 0x7f4a7c15 : 0);
+        for (unsigned int i=0; i<k.t.size(); i++)
+          h = h*31 + static_cast<size_t>(k.t[i]);
+        return h;
+      }
+    };
+    /// Type of overload resolution cache
+    typedef UNORDERED_NAMESPACE::unordered_map<FnCacheKey,FunctionI*,FnCacheKeyHash> FnCache;
+    /// Cache of resolved overloads (only used in the root model)
+    mutable FnCache _fnCache;
+    /// Whether function signatures are final (reset by registerFn)
+    bool _fnCacheValid;
+    /// Environment the cached resolutions were computed in
+    mutable EnvI* _fnCacheEnv;
+    /// Number of resolutions answered from the cache
+    mutable unsigned long long _fnCacheHits;
+    /// Number of resolutions that had to scan the overloads
+    mutable unsigned long long _fnCacheMisses;
+    /// Look up \a k in the cache of the root model, return whether it was found
+    bool fnCacheLookup(EnvI& env, const FnCacheKey& k, FunctionI*& fi) const;
+    /// Remember resolution \a fi for \a k
+    void fnCacheInsert(const FnCacheKey& k, FunctionI* fi) const {
+      if (_fnCacheValid)
+        _fnCache[k] = fi;
+    }
+
     /// Filename of the model
     ASTString _filename;
     /// Path of the model
@@ -90,6 +133,8 @@ namespace MiniZinc {
     void registerFn(EnvI& env, FunctionI* fi);
     /// Sort functions by type
     void sortFn(void);
+    /// Start caching function resolution (all parameter types are known)
+    void enableFnCache(void);
     /// Check that registered functions do not clash wrt overloading
     void checkFnOverloading(EnvI& env);
     /// Return function declaration for \a id matching \a args
@@ -103,6 +148,10 @@ namespace MiniZinc {
     FunctionI* matchFn(EnvI& env, Call* c, bool strictEnums) const;
     /// Merge all builtin functions into \a m
     void mergeStdLib(EnvI& env, Model* m) const;
+    /// Return number of function resolutions answered from the cache
+    unsigned long long fnCacheHits(void) const;
+    /// Return number of function resolutions that required a search
+    unsigned long long fnCacheMisses(void) const;
 
     /// Return item \a i
     Item*& operator[] (int i);
@@ -0,0 +1,47 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __MINIZINC_NUMBER_FORMAT_HH__
+#define __MINIZINC_NUMBER_FORMAT_HH__
+
+#include <string>
+
+namespace MiniZinc { namespace NumberFormat {
+
+  /// Buffer size sufficient for all functions below
+  const int BUFSIZE = 32;
+
+  /// Write \a i in decimal to \a buf, return the number of characters (not terminated)
+  int intToChars(char* buf, long long int i);
+  /// Write the shortest decimal representation of finite \a d which reads back
+  /// as exactly \a d, in the style of printf's %g. Returns the number of
+  /// characters; \a buf is terminated
+  int doubleToChars(char* buf, double d);
+  /// Write finite \a d with \a prec digits after the decimal point, as printf's %.*f.
+  /// Returns the formatted string, since the length is not bounded
+  std::string fixed(double d, int prec);
+
+  /// Append \a i in decimal to \a s
+  void append(std::string& s, long long int i);
+  /// Append the shortest round-trip form of finite \a d to \a s. With \a fDot, a
+  /// result without decimal point or exponent gets ".0", as MiniZinc float literals need
+  void append(std::string& s, double d, bool fDot);
+
+  inline std::string toString(long long int i) {
+    std::string s; append(s, i); return s;
+  }
+  inline std::string toString(double d, bool fDot=true) {
+    std::string s; append(s, d, fDot); return s;
+  }
+
+}}
+
+#endif
@@ -20,7 +20,63 @@ namespace MiniZinc {
 
   class VarOccurrences {
   public:
-    typedef UNORDERED_NAMESPACE::unordered_set<Item*> Items;
+    /**
+     * \brief Set of items in which a variable occurs
+     *
+     * Most variables occur in only a handful of items, so up to three
+     * entries are stored inline without any heap allocation, and small
+     * sets are searched linearly. Only sets with more than _maxLinear
+     * entries allocate a hash index from items to array positions.
+     * Erasing an item moves the last entry into its slot, so the order
+     * of iteration is unspecified.
+     */
+    class Items {
+    public:
+      typedef Item** iterator;
+    protected:
+      typedef UNORDERED_NAMESPACE::unordered_map<Item*,unsigned int> Index;
+      /// Number of entries stored without heap allocation
+      static const unsigned int _inlineCap = 3;
+      /// Maximum number of entries searched linearly
+      static const unsigned int _maxLinear = 32;
+      /// Number of entries
+      unsigned int _n;
+      /// Number of available slots
+      unsigned int _cap;
+      union {
+        /// Inline storage (if _cap==_inlineCap)
+        Item* _inline[_inlineCap];
+        /// Heap storage (if _cap>_inlineCap)
+        Item** _heap;
+      };
+      /// Position of each entry (only for large sets)
+      Index* _index;
+      /// Return storage
+      Item** data(void) { return _cap==_inlineCap ? _inline : _heap; }
+      /// Return position of \a i (or -1)
+      int find(Item* i);
+    public:
+      /// Constructor
+      Items(void) : _n(0), _cap(_inlineCap), _index(NULL) {}
+      /// Copy constructor
+      Items(const Items& items);
+      /// Assignment operator
+      Items& operator =(const Items& items);
+      /// Destructor
+      ~Items(void);
+      /// Insert \a i
+      void insert(Item* i);
+      /// Erase \a i
+      void erase(Item* i);
+      /// Erase all items that have been removed from their model
+      void eraseRemoved(void);
+      /// Return number of items
+      unsigned int size(void) const { return _n; }
+      /// Iterator to first item
+      iterator begin(void) { return data(); }
+      /// Iterator past the last item
+      iterator end(void) { return data()+_n; }
+    };
     IdMap<Items> _m;
     IdMap<int> idx;
 
@@ -44,6 +100,9 @@ namespace MiniZinc {
     
     /// Unify \a v0 and \a v1 (removing \a v0)
     void unify(EnvI& env, Model* m, Id* id0, Id* id1);
+
+    /// Remove all items that have been removed from the model from the index
+    void eraseRemoved(void);
     
     /// Clear all entries
     void clear(void);
@@ -109,8 +168,37 @@ namespace MiniZinc {
 
   bool isOutput(VarDecl* vd);
   
+  /// Options for simplifying flat models
+  struct OptimizeOptions {
+    /// Tighten integer bounds from linear and element constraints
+    bool propagateBounds;
+    /// Maximum number of propagator runs (0 for ten runs per constraint)
+    unsigned int boundsPropagationLimit;
+    /// Time limit for bounds propagation in milliseconds (0 for no limit)
+    double boundsPropagationTime;
+    /// Default constructor
+    OptimizeOptions(void)
+    : propagateBounds(true), boundsPropagationLimit(0), boundsPropagationTime(5000.0) {}
+  };
+  
+  /// Statistics of simplifying flat models
+  struct OptimizeStatistics {
+    /// Number of propagator runs during bounds propagation
+    unsigned int n_propagations;
+    /// Number of tightened variable domains
+    unsigned int n_tightened_domains;
+    /// Number of constraints removed as entailed
+    unsigned int n_removed_ct;
+    /// Whether bounds propagation stopped at the iteration or time limit
+    bool limit_reached;
+    /// Constructor
+    OptimizeStatistics(void)
+    : n_propagations(0), n_tightened_domains(0), n_removed_ct(0), limit_reached(false) {}
+  };
+  
   /// Simplyfy models in \a env
-  void optimize(Env& env);
+  void optimize(Env& env, const OptimizeOptions& opt = OptimizeOptions(),
+                OptimizeStatistics* stats = NULL);
   
 }
 
@@ -0,0 +1,103 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __MINIZINC_PHASE_PROFILE_HH__
+#define __MINIZINC_PHASE_PROFILE_HH__
+
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <minizinc/model.hh>
+#include <minizinc/timer.hh>
+
+namespace MiniZinc {
+
+  /// Resources used by the phases of a compilation (parsing, flattening, ...)
+  ///
+  /// Phases can be nested: while an inner phase runs, the outer one is paused,
+  /// so every phase only accounts for its own work. A phase that is started
+  /// several times accumulates.
+  class PhaseProfile {
+  public:
+    struct Phase {
+      std::string name;
+      unsigned int count = 0;       // number of times the phase was started
+      double wallMs = 0.0;
+      double cpuMs = 0.0;
+      unsigned long int gcCollections = 0;
+      double gcMs = 0.0;
+      size_t heapPeak = 0;          // bytes allocated by the GC heap, high water mark
+      size_t heap = 0;              // bytes allocated by the GC heap at the end
+      /// Items of the model the phase worked on, -1 if unknown
+      long long int items = -1;
+      long long int vars = -1;
+      long long int constraints = -1;
+    };
+
+    PhaseProfile(void);
+    /// Starts phase \a name, pausing the current one
+    void start(const std::string& name);
+    /// Stops the current phase and counts the items of \a m, if given
+    void stop(const Model* m = NULL);
+    /// Stops all running phases
+    void stopAll(void);
+    const std::vector<Phase>& phases(void) const { return _phases; }
+    /// Bytes allocated by the GC heap, high water mark since construction
+    size_t heapPeak(void) const;
+    /// Writes the phases and the totals as a JSON object
+    void printJSON(std::ostream& os) const;
+  private:
+    std::vector<Phase> _phases;
+    /// Indices of the running phases
+    std::vector<unsigned int> _running;
+    /// Wall time, CPU time and GC counters at construction
+    Timer _total;
+    std::clock_t _cpuStart;
+    unsigned long int _gcCollectionsStart;
+    double _gcMsStart;
+    /// The same at the last sample
+    Timer _wall;
+    std::clock_t _cpu;
+    unsigned long int _gcCollections;
+    double _gcMs;
+    /// High water mark of the GC heap up to the last sample. Phases reset
+    /// the one of the GC, so it is kept here for the whole run.
+    size_t _heapPeak;
+
+    /// Adds the resources used since the last sample to the current phase
+    void sample(void);
+  };
+
+  /// Starts a phase of \a p, if not NULL, and stops it on destruction
+  class PhaseProfileScope {
+  public:
+    PhaseProfileScope(PhaseProfile* p, const std::string& name) : _p(p) {
+      if (_p)
+        _p->start(name);
+    }
+    /// Stops the phase now and counts the items of \a m
+    void stop(const Model* m = NULL) {
+      if (_p)
+        _p->stop(m);
+      _p = NULL;
+    }
+    ~PhaseProfileScope(void) { stop(); }
+  private:
+    PhaseProfile* _p;
+    PhaseProfileScope(const PhaseProfileScope&);
+    PhaseProfileScope& operator =(const PhaseProfileScope&);
+  };
+
+}
+
+#endif
@@ -14,6 +14,7 @@
 #define __MINIZINC_PRETTYPRINTER_HH__
 
 #include <iostream>
+#include <string>
 
 #include <minizinc/ast.hh>
 
@@ -69,6 +70,40 @@ namespace MiniZinc {
   }
 
   void ppFloatVal(std::ostream& os, const FloatVal& fv, bool hexFloat=false);
+
+  /// Writes FlatZinc without the layout engine. Items are formatted straight into
+  /// a buffer, which goes to the stream in large blocks (or is drained by the
+  /// caller if there is no stream). Literals, identifiers, arrays, calls, variable
+  /// declarations and the solve item are written directly; anything else goes
+  /// through the plain printer into a temporary ostringstream, so those items
+  /// still allocate. The output is the same as that of Printer with width 0.
+  class FznPrinter {
+  public:
+    /// Writes to \a os
+    FznPrinter(std::ostream& os, bool printRemoved=true);
+    /// Only collects output in buffer()
+    FznPrinter(bool printRemoved=false);
+    ~FznPrinter(void);
+
+    void print(const Item* i);
+    void print(const Model* m);
+    /// Writes the buffer to the stream
+    void flush(void);
+    /// The output not written yet
+    std::string& buffer(void) { return _buf; }
+  private:
+    std::ostream* _os;
+    std::string _buf;
+    bool _printRemoved;
+    void p(const Expression* e);
+    void p(const Annotation& ann);
+    void p(const Type& type, const Expression* e);
+    void pInt(long long int i);
+    void pIntVal(const IntVal& i);
+    void pFloatVal(const FloatVal& f);
+    void pId(const Id* id);
+    void fallback(const Expression* e);
+  };
   
 }
 
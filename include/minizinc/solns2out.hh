@@ -17,9 +17,12 @@
 #include <vector>
 #include <set>
 #include <ctime>
+#include <cstdio>
 #include <memory>
 #include <iomanip>
 
+#include <stdint.h>
+
 #include <minizinc/model.hh>
 #include <minizinc/parser.hh>
 #include <minizinc/typecheck.hh>
@@ -32,8 +35,49 @@
 #include <minizinc/utils.hh>
 #include <minizinc/file_utils.hh>
 #include <minizinc/solver_instance.hh>
+#include <minizinc/stl_map_set.hh>
 
 namespace MiniZinc {
+
+  /// Set of solution texts for --unique and --canonicalize.
+  /// Only 128-bit hashes of the texts are kept to recognise repeated solutions.
+  /// If the texts are to be printed in sorted order at the end, they are kept
+  /// as well, and once they take more than the buffer limit, written as sorted
+  /// runs to a temporary file which are merged by printSorted().
+  class SolutionSet {
+  public:
+    /// Keep the texts for printSorted() if \a fKeep; spill them to disk when
+    /// they take more than \a bufferLimit bytes, 0 for no limit
+    SolutionSet(bool fKeep=false, size_t bufferLimit=0);
+    ~SolutionSet(void);
+    /// Adds \a s, returns false if it has been added before
+    bool insert(const std::string& s);
+    /// Number of different texts
+    size_t size(void) const { return _hashes.size(); }
+    /// Prints the kept texts in sorted order, separated by \a comma lines
+    void printSorted(std::ostream& os, const std::string& comma);
+  private:
+    struct Hash128 {
+      uint64_t h1, h2;
+      bool operator ==(const Hash128& h) const { return h1==h.h1 && h2==h.h2; }
+    };
+    struct HashHash {
+      size_t operator ()(const Hash128& h) const { return static_cast<size_t>(h.h1); }
+    };
+    static Hash128 hash(const std::string& s);
+    UNORDERED_NAMESPACE::unordered_set<Hash128,HashHash> _hashes;
+    bool _fKeep;
+    size_t _bufferLimit;
+    std::vector<std::string> _buffer;
+    size_t _bufferSize;
+    /// Temporary file with the sorted runs, one after the other
+    FILE* _runFile;
+    /// Offsets of the runs in _runFile, and of its end
+    std::vector<long> _runStarts;
+    void spill(void);
+    SolutionSet(const SolutionSet&);
+    SolutionSet& operator =(const SolutionSet&);
+  };
   
   /// Class handling fzn solver's output
   /// could facilitate exhange of raw/final outputs in a portfolio
@@ -61,6 +105,8 @@ namespace MiniZinc {
       int flag_ignore_lines = 0;
       bool flag_unique = 0;
       bool flag_canonicalize = 0;
+      /// Memory for buffered solutions in MB before they are spilled to disk, 0 = no limit
+      double flag_canonicalize_buffer = 0.0;
       std::string flag_output_noncanonical;
       std::string flag_output_raw;
       int flag_number_output = -1;
@@ -113,8 +159,8 @@ namespace MiniZinc {
     /// the evaluation procedures print output/status to os
     /// returning false means need to stop (error/ too many solutions)
     /// Solution validation here   TODO
-    /// Note that --canonicalize delays output
-    /// until ... exit, eof,  ??   TODO
+    /// Note that --canonicalize delays output until evalStatus();
+    /// --unique alone prints each new solution right away
     /// These functions should only be called explicitly
     /// from SolverInstance
     virtual bool evalOutput();
@@ -133,7 +179,7 @@ namespace MiniZinc {
     std::unique_ptr<std::ostream> pOfs_non_canon;
     std::unique_ptr<std::ostream> pOfs_raw;
     int nSolns = 0;
-    std::set<std::string> sSolsCanon;
+    std::unique_ptr<SolutionSet> pSolsCanon;
     std::string line_part;   // non-finished line from last chunk
 
   protected:
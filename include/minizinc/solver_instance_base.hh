@@ -66,6 +66,8 @@ namespace MiniZinc {
     /// return reason for status given by solve
     virtual StatusReason reason(void) {return _status_reason;}
     virtual Status status(void) {return _status;}
+    /// ask a running search to stop as soon as possible; may be called from another thread
+    virtual void interrupt(void) { }
     
 
     /// reset the model to its core (removing temporary cts) and the solver to the root node of the search 
@@ -87,6 +89,8 @@ namespace MiniZinc {
 
   /// This implements a solver which is linked and returns its solution by assignSolutionToOutput()
   class SolverInstanceBase2 : public SolverInstanceBase {
+    /// reads the incumbent
+    friend class LNS;
   protected:
     virtual Expression* getSolutionValue(Id* id) = 0;
 
@@ -50,6 +50,8 @@ class MIP_cplex_wrapper : public MIP_wrapper {
                         LinConType sense, double rhs,
                         int mask = MaskConsType_Normal,
                         std::string rowName = "");
+    /// adding all buffered normal rows by one CPXaddrows() call
+    virtual void doAddRows(const RowBuffer& rb);
     /// adding an implication
 //     virtual void addImpl() = 0;
     virtual void setObjSense(int s);   // +/-1 for max/min
@@ -0,0 +1,78 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Gleb Belov <gleb.belov@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __MIP_FILE_WRAPPER_H__
+#define __MIP_FILE_WRAPPER_H__
+
+#include <cstdio>
+#include <minizinc/solvers/MIP/MIP_wrap.hh>
+
+/// A MIP "solver" which does not solve but writes the linearised model
+/// to a free-format MPS or CPLEX LP file. Needs no external libraries.
+/// Rows are kept in compressed sparse row format and streamed out in solve().
+class MIP_file_wrapper : public MIP_wrapper {
+    /// Number of columns passed by doAddVars()
+    int nColsModel = 0;
+    /// Rows in compressed sparse row format
+    std::vector<int> rowStarts, columns;
+    std::vector<double> element, rowRHS;
+    std::vector<LinConType> rowSense;
+    std::vector<std::string> rowNames;
+    int objSense = -1;
+
+  public:
+    MIP_file_wrapper() { }
+    virtual ~MIP_file_wrapper() { }
+
+    /// "adding" new variables: they are kept in colObj etc. of the ancestor
+    virtual void doAddVars(size_t n, double *obj, double *lb, double *ub,
+      VarType *vt, std::string *names) { nColsModel += n; }
+
+    /// adding a linear constraint
+    virtual void addRow(int nnz, int *rmatind, double* rmatval,
+                        LinConType sense, double rhs,
+                        int mask = MaskConsType_Normal,
+                        std::string rowName = "");
+    /// appending all buffered rows at once
+    virtual void doAddRows(const RowBuffer& rb);
+    virtual void setObjSense(int s) { objSense = s; }   // +/-1 for max/min
+
+    /// Bounds of this magnitude are written as infinite
+    virtual double getInfBound() { return 1e20; }
+
+    virtual int getNCols() { return colObj.size(); }
+    virtual int getNColsModel() { return nColsModel; }
+    virtual int getNRows() { return rowRHS.size(); }
+
+    /// writes the model to the file given by --writeModel
+    virtual void solve();
+
+    /// OUTPUT: there is never a solution
+    virtual const double* getValues() { return output.x; }
+    virtual double getObjValue() { return output.objVal; }
+    virtual double getBestBound() { return output.bestBound; }
+    virtual double getCPUTime() { return output.dCPUTime; }
+
+    virtual Status getStatus()  { return output.status; }
+    virtual std::string getStatusName() { return output.statusName; }
+
+    virtual int getNNodes() { return output.nNodes; }
+    virtual int getNOpen() { return output.nOpenNodes; }
+
+  protected:
+    /// name of column j / row i as written to the file
+    std::string colName(int j) const;
+    std::string rowName(int i) const;
+    void writeMPS(FILE* f);
+    void writeLP(FILE* f);
+};
+
+#endif  // __MIP_FILE_WRAPPER_H__
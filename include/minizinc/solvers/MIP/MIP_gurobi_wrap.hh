@@ -34,6 +34,10 @@ class MIP_gurobi_wrapper : public MIP_wrapper {
     int (__stdcall *dll_GRBaddconstr) (GRBmodel *model, int numnz, int *cind, double *cval,
                              char sense, double rhs, const char *constrname);
 
+    int (__stdcall *dll_GRBaddconstrs) (GRBmodel *model, int numconstrs, int numnz,
+                             int *cbeg, int *cind, double *cval,
+                             char *sense, double *rhs, const char **constrnames);
+
     int (__stdcall *dll_GRBaddvars) (GRBmodel *model, int numvars, int numnz,
                            int *vbeg, int *vind, double *vval,
                            double *obj, double *lb, double *ub, char *vtype,
@@ -85,6 +89,9 @@ class MIP_gurobi_wrapper : public MIP_wrapper {
     int (__stdcall *dll_GRBsetintattrlist) (GRBmodel *model, const char *attrname,
                     int len, int *ind, int *newvalues);
 
+    int (__stdcall *dll_GRBsetdblattrlist) (GRBmodel *model, const char *attrname,
+                    int len, int *ind, double *newvalues);
+
     int (__stdcall *dll_GRBsetstrparam) (GRBenv *env, const char *paramname, const char *value);
 
     int (__stdcall *dll_GRBupdatemodel) (GRBmodel *model);
@@ -120,9 +127,13 @@ class MIP_gurobi_wrapper : public MIP_wrapper {
                         LinConType sense, double rhs,
                         int mask = MaskConsType_Normal,
                         string rowName = "");
+    /// adding all buffered rows by one GRBaddconstrs() call
+    virtual void doAddRows(const RowBuffer& rb);
     int nRows=0;    // to count rows in order tp notice lazy constraints
     std::vector<int> nLazyIdx;
     std::vector<int> nLazyValue;
+    /// remember the lazyness of row iRow, set before solving
+    void markLazy(int iRow, int mask);
     /// adding an implication
 //     virtual void addImpl() = 0;
     virtual void setObjSense(int s);   // +/-1 for max/min
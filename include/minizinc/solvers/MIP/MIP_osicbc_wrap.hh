@@ -36,11 +36,12 @@ class MIP_osicbc_wrapper : public MIP_wrapper {
     
     vector<double> x;
     
-    // To add constraints:
-//     vector<int> rowStarts, columns;
-    vector<CoinPackedVector> rows;
-    vector<double> //element,
+    // To add constraints, in compressed sparse row format:
+    vector<int> rowStarts, columns;
+    vector<double> element,
       rowlb, rowub;
+    /// append a row's bounds to rowlb/rowub
+    void addRowBounds(LinConType sense, double rhs);
 
   public:
     MIP_osicbc_wrapper() { openOSICBC(); }
@@ -72,6 +73,8 @@ class MIP_osicbc_wrapper : public MIP_wrapper {
                         LinConType sense, double rhs,
                         int mask = MaskConsType_Normal,
                         string rowName = "");
+    /// appending all buffered rows to the CSR arrays at once
+    virtual void doAddRows(const RowBuffer& rb);
     /// adding an implication
 //     virtual void addImpl() = 0;
     virtual void setObjSense(int s);   // +/-1 for max/min
@@ -0,0 +1,59 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Gleb Belov <gleb.belov@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __MIP_PORTFOLIO_H__
+#define __MIP_PORTFOLIO_H__
+
+#include <minizinc/solvers/MIP/MIP_wrap.hh>
+
+/// Solves the model loaded into a MIP wrapper under several option sets at once.
+/// Each configuration is a string of wrapper options, e.g. "--cbcArgs '-cuts off'".
+/// Every member runs in a forked copy of the process: the backends keep their
+/// settings in static variables and CBC's driver is not reentrant, so they
+/// cannot share one address space. The model is built only once, before forking,
+/// so only libraries for which MIP_WrapperFactory::isForkSafe() can be used.
+/// Members report solutions and bounds through a pipe. Improving solutions are
+/// passed to the wrapper's solution callback, and their objective values are sent
+/// to the other members, which use them as a cutoff (CBC only, via the wrapper's
+/// objcutfn). A member which then finishes infeasible proves the incumbent optimal.
+/// The run stops as soon as one member finishes with a proof (optimality or
+/// infeasibility), or when the best incumbent meets the best bound from any
+/// member; the other members are then killed.
+class MIP_portfolio {
+  public:
+    MIP_portfolio(MIP_wrapper* pw, const std::vector<std::string>& cfg)
+      : pMIP(pw), aConfigs(cfg) { }
+    /// Runs all configurations and stores the result in the wrapper's output.
+    /// Returns false if the platform or the MIP library cannot run a portfolio
+    bool solve();
+
+    /// Index of the configuration whose result was taken, -1 if none
+    int iWinner = -1;
+    /// Number of members which finished before the run was stopped
+    int nFinished = 0;
+    /// Set when the run is over
+    bool fDone = false;
+    /// In a member process, the index of its configuration
+    int iMember = -1;
+    const std::vector<std::string>& getConfigs() const { return aConfigs; }
+
+  private:
+    MIP_wrapper* pMIP;
+    std::vector<std::string> aConfigs;
+    /// Best solution so far, the wrapper's output points here
+    std::vector<double> xBest;
+    /// Applies configuration iCfg to this process's wrapper options
+    void applyConfig(int iCfg);
+    /// Member side: solve and report to \a fd, read the cutoffs from \a fdIn
+    void runMember(int iCfg, int fd, int fdIn);
+};
+
+#endif  // __MIP_PORTFOLIO_H__
@@ -12,9 +12,17 @@
 #ifndef __MINIZINC_MIP_SOLVER_INSTANCE_H__
 #define __MINIZINC_MIP_SOLVER_INSTANCE_H__
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <chrono>
 #include <minizinc/flattener.hh>
 #include <minizinc/solver.hh>
 #include <minizinc/solvers/MIP/MIP_wrap.hh>
+#include <minizinc/solvers/MIP/MIP_portfolio.hh>
 
 namespace MiniZinc {
   
@@ -36,9 +44,72 @@ namespace MiniZinc {
     virtual ~CutGen() { }
     /// Say what type of cuts
     virtual int getMask() { return MIP_wrapper::MaskConsType_Usercut; }
-    /// Adds new cuts to the 2nd parameter
-    virtual void generate(const MIP_wrapper::Output&, MIP_wrapper::CutInput&) = 0;
+    /// Adds new cuts to the 2nd parameter. Can run in several threads at once,
+    /// also for the same generator, so should not modify the generator
+    virtual void generate(const MIP_wrapper::Output&, MIP_wrapper::CutInput&) const = 0;
     virtual void print( std::ostream& ) { }
+    virtual const char* getName() const { return "cut generator"; }
+
+    /// Counters, updated by the cut pool
+    struct Stats {
+      long nCalls = 0;
+      long nCuts = 0;       // generated
+      long nAdded = 0;      // passed to the solver
+      double dTime = 0.0;   // in seconds
+    };
+    Stats stats;
+  };
+
+  /// Collects the cuts of all generators in a callback. Drops cuts which are
+  /// not violated by the current point and duplicates, found by a hash of the
+  /// normalized row. User cuts are also compared with those passed earlier;
+  /// lazy cuts may have to be passed again [Gurobi], so only within a call.
+  /// Can be used from concurrent solver callbacks
+  class CutPool {
+  public:
+    struct KeyHash {
+      size_t operator()( const std::vector<long long>& k ) const;
+    };
+    /// Normalized rows
+    typedef UNORDERED_NAMESPACE::unordered_set< std::vector<long long>, KeyHash > KeySet;
+    /// Minimal violation of a cut to be passed on
+    double dMinViol = 1e-6;
+    /// Adds the cuts of generator \a pCG to \a cutsOut, unless filtered.
+    /// \a keysCall are the rows passed in this call
+    void add( CutGen* pCG, const MIP_wrapper::CutInput& cuts, double dTime,
+              const MIP_wrapper::Output& slvOut, KeySet& keysCall,
+              MIP_wrapper::CutInput& cutsOut );
+    long nDuplicate = 0, nNotViolated = 0;
+    /// Guards the counters above and those of the generators
+    std::mutex& getMutex() { return mtx; }
+  private:
+    std::mutex mtx;
+    KeySet userCuts;
+    static std::vector<long long> normalize( const MIP_wrapper::CutDef& cut );
+  };
+
+  /// Threads which run the cut generators of a callback, started on first use
+  /// and kept until destruction. A call while another one is running, e.g. from
+  /// concurrent solver callbacks, runs its tasks alone in the calling thread
+  class CutThreadPool {
+  public:
+    ~CutThreadPool();
+    /// Calls job(i) for i = 0..nTasks-1 on up to nThreads threads, the caller included
+    void run( int nThreads, int nTasks, const std::function<void(int)>& job );
+    int getNWorkers() const { return aWorkers.size(); }
+  private:
+    std::mutex mtxRun;             // one run at a time
+    std::mutex mtx;                // the round below
+    std::condition_variable cvStart, cvDone;
+    std::vector<std::thread> aWorkers;
+    const std::function<void(int)>* pJob = 0;
+    int nTasks = 0;
+    std::atomic<int> iNext { 0 };
+    long iRound = 0;
+    int nBusy = 0;
+    bool fStop = false;
+    void runTasks();
+    void work( long iDone );
   };
 
   /// XBZ cut generator
@@ -49,8 +120,26 @@ namespace MiniZinc {
     XBZCutGen( MIP_wrapper* pw ) : pMIP(pw) { }
     vector<MIP_wrapper::VarId> varX, varB;
     MIP_wrapper::VarId varZ;
-    void generate(const MIP_wrapper::Output&, MIP_wrapper::CutInput&);
+    void generate(const MIP_wrapper::Output&, MIP_wrapper::CutInput&) const;
     void print( std::ostream& );
+    const char* getName() const { return "XBZ"; }
+  };
+
+  /// The latest incumbents from the solution callback as raw column values,
+  /// in one preallocated buffer. Used when not every incumbent is printed
+  class IncumbentRing {
+  public:
+    IncumbentRing( int nc=8 ) : nCap(nc) { }
+    void push( const double* x, int nc, double obj );
+    int size() const { return nSize; }
+    /// i-th newest, 0 is the newest
+    const double* getX( int i=0 ) const { return &aX[ iSlot(i)*nCols ]; }
+    double getObj( int i=0 ) const { return aObj[ iSlot(i) ]; }
+    long nPushed = 0;
+  private:
+    int nCap, nCols=0, iHead=0, nSize=0;
+    std::vector<double> aX, aObj;
+    int iSlot( int i ) const { return ( iHead - 1 - i + nCap ) % nCap; }
   };
 
   class MIP_solverinstance : public SolverInstanceImpl<MIP_solver> {
@@ -58,6 +147,8 @@ namespace MiniZinc {
       
       const unique_ptr<MIP_wrapper> mip_wrap;
       vector< unique_ptr<CutGen> > cutGenerators;
+      CutPool cutPool;
+      CutThreadPool cutThreads;
       
     public:
       void registerCutGenerator( unique_ptr<CutGen>&& pCG ) {
@@ -68,6 +159,18 @@ namespace MiniZinc {
     public:
       double lastIncumbent;
       double dObjVarLB=-1e300, dObjVarUB=1e300;
+      MIP_wrapper::PresolveStats presolveStats;
+      /// Set if solved by a portfolio of option sets; keeps the solution
+      unique_ptr<MIP_portfolio> portfolio;
+      /// Incumbents from the callback and how many of them were printed
+      IncumbentRing incumbents;
+      long nRendered = 0;
+      double dRenderTime = 0.0;
+      std::chrono::steady_clock::time_point tLastRender;
+      /// Guards the above and the printing of incumbents
+      std::mutex mtxIncumbents;
+      /// Should the incumbent just recorded be printed
+      bool fRenderIncumbent();
     public:
 
       MIP_solverinstance(Env& env) :
@@ -86,8 +189,11 @@ namespace MiniZinc {
       
       virtual void genCuts
         ( const MIP_wrapper::Output& , MIP_wrapper::CutInput& , bool fMIPSol);
+      /// Maps the output variable values from a .dzn/.json file to a MIP start
+      void setWarmStart(const string& sFile);
 
 //       void assignSolutionToOutput();   // needs to be public for the callback?
+      virtual void printSolution();
       virtual void printStatistics(std::ostream&, bool fLegend=0);
       virtual void printStatisticsLine(std::ostream& os, bool fLegend=0) { printStatistics(os, fLegend); }
 
@@ -106,10 +212,9 @@ namespace MiniZinc {
   public:
     SolverInstanceBase* doCreateSI(Env& env)   { return new MIP_solverinstance(env); }
     
-    bool processOption(int& i, int argc, const char** argv)
-      { return MIP_WrapperFactory::processOption(i, argc, argv); }
+    bool processOption(int& i, int argc, const char** argv);
     string getVersion( );
-    void printHelp(std::ostream& os) { MIP_WrapperFactory::printHelp(os); }
+    void printHelp(std::ostream& os);
   };
 
 }
@@ -19,6 +19,7 @@
 #include <iostream>
 #include <sstream>
 #include <cassert>
+#include <cmath>
 
 
 /// Facilitate lhs computation of a cut
@@ -49,6 +50,10 @@ namespace MIP_WrapperFactory {
     bool processOption(int& i, int argc, const char** argv);
     std::string getVersion( );
     void printHelp(std::ostream& );
+    /// Can a process which has loaded a model into this library fork and
+    /// solve it in the child. False for libraries which hold threads, license
+    /// connections or similar state in their environment
+    bool isForkSafe( );
 };
 
 /// An abstract MIP wrapper.
@@ -105,9 +110,37 @@ class MIP_wrapper {
       int nNodes=0;
       int nOpenNodes=0;
       double dCPUTime = 0;
+      /// The model was exported to stdout, which must not get a status line
+      bool fModelOnStdout = false;
     };      
     Output output;
 
+    /// Warm start: values for some of the columns, set before solve().
+    /// Wrappers which support it pass it to the solver and set the status to
+    /// PASSED or REJECTED. MIP_solverinstance turns PASSED into ACCEPTED when
+    /// the first incumbent agrees with the start, or the final solution if no
+    /// incumbent came through the callback (without -a).
+    struct MIPStart {
+      enum Status { IGNORED, PASSED, ACCEPTED, REJECTED };
+      std::vector<VarId> cols;
+      std::vector<double> vals;
+      Status status = IGNORED;
+      /// Objective value, if the start gives all columns or was accepted
+      double objVal = 1e308;
+      bool isComplete(int nCols) const { return int(cols.size()) == nCols; }
+      /// A passed start becomes accepted if solution \a x agrees with every given column
+      void checkSolution(const double* x, double obj) {
+        if ( PASSED != status )
+          return;
+        for ( size_t k=0; k<cols.size(); ++k )
+          if ( std::fabs( x[ cols[k] ] - vals[k] ) > 1e-6 * ( 1.0 + std::fabs( vals[k] ) ) )
+            return;
+        status = ACCEPTED;
+        objVal = obj;
+      }
+    };
+    MIPStart mipStart;
+
     /// General cut definition, could be used for addRow() too
     class CutDef {
       CutDef() { }
@@ -123,15 +156,14 @@ class MIP_wrapper {
         rmatind.push_back( i );
         rmatval.push_back( c );
       }
-      double computeViol( const double* x, int nCols ) {
+      double computeViol( const double* x, int nCols ) const {
         double lhs = computeSparse( rmatind.size(), rmatind.data(), rmatval.data(), x, nCols );
         if ( LQ==sense ) {
           return lhs-rhs;
         } else if ( GQ==sense ) {
           return rhs-lhs;
-        } else
-          assert( 0 );
-        return 0.0;
+        }
+        return std::fabs( lhs-rhs );
       }
     };
     /// Cut callback fills one
@@ -144,6 +176,9 @@ class MIP_wrapper {
     typedef void (*CutCallbackFn)(const Output& , CutInput& , void* ,
                   bool fMIPSol  // if with a MIP feas sol - lazy cuts only
                                  );
+    /// objective cutoff handler, polled during the search: returns true and sets
+    /// the objective value of an incumbent found outside this solver
+    typedef bool (*ObjCutoffFn)(double& objVal, void* );
     struct CBUserInfo {
       MIP_wrapper* wrapper = 0;
       MIP_wrapper::Output* pOutput=0;
@@ -152,6 +187,9 @@ class MIP_wrapper {
       void *ppp=0;  // external info. Intended to keep MIP_solverinstance
       SolCallbackFn solcbfn=0;
       CutCallbackFn cutcbfn=0;
+      /// Gets the incumbents which are not passed to solcbfn (without -a)
+      SolCallbackFn incumbentfn=0;
+      ObjCutoffFn objcutfn=0;
       /// Union of all flags used for the registered callback cuts
       /// See MaskConstrType_..
       /// Solvers need to know this
@@ -259,6 +297,75 @@ class MIP_wrapper {
                         int mask = MaskConsType_Normal,
                         std::string rowName = "") = 0;
     int nAddedRows = 0;   // for name counting
+
+    /// Linear constraints collected by bufferRow(), in compressed sparse row format
+    struct RowBuffer {
+      /// Start of each row in rmatind/rmatval, plus the end of the last row
+      std::vector<int> rowStarts = std::vector<int>(1, 0);
+      std::vector<int> rmatind;
+      std::vector<double> rmatval;
+      std::vector<LinConType> sense;
+      std::vector<double> rhs;
+      std::vector<int> mask;
+      /// Row names are only generated on demand, from a prefix and a number
+      std::vector<const char*> namePrefix;
+      std::vector<int> nameNum;
+      int size() const { return rhs.size(); }
+      int nnz(int i) const { return rowStarts[i+1]-rowStarts[i]; }
+      std::string rowName(int i) const {
+        std::ostringstream oss;
+        oss << namePrefix[i] << nameNum[i];
+        return oss.str();
+      }
+      void clear() {
+        rowStarts.assign(1, 0);
+        rmatind.clear();
+        rmatval.clear();
+        sense.clear();
+        rhs.clear();
+        mask.clear();
+        namePrefix.clear();
+        nameNum.clear();
+      }
+    };
+    RowBuffer rowBuffer;
+    /// adding a linear constraint to the row buffer; \a namePrefix must outlive the buffer
+    void bufferRow(int nnz, const int *rmatind, const double* rmatval,
+                   LinConType sense, double rhs,
+                   int mask = MaskConsType_Normal,
+                   const char* namePrefix = "row_") {
+      rowBuffer.rmatind.insert(rowBuffer.rmatind.end(), rmatind, rmatind+nnz);
+      rowBuffer.rmatval.insert(rowBuffer.rmatval.end(), rmatval, rmatval+nnz);
+      rowBuffer.rowStarts.push_back(rowBuffer.rmatind.size());
+      rowBuffer.sense.push_back(sense);
+      rowBuffer.rhs.push_back(rhs);
+      rowBuffer.mask.push_back(mask);
+      rowBuffer.namePrefix.push_back(namePrefix);
+      rowBuffer.nameNum.push_back(nAddedRows++);
+    }
+    /// passing all buffered rows to the solver. Call before solve() and before adding rows directly
+    void flushRows();
+
+    /// What presolveRows() did
+    struct PresolveStats {
+      int nRowsBefore = 0, nRowsAfter = 0;
+      int nEmpty = 0, nSingleton = 0, nDuplicate = 0, nRedundant = 0, nDominated = 0;
+      int nFixedTerms = 0;      // terms of fixed columns moved to the rhs
+      int nBounds = 0;          // column bounds tightened
+      int nRounds = 0;
+      double dTime = 0.0;
+    };
+    /// Simple presolve of the buffered rows, before Phase-1 columns are passed to the solver.
+    /// Substitutes fixed columns, turns singleton rows into column bounds and
+    /// removes empty, duplicate, redundant and dominated rows. Only touches normal rows
+    /// and never removes columns, so solution values need no mapping back.
+    /// Returns false if the rows are found infeasible
+    bool presolveRows(PresolveStats& stats);
+  protected:
+    /// actual adding of buffered rows. Default: addRow() for each row.
+    /// Wrappers with a bulk interface should overload this
+    virtual void doAddRows(const RowBuffer& rb);
+  public:
     /// adding an implication
 //     virtual void addImpl() = 0;
     virtual void setObjSense(int s) = 0;   // +/-1 for max/min
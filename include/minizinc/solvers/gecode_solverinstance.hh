@@ -13,6 +13,8 @@
 #ifndef __MINIZINC_GECODE_SOLVER_INSTANCE_HH__
 #define __MINIZINC_GECODE_SOLVER_INSTANCE_HH__
 
+#include <atomic>
+
 #include <gecode/kernel.hh>
 #include <gecode/int.hh>
 #include <gecode/driver.hh>
@@ -206,11 +208,19 @@ namespace MiniZinc {
     unsigned int _n_max_solutions;
     unsigned int _n_found_solutions;
     Model* _flat;
+    /// the branchers have been posted on _current_space
+    bool _branchers_posted;
+    /// set when LNS has printed its solutions itself
+    bool _lns_printed;
+    /// set by interrupt(), stops all further search
+    std::atomic<bool> _interrupted;
   public:
     /// the Gecode space that will be/has been solved
     FznSpace* _current_space; 
     /// the solution (or NULL if does not exist or not yet computed)
     FznSpace* _solution;
+    /// copy of the root space with the permanent constraints, made on the first reset
+    FznSpace* _root_space;
     /// the variable declarations with output annotations
     std::vector<VarDecl*> _varsWithOutput;
     /// declaration map for processing and printing output
@@ -229,6 +239,10 @@ namespace MiniZinc {
     virtual void processFlatZinc(void);    
     virtual Status solve(void);
     virtual void resetSolver(void);
+    virtual void resetWithConstraints(Model::iterator begin, Model::iterator end);
+    virtual void processPermanentConstraints(Model::iterator begin, Model::iterator end);
+    virtual void printSolution(void);
+    virtual void interrupt(void);
 
     // Presolve the currently loaded model, updating variables with the same
     // names in the given Model* m.
@@ -309,6 +323,8 @@ namespace MiniZinc {
     /// creates the gecode branchers // TODO: what is decay, ignoreUnknown -> do we need all the args?
     void createBranchers(Annotation& ann, Expression* additionalAnn, int seed, double decay,
             bool ignoreUnknown, std::ostream& err);
+    /// posts the branchers on the current space, once
+    void postBranchers(void);
     void prepareEngine(void);
     void setSearchStrategyFromAnnotation(std::vector<Expression*> flatAnn, 
                                                         std::vector<bool>& iv_searched, 
@@ -44,7 +44,7 @@ MznModel::load(PyObject *args, PyObject *keywds, bool fromFile)
   bool isDict = false;
 
   if (fromFile) {
-    char *kwlist[] = {"file","data","options"};
+    char *kwlist[] = {"file","data","options",NULL};
     if (!PyArg_ParseTupleAndKeywords(args, keywds, "s|Os", kwlist, &py_string, &obj, &options)) {
       PyErr_SetString(PyExc_TypeError, "MiniZinc: load: Parsing error");
       return -1;
@@ -95,15 +95,17 @@ MznModel::load(PyObject *args, PyObject *keywds, bool fromFile)
       }
     }
     vector<string> models {py_string};
-    _m = parse(models, data, *includePaths, false, false, false, errorStream);
-    _e = new Env(_m);
+    _e = new Env();
+    _m = parse(*_e, models, data, *includePaths, false, false, false, errorStream);
+    _e->model(_m);
   } else {
-    char *kwlist[] = {"string","error","options"};
+    char *kwlist[] = {"string","error","options",NULL};
     if (!PyArg_ParseTupleAndKeywords(args, keywds, "s|ss", kwlist, &py_string, &errorFile, &options)) {
       PyErr_SetString(PyExc_TypeError, "MiniZinc: Model.load: Keyword parsing error");
       return -1;
     }
-    _m = parseFromString(string(py_string), errorFile, *includePaths, false, false, false, errorStream);
+    vector<SyntaxError> syntaxErrors;
+    _m = parseFromString(string(py_string), errorFile, *includePaths, false, false, false, errorStream, syntaxErrors);
     _e = new Env(_m);
   }
   if (_m) {
@@ -186,37 +188,63 @@ PyObject* MznModel::solve(PyObject* args, PyObject* kwds)
 
   SOLVE__NO_ERROR:
   vector<TypeError> typeErrors;
-  try {
-    MiniZinc::typecheck(*_e, _m, typeErrors, false);
-  } catch (LocationException& e) {
-    MZN_PYERR_SET_STRING(PyExc_RuntimeError, "MiniZinc: Model.solve:   %s: %s", e.what(), e.msg().c_str());
-    return NULL;
-  }
-  if (typeErrors.size() > 0) {
-    stringstream errorLog;
-    for (unsigned int i=0; i<typeErrors.size(); i++) {
-      errorLog << typeErrors[i].loc() << ":" << endl;
-      errorLog << typeErrors[i].what() << ": " << typeErrors[i].msg() << "\n";
+  Env* env = _e;
+  Options options;
+  if (timeLimit != 0)
+    options.setIntParam("time", timeLimit);
+  SolverInstanceBase* solver = NULL;
+  Solns2Out* s2o = NULL;
+  PyObject* errorType = NULL;
+  stringstream errorLog;
+  {
+    // Typechecking and flattening keep the GIL. They use constants() and the
+    // mutable function caches, which are shared by all threads, so only the
+    // search runs without it
+    try {
+      MiniZinc::typecheck(*_e, _m, typeErrors, false);
+    } catch (LocationException& e) {
+      errorLog << "MiniZinc: Model.solve:   " << e.what() << ": " << e.msg();
+      errorType = PyExc_RuntimeError;
+    }
+    if (errorType == NULL && typeErrors.size() > 0) {
+      for (unsigned int i=0; i<typeErrors.size(); i++) {
+        errorLog << typeErrors[i].loc() << ":" << endl;
+        errorLog << typeErrors[i].what() << ": " << typeErrors[i].msg() << "\n";
+      }
+      errorType = PyExc_TypeError;
+    }
+    if (errorType == NULL) {
+      MiniZinc::registerBuiltins(*_e, _m);
+      try {
+        FlatteningOptions fopts;
+        flatten(*env,fopts);
+      } catch (LocationException& e) {
+        errorLog << e.what() << ": " << std::endl;
+        env->dumpErrorStack(errorLog);
+        errorLog << "  " << e.msg() << std::endl;
+        errorType = PyExc_RuntimeError;
+      }
+    }
+    if (errorType == NULL) {
+      optimize(*env);
+      oldflatzinc(*env);
+      GCLock lock;
+      switch (sc) {
+        case SC_UNKNOWN:
+          break;
+        case SC_GECODE:
+          solver = new GecodeSolverInstance(*env, options);
+          s2o = new Solns2Out();
+          s2o->initFromEnv(env);
+          solver->setSolns2Out(s2o);
+          solver->processFlatZinc();
+          break;
+      }
     }
-    const std::string& tmp = errorLog.str();
-    const char* cstr = tmp.c_str();
-    PyErr_SetString(PyExc_TypeError, cstr);
-    return NULL;
   }
-  MiniZinc::registerBuiltins(*_e, _m);
-
-  Env* env = _e;
-  try {
-    FlatteningOptions fopts;
-    flatten(*env,fopts);
-  } catch (LocationException& e) {
-    stringstream errorLog;
-    errorLog << e.what() << ": " << std::endl;
-    env->dumpErrorStack(errorLog);
-    errorLog << "  " << e.msg() << std::endl;
+  if (errorType) {
     const std::string& tmp = errorLog.str();
-    const char* cstr = tmp.c_str();
-    PyErr_SetString(PyExc_RuntimeError, cstr);
+    PyErr_SetString(errorType, tmp.c_str());
     return NULL;
   }
   if (env->warnings().size()!=0)
@@ -230,27 +258,18 @@ PyObject* MznModel::solve(PyObject* args, PyObject* kwds)
     const char* cstr = tmp.c_str();
     PyErr_WarnEx(PyExc_RuntimeWarning, cstr, 1);
   }
-  optimize(*env);
-  oldflatzinc(*env);
   GCLock lock;
-  Options options;
-  if (timeLimit != 0)
-    options.setIntParam("time", timeLimit);
   delete _m;
   _m = saveModel;
   _e = new Env(_m);
-  PyMznSolver* ret = reinterpret_cast<PyMznSolver*>(PyMznSolver_new(&PyMznSolver_Type, NULL, NULL));
-  switch (sc) {
-    case SC_UNKNOWN:
-      delete env;
-      PyErr_SetString(PyExc_ValueError, "MiniZinc: Model.solve:  Solver name is not set");
-      return NULL;
-
-    case SC_GECODE: 
-      ret->solver = new GecodeSolverInstance(*env, options);
-      break;
+  if (solver == NULL) {
+    delete env;
+    PyErr_SetString(PyExc_ValueError, "MiniZinc: Model.solve:  Solver name is not set");
+    return NULL;
   }
-  ret->solver->processFlatZinc();
+  PyMznSolver* ret = reinterpret_cast<PyMznSolver*>(PyMznSolver_new(&PyMznSolver_Type, NULL, NULL));
+  ret->solver = solver;
+  ret->s2o = s2o;
   ret->env = env;
   return reinterpret_cast<PyObject*>(ret);
 }
@@ -444,7 +463,8 @@ MznModel_init(MznModel* self, PyObject* args = NULL)
   self->includePaths->push_back(std_lib_dir+"/std/");
   self->sc = MznModel::default_solver;
   stringstream errorStream;
-  self->_m = parseFromString(libNamesStr,"error.txt",*(self->includePaths),false,false,false, errorStream);
+  vector<SyntaxError> syntaxErrors;
+  self->_m = parseFromString(libNamesStr,"error.txt",*(self->includePaths),false,false,false, errorStream, syntaxErrors);
   self->_e = new Env(self->_m);
   if (!(self->_m)) {
     const std::string& tmp = errorStream.str();
@@ -489,6 +509,7 @@ MznModel_copy(MznModel* self)
   MznModel* ret = reinterpret_cast<MznModel*>(MznModel_new(&MznModel_Type, NULL, NULL));
   GCLock lock;
   ret->_m = copy(self->_e->envi(), self->_m);
+  ret->_e = new Env(ret->_m);
   ret->includePaths = new vector<string>(*(self->includePaths));
 
   ret->timeLimit = self->timeLimit;
@@ -134,8 +134,8 @@ static PyObject* MznModel_debugprint(MznModel* self);
 
 // Declare all the functions
 static PyMethodDef MznModel_methods[] = {
-  {"load", (PyCFunction)MznModel_load, METH_KEYWORDS, "Load MiniZinc model from MiniZinc file"},
-  {"load_from_string", (PyCFunction)MznModel_load_from_string, METH_KEYWORDS, "Load MiniZinc model from standard input"},
+  {"load", (PyCFunction)MznModel_load, METH_VARARGS | METH_KEYWORDS, "Load MiniZinc model from MiniZinc file"},
+  {"load_from_string", (PyCFunction)MznModel_load_from_string, METH_VARARGS | METH_KEYWORDS, "Load MiniZinc model from standard input"},
   {"addData", (PyCFunction)MznModel_addData, METH_VARARGS, "Add data to a MiniZinc model"},
   {"solve", (PyCFunction)MznModel_solve, METH_VARARGS | METH_KEYWORDS, "Solve a loaded MiniZinc model"},
   {"set_time_limit", (PyCFunction)MznModel_set_time_limit, METH_VARARGS, "Limit the execution time of the model"},
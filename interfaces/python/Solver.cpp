@@ -7,22 +7,31 @@
 
 #include "Solver.h"
 
+VarDecl*
+PyMznSolver::find(const char* name)
+{
+  if (index == NULL) {
+    index = new UNORDERED_NAMESPACE::unordered_map<std::string, VarDecl*>();
+    for (unsigned int i=0; i<_m->size(); ++i)
+      if (VarDeclI* vdi = (*_m)[i]->dyn_cast<VarDeclI>())
+        index->insert(make_pair(vdi->e()->id()->str().str(), vdi->e()));
+  }
+  UNORDERED_NAMESPACE::unordered_map<std::string, VarDecl*>::iterator it = index->find(name);
+  return it == index->end() ? NULL : it->second;
+}
+
 static PyObject*
 PyMznSolver_get_value_helper(PyMznSolver* self, const char* const name)
 {
-  for (unsigned int i=0; i<self->_m->size(); ++i) {
-    if (VarDeclI* vdi = (*(self->_m))[i]->dyn_cast<VarDeclI>()) {
-      if (strcmp(vdi->e()->id()->str().c_str(), name) == 0) {
-        GCLock Lock;
-        if (PyObject* PyValue = minizinc_to_python(vdi->e()))
-          return PyValue;
-        else {
-          char buffer[50];
-          sprintf(buffer, "Cannot retrieve the value of '%s'", name);
-          PyErr_SetString(PyExc_RuntimeError, buffer);
-          return NULL;
-        }
-      }
+  if (VarDecl* vd = self->find(name)) {
+    GCLock Lock;
+    if (PyObject* PyValue = minizinc_to_python(vd))
+      return PyValue;
+    else {
+      char buffer[50];
+      sprintf(buffer, "Cannot retrieve the value of '%s'", name);
+      PyErr_SetString(PyExc_RuntimeError, buffer);
+      return NULL;
     }
   }
   char buffer[50];
@@ -35,6 +44,10 @@ static PyObject*
 PyMznSolver_get_value(PyMznSolver* self, PyObject* args) {
   const char* name;
   PyObject* obj;
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "Solver is in use by another thread");
+    return NULL;
+  }
   if (!(self->_m)) {
     PyErr_SetString(PyExc_RuntimeError, "No model (maybe you need to call Model.next() first");
     return NULL;
@@ -47,8 +60,6 @@ PyMznSolver_get_value(PyMznSolver* self, PyObject* args) {
     name = PyUnicode_AsUTF8(obj);
     return PyMznSolver_get_value_helper(self, name);;
   } else 
-  // XXX: INEFFICIENT function to retrieve values, consider optimize it later
-  // Python Dictionary would be good
     if (PyList_Check(obj)) {
       Py_ssize_t n = PyList_GET_SIZE(obj);
       PyObject* ret = PyList_New(n);
@@ -93,16 +104,53 @@ PyMznSolver_get_value(PyMznSolver* self, PyObject* args) {
     }
 }
 
+static PyObject*
+PyMznSolver_get_array(PyMznSolver* self, PyObject* args) {
+  const char* name;
+  if (self->busy) {
+    PyErr_SetString(PyExc_RuntimeError, "Solver is in use by another thread");
+    return NULL;
+  }
+  if (!(self->_m)) {
+    PyErr_SetString(PyExc_RuntimeError, "No model (maybe you need to call Model.next() first");
+    return NULL;
+  }
+  if (!PyArg_ParseTuple(args, "s", &name)) {
+    PyErr_SetString(PyExc_TypeError, "Accept 1 argument of string");
+    return NULL;
+  }
+  VarDecl* vd = self->find(name);
+  if (vd == NULL) {
+    MZN_PYERR_SET_STRING(PyExc_RuntimeError, "'%s' not found", name);
+    return NULL;
+  }
+  return minizinc_to_python_buffer(vd);
+}
+
 
 PyObject*
 PyMznSolver::next()
 {
   if (solver==NULL)
     throw runtime_error("Solver Object not found");
-  GCLock lock;
-  SolverInstance::Status status = solver->solve();
+  if (busy) {
+    PyErr_SetString(PyExc_RuntimeError, "Solver is in use by another thread");
+    return NULL;
+  }
+  if (optimal)
+    return PyUnicode_FromString("Reached last solution");
+  SolverInstance::Status status;
+  {
+    // The search does not use Python, other threads can run in the meantime
+    PyAllowThreads allowThreads(&busy);
+    GCLock lock;
+    status = solver->solve();
+  }
   if (status == SolverInstance::SAT || status == SolverInstance::OPT) {
+    optimal = status == SolverInstance::OPT;
     _m = env->output();
+    delete index;
+    index = NULL;
     Py_RETURN_NONE; 
   }
   if (_m == NULL)
@@ -115,10 +163,12 @@ PyMznSolver::next()
 static void
 PyMznSolver_dealloc(PyMznSolver* self)
 {
-  if (self->env)
-    delete self->env;
   if (self->solver)
     delete self->solver;
+  delete self->s2o;
+  if (self->env)
+    delete self->env;
+  delete self->index;
   Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
 }
 
@@ -127,7 +177,11 @@ PyMznSolver_new(PyTypeObject* type, PyObject* args, PyObject* kwds)
 {
   PyMznSolver* self = reinterpret_cast<PyMznSolver*>(type->tp_alloc(type,0));
   self->solver = NULL;
+  self->s2o = NULL;
   self->_m = NULL;
+  self->index = NULL;
+  self->busy = false;
+  self->optimal = false;
   self->env = NULL;
   return reinterpret_cast<PyObject*>(self);
 }
@@ -143,3 +197,11 @@ PyMznSolver_next(PyMznSolver *self)
 {
   return self->next();
 }
+
+static PyObject*
+PyMznSolver_interrupt(PyMznSolver *self)
+{
+  if (self->solver)
+    self->solver->interrupt();
+  Py_RETURN_NONE;
+}
@@ -13,10 +13,19 @@
 struct PyMznSolver {
   PyObject_HEAD
   MiniZinc::SolverInstanceBase* solver;
+  // Receives the solutions of solver in the output model of env
+  MiniZinc::Solns2Out* s2o;
   MiniZinc::Env* env;
   MiniZinc::Model* _m;
+  // Output variables of _m by name, built on the first lookup after each solution
+  UNORDERED_NAMESPACE::unordered_map<std::string, MiniZinc::VarDecl*>* index;
+  // True while next() searches without the GIL
+  bool busy;
+  // True once a solution has been proved optimal, the solver would only repeat it
+  bool optimal;
 
   PyObject* next();
+  MiniZinc::VarDecl* find(const char* name);
 };
 
 static PyObject* PyMznSolver_new(PyTypeObject* type, PyObject* args, PyObject* kwds);
@@ -36,6 +45,14 @@ static PyObject* PyMznSolver_get_value_helper(PyMznSolver* self, PyObject* args)
 // returns a value or a tuple of value depending on which type argument was parsed.
 static PyObject* PyMznSolver_get_value(PyMznSolver* self, PyObject* args);
 
+// get_array accepts the name of an array of int, float or bool,
+//   returns its value as a NumPy array if NumPy is available, otherwise as a memoryview.
+static PyObject* PyMznSolver_get_array(PyMznSolver* self, PyObject* args);
+
+// Stops a search that runs in another thread as soon as possible, and all further searches.
+//   next() then returns "Reached last solution" (or "Unsatisfied" if there was none).
+static PyObject* PyMznSolver_interrupt(PyMznSolver* self);
+
 
 
 static PyMemberDef PyMznSolver_members[] = {
@@ -48,6 +65,8 @@ static PyMemberDef PyMznSolver_members[] = {
 static PyMethodDef PyMznSolver_methods[] = {
   {"next", (PyCFunction)PyMznSolver_next, METH_NOARGS, "Next Solution"},
   {"get_value",(PyCFunction)PyMznSolver_get_value, METH_VARARGS, "Get value of a variable"},
+  {"get_array",(PyCFunction)PyMznSolver_get_array, METH_VARARGS, "Get value of an array as a NumPy array or memoryview"},
+  {"interrupt",(PyCFunction)PyMznSolver_interrupt, METH_NOARGS, "Stop the search, can be called from another thread"},
   {NULL} /* Sentinel */
 };
 
@@ -110,7 +110,7 @@ one_dim_minizinc_to_python(Expression* e, const Type& type)
     case Type::BT_INT:
       return c_to_py_number(eval_int(env.envi(), e).toInt());
     case Type::BT_FLOAT:
-      return PyFloat_FromDouble(eval_float(env.envi(),e));
+      return PyFloat_FromDouble(eval_float(env.envi(),e).toDouble());
     case Type::BT_STRING:
     {
       string temp(eval_string(env.envi(), e));
@@ -180,6 +180,165 @@ minizinc_to_python(VarDecl* vd)
 }
 
 
+template<class T>
+inline T read_buffer(const char* p)
+{
+  T v;
+  memcpy(&v, p, sizeof(T));
+  return v;
+}
+
+int
+buffer_to_minizinc(PyObject* pvalue, vector<Py_ssize_t>& dimensions,
+                   vector<Expression*>& elements, Type::BaseType& code)
+{
+  Py_buffer view;
+  if (PyObject_GetBuffer(pvalue, &view, PyBUF_RECORDS_RO) == -1)
+    return -1;
+  const char* format = view.format ? view.format : "B";
+  if (*format == '@' || *format == '=')
+    format++;
+  Type::BaseType elemCode;
+  switch (format[0] != '\0' && format[1] == '\0' ? format[0] : '\0') {
+    case 'b': case 'B': case 'h': case 'H': case 'i': case 'I':
+    case 'l': case 'L': case 'q': case 'Q': case 'n': case 'N':
+      elemCode = Type::BT_INT; break;
+    case 'f': case 'd':
+      elemCode = Type::BT_FLOAT; break;
+    case '?':
+      elemCode = Type::BT_BOOL; break;
+    default:
+      PyBuffer_Release(&view);
+      MZN_PYERR_SET_STRING(PyExc_TypeError, "MiniZinc: buffer_to_minizinc: Unsupported element format '%s'", view.format ? view.format : "B");
+      return -1;
+  }
+  if (code != Type::BT_UNKNOWN && code != elemCode) {
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_TypeError, "MiniZinc: Object in an array must be of the same type");
+    return -1;
+  }
+  dimensions.assign(view.shape, view.shape + view.ndim);
+  Py_ssize_t n = 1;
+  for (int d=0; d!=view.ndim; ++d)
+    n *= view.shape[d];
+  elements.resize(n);
+  vector<Py_ssize_t> idx(view.ndim, 0);
+  for (Py_ssize_t k=0; k!=n; ++k) {
+    const char* p = static_cast<const char*>(view.buf);
+    for (int d=0; d!=view.ndim; ++d)
+      p += idx[d] * view.strides[d];
+    long long iv = 0;
+    unsigned long long uv = 0;
+    bool fUnsigned = false;
+    switch (format[0]) {
+      case 'b': iv = read_buffer<signed char>(p); break;
+      case 'B': iv = read_buffer<unsigned char>(p); break;
+      case 'h': iv = read_buffer<short>(p); break;
+      case 'H': iv = read_buffer<unsigned short>(p); break;
+      case 'i': iv = read_buffer<int>(p); break;
+      case 'I': iv = read_buffer<unsigned int>(p); break;
+      case 'l': iv = read_buffer<long>(p); break;
+      case 'L': uv = read_buffer<unsigned long>(p); fUnsigned = true; break;
+      case 'q': iv = read_buffer<long long>(p); break;
+      case 'Q': uv = read_buffer<unsigned long long>(p); fUnsigned = true; break;
+      case 'n': iv = read_buffer<Py_ssize_t>(p); break;
+      case 'N': uv = read_buffer<size_t>(p); fUnsigned = true; break;
+      case 'f': elements[k] = new FloatLit(Location(), read_buffer<float>(p)); break;
+      case 'd': elements[k] = new FloatLit(Location(), read_buffer<double>(p)); break;
+      case '?': elements[k] = new BoolLit(Location(), read_buffer<unsigned char>(p) != 0); break;
+    }
+    if (elemCode == Type::BT_INT) {
+      if (fUnsigned) {
+        if (uv > static_cast<unsigned long long>(LLONG_MAX)) {
+          PyBuffer_Release(&view);
+          PyErr_SetString(PyExc_OverflowError, "MiniZinc: Python integer value is larger than 2^63-1");
+          return -1;
+        }
+        iv = static_cast<long long>(uv);
+      }
+      elements[k] = IntLit::a(IntVal(iv));
+    }
+    // Next index in row-major order
+    for (int d=view.ndim; d--;) {
+      if (++idx[d] < view.shape[d])
+        break;
+      idx[d] = 0;
+    }
+  }
+  PyBuffer_Release(&view);
+  code = elemCode;
+  return 0;
+}
+
+PyObject*
+minizinc_to_python_buffer(VarDecl* vd)
+{
+  GCLock Lock;
+  if (vd==NULL || vd->e()==NULL) {
+    PyErr_SetString(PyExc_ValueError, "MiniZinc_to_Python: Value is not set");
+    return NULL;
+  }
+  Type type = vd->type();
+  if (type.dim() == 0 || type.st() == Type::ST_SET ||
+      (type.bt() != Type::BT_INT && type.bt() != Type::BT_FLOAT && type.bt() != Type::BT_BOOL)) {
+    PyErr_SetString(PyExc_TypeError, "MiniZinc_to_Python: Only arrays of int, float or bool can be returned as buffers");
+    return NULL;
+  }
+  Env env(NULL);
+  ArrayLit* al = eval_par(env.envi(), vd->e())->cast<ArrayLit>();
+  const char* format;
+  size_t itemsize;
+  switch (type.bt()) {
+    case Type::BT_INT: format = "q"; itemsize = sizeof(long long); break;
+    case Type::BT_FLOAT: format = "d"; itemsize = sizeof(double); break;
+    default: format = "?"; itemsize = 1;
+  }
+  PyObject* bytes = PyByteArray_FromStringAndSize(NULL, al->v().size() * itemsize);
+  if (bytes == NULL)
+    return NULL;
+  char* data = PyByteArray_AS_STRING(bytes);
+  for (unsigned int i=0; i<al->v().size(); i++) {
+    switch (type.bt()) {
+      case Type::BT_INT: {
+        long long v = eval_int(env.envi(), al->v()[i]).toInt();
+        memcpy(data + i*itemsize, &v, itemsize);
+        break;
+      }
+      case Type::BT_FLOAT: {
+        double v = eval_float(env.envi(), al->v()[i]).toDouble();
+        memcpy(data + i*itemsize, &v, itemsize);
+        break;
+      }
+      default:
+        data[i] = eval_bool(env.envi(), al->v()[i]) ? 1 : 0;
+    }
+  }
+  PyObject* view = PyMemoryView_FromObject(bytes);
+  Py_DECREF(bytes);
+  if (view == NULL)
+    return NULL;
+  PyObject* shape = PyTuple_New(al->dims());
+  for (int i=0; i<al->dims(); i++)
+    PyTuple_SET_ITEM(shape, i, c_to_py_number(al->max(i) - al->min(i) + 1));
+  PyObject* ret = PyObject_CallMethod(view, "cast", "sO", format, shape);
+  Py_DECREF(shape);
+  Py_DECREF(view);
+  if (ret == NULL)
+    return NULL;
+  // NumPy is optional: without it the memoryview is returned
+  if (PyObject* numpy = PyImport_ImportModule("numpy")) {
+    PyObject* array = PyObject_CallMethod(numpy, "asarray", "O", ret);
+    Py_DECREF(numpy);
+    if (array) {
+      Py_DECREF(ret);
+      return array;
+    }
+  }
+  PyErr_Clear();
+  return ret;
+}
+
+
 inline Expression*
 one_dim_python_to_minizinc(PyObject* pvalue, Type::BaseType& code)
 {
@@ -314,6 +473,30 @@ python_to_minizinc(PyObject* pvalue, const ASTExprVec<TypeInst>& ranges)
     callArgument[dimensions.size()] = new ArrayLit(Location(), onedArray);
     Expression* rhs = new Call(Location(), callName, callArgument);
     return rhs;
+  } else if (is_numeric_buffer(pvalue)) {
+    vector<Py_ssize_t> dimensions;
+    vector<Expression*> onedArray;
+    Type::BaseType code = Type::BT_UNKNOWN;
+    if (buffer_to_minizinc(pvalue, dimensions, onedArray, code) == -1)
+      return NULL;
+    if (dimensions.empty())
+      return onedArray[0];
+    if (ranges.size()!=dimensions.size()) {
+      PyErr_SetString(PyExc_ValueError, "MiniZinc: python_to_minizinc: size of declared array and actual array not matched");
+      return NULL;
+    }
+    vector<Expression*> callArgument(dimensions.size()+1);
+    stringstream buffer;
+    buffer << "array" << dimensions.size() << "d";
+    for (int i=0; i!=dimensions.size(); ++i) {
+      Expression* domain = ranges[i]->domain();
+      if (domain == NULL)
+        callArgument[i] = new BinOp(Location(), IntLit::a(IntVal(1)), BOT_DOTDOT, IntLit::a(IntVal(dimensions[i])));
+      else
+        callArgument[i] = domain;
+    }
+    callArgument[dimensions.size()] = new ArrayLit(Location(), onedArray);
+    return new Call(Location(), buffer.str(), callArgument);
   } else {
     Type::BaseType code = Type::BT_UNKNOWN;
     Expression* rhs = one_dim_python_to_minizinc(pvalue, code); 
@@ -364,6 +547,32 @@ python_to_minizinc(PyObject* pvalue, Type& returnType, vector<pair<int, int> >&
     returnType.dim(dimList.size());
     Expression* rhs = new ArrayLit(Location(), v, dimList);
     return rhs;
+  } else if (is_numeric_buffer(pvalue)) {
+    vector<Py_ssize_t> dimensions;
+    vector<Expression*> v;
+    if (buffer_to_minizinc(pvalue, dimensions, v, code) == -1)
+      return NULL;
+    returnType = Type();
+    returnType.bt(code);
+    if (dimensions.empty())
+      return v[0];
+    if (dimList.empty())
+      for (int i=0; i!=dimensions.size(); i++)
+        dimList.push_back(pair<Py_ssize_t,Py_ssize_t>(0,dimensions[i]-1));
+    else {
+      if (dimList.size()!=dimensions.size()) {
+        PyErr_SetString(PyExc_ValueError, "MiniZinc: python_to_minizinc: size of declared and actual array not matched");
+        return NULL;
+      }
+      for (int i=0; i!=dimensions.size(); i++) {
+        if ( (dimList[i].second - (dimList[i].first) + 1) != dimensions[i] ) {
+          PyErr_SetString(PyExc_ValueError, "MiniZinc: python_to_minizinc: size of each dimension of python array not matched");
+          return NULL;
+        }
+      }
+    }
+    returnType.dim(dimList.size());
+    return new ArrayLit(Location(), v, dimList);
   } else {
     Expression* rhs = one_dim_python_to_minizinc(pvalue, code); 
     returnType = Type();
@@ -43,6 +43,7 @@
 #include <minizinc/builtins.hh>
 #include <minizinc/file_utils.hh>
 #include <minizinc/solvers/gecode_solverinstance.hh>
+#include <minizinc/solns2out.hh>
 #include <minizinc/prettyprinter.hh>
 #include <minizinc/copy.hh>
 
@@ -73,6 +74,27 @@ do {											\
 	PyErr_SetString(py_type_error, buffer);	\
 } while (0)
 
+// Releases the GIL for its lifetime, so that other Python threads run while a solver
+// searches. No Python API may be used while it exists.
+// If busy is given, it is true for the lifetime of the object; it is set and reset
+// while holding the GIL, so other threads can check it to refuse using the object.
+class PyAllowThreads {
+public:
+  PyAllowThreads(bool* busy = NULL) : _busy(busy) {
+    if (_busy)
+      *_busy = true;
+    _save = PyEval_SaveThread();
+  }
+  ~PyAllowThreads() {
+    PyEval_RestoreThread(_save);
+    if (_busy)
+      *_busy = false;
+  }
+private:
+  PyThreadState* _save;
+  bool* _busy;
+};
+
 // Converts C++ long long to appropriate Python integer type
 inline PyObject* c_to_py_number(long long);
 // Converts Python integer type to C++ value, returns -1 if error occurred
@@ -136,6 +158,34 @@ inline Expression* one_dim_python_to_minizinc(PyObject* pvalue, Type::BaseType&
  */
  Expression* python_to_minizinc(PyObject* pvalue, Type& type, vector<pair<int, int> >& dimList);
 
+/*
+ * Description: Converts an object supporting the buffer protocol (for example a
+ *              NumPy array or scalar) of integers, floats or booleans
+ *              to minizinc literals, reading the memory directly instead of
+ *              converting each element to a Python object first
+ * Return:  0 if success, -1 if error occurred (error string is set)
+ *          dimensions: size of each dimension, empty for a scalar
+ *          elements: the elements in row-major order
+ *          code: base type of the elements
+ * Note: Need an outer GCLock for this to work
+ */
+int buffer_to_minizinc(PyObject* pvalue, vector<Py_ssize_t>& dimensions,
+                       vector<Expression*>& elements, Type::BaseType& code);
+
+// Whether pvalue should be converted by buffer_to_minizinc
+inline bool is_numeric_buffer(PyObject* pvalue) {
+  return PyObject_CheckBuffer(pvalue) && !PyBytes_Check(pvalue) && !PyByteArray_Check(pvalue);
+}
+
+/*
+ * Description: Packs the values of a par int, float or bool array into a new
+ *              buffer, returned as a NumPy array if NumPy is available and as
+ *              a memoryview otherwise. Index sets are not kept, every
+ *              dimension starts from 0
+ * Return:  the array, NULL if error occurred
+ */
+PyObject* minizinc_to_python_buffer(VarDecl* vd);
+
 /*
  * Used only when importing model from MiniZinc file
  * Return: MiniZinc expression, NULL if error occurred
@@ -59,14 +59,29 @@ minizinc.Model.Construct:
 * Functions *
 minizinc.Model.satisfy
 minizinc.Model.next
+minizinc.Model.solve_async:
+	accepts a list of variables, and optionally an objective, maximize, ann, data, solver, time and limit
+	adds the solve item and flattens a copy of the model, then searches in a worker thread
+	returns:
+		a SolveFuture, iterating over it yields the values of the variables for each solution
+* Threads *
+	The search releases the GIL, so models can be solved in parallel from several threads.
+	Parsing and flattening keep the GIL, as the MiniZinc library is not safe to use from
+	several threads at once. A model must be created and solved in the same thread.
 '''
 
 import sys
+import threading
 import minizinc_internal
 import predicate
 import annotation
 #import inspect
 
+try:
+	import queue
+except ImportError:
+	import Queue as queue
+
 if sys.version < '3':
 	integer_types = (int, long, )
 	python_types = (int, long, float, bool, str)
@@ -904,7 +919,7 @@ class Construct(Declaration):
 		try:
 			self.obj = model.mznmodel.Declaration(self.name, unwrap(arg1))
 		except:
-			print sys.exc_info()[0]
+			print(sys.exc_info()[0])
 			raise
 
 		if self.has_minizinc_objects:
@@ -1388,6 +1403,17 @@ class Model(object):
 		self.__solve(2, expr, ann, data, solver, time)
 	def minimize(self, expr, ann = None, data = None, solver = 'gecode', time = 0):
 		self.__solve(1, expr, ann, data, solver, time)
+	def solve_async(self, variables, objective = None, maximize = False, ann = None, data = None, solver = 'gecode', time = 0, limit = 0):
+		if objective is None:
+			code = 0
+		elif maximize:
+			code = 2
+		else:
+			code = 1
+		# MiniZinc heaps are per thread: the model is flattened here, where it was
+		# built and where the solver is freed, only the search runs in the worker
+		self.__solve(code, objective, ann, data, solver, time)
+		return SolveFuture(self.mznsolver, variables, limit)
 	def reset(self):
 		self.__init__()
 
@@ -1413,3 +1439,70 @@ class Model(object):
 	def _debugprint(self):
 		self.mznmodel.debugprint()
 
+
+
+class SolveFuture(object):
+	'''
+	Returned by Model.solve_async: the search runs in a worker thread.
+	Iterating yields the solutions as they are found, each a list with the values
+	of the variables given to solve_async. At most 'limit' solutions are searched
+	for, 0 means all of them.
+	cancel() interrupts the search; result() waits for the end of the search and
+	returns the list of all solutions.
+	'''
+	def __init__(self, solver, variables, limit = 0):
+		self.names = [var if isinstance(var, str) else var.name for var in variables]
+		self.limit = limit
+		self.solutions = []
+		self.error = None
+		self.cancelled = False
+		self._solver = solver
+		self._queue = queue.Queue()
+		self._done = threading.Event()
+		self._thread = threading.Thread(target = self._run)
+		self._thread.daemon = True
+		self._thread.start()
+
+	def _run(self):
+		try:
+			while not self.cancelled:
+				if self._solver.next() is not None:
+					break
+				solution = self._solver.get_value(self.names)
+				self.solutions.append(solution)
+				self._queue.put(solution)
+				if len(self.solutions) == self.limit:
+					break
+		except Exception as e:
+			self.error = e
+		finally:
+			self._done.set()
+			self._queue.put(None)
+
+	def __iter__(self):
+		return self
+
+	def __next__(self):
+		solution = self._queue.get()
+		if solution is None:
+			# Further calls stop as well
+			self._queue.put(None)
+			if self.error is not None:
+				raise self.error
+			raise StopIteration
+		return solution
+	next = __next__
+
+	def cancel(self):
+		self.cancelled = True
+		self._solver.interrupt()
+
+	def done(self):
+		return self._done.is_set()
+
+	def result(self, timeout = None):
+		if not self._done.wait(timeout):
+			raise RuntimeError('MiniZinc: SolveFuture.result: Search not finished after ' + str(timeout) + ' seconds')
+		if self.error is not None:
+			raise self.error
+		return list(self.solutions)
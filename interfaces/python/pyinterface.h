@@ -145,8 +145,8 @@ PyObject* eval_type(TypeInst* ti) {
 void add_to_dictionary (FunctionI* fi, PyObject* toAdd)
 {
   ASTExprVec<VarDecl> params = fi->params();
-  const char* str = fi->id().str().c_str();
-  PyObject* key = PyUnicode_FromString(str);
+  const std::string str = fi->id().str();
+  PyObject* key = PyUnicode_FromString(str.c_str());
 
   PyObject* args_and_return_type_tuple = PyTuple_New(2);
   PyObject* args_tuple = PyTuple_New(params.size());
@@ -217,8 +217,8 @@ public:
 
 
 static PyMethodDef Mzn_methods[] = {
-  {"load", (PyCFunction)Mzn_load, METH_KEYWORDS, "Load MiniZinc model from MiniZinc file"},
-  {"load_from_string", (PyCFunction)Mzn_load_from_string, METH_KEYWORDS, "Load MiniZinc model from stdin"},
+  {"load", (PyCFunction)Mzn_load, METH_VARARGS | METH_KEYWORDS, "Load MiniZinc model from MiniZinc file"},
+  {"load_from_string", (PyCFunction)Mzn_load_from_string, METH_VARARGS | METH_KEYWORDS, "Load MiniZinc model from stdin"},
   {"BinOp", (PyCFunction)Mzn_BinOp, METH_VARARGS, "Add a binary expression into the model"},
   {"UnOp", (PyCFunction)Mzn_UnOp, METH_VARARGS, "Add a unary expression into the model"},
   {"Id", (PyCFunction)Mzn_Id, METH_VARARGS, "Return a MiniZinc Variable containing the given name"},
@@ -227,7 +227,7 @@ static PyMethodDef Mzn_methods[] = {
   {"at", (PyCFunction)Mzn_at, METH_VARARGS, "Array Access"},
   {"retrieveNames", (PyCFunction)Mzn_retrieveNames, METH_VARARGS, "Returns names of MiniZinc functions and variables"},
   {"lock", (PyCFunction)Mzn_lock, METH_NOARGS, "Internal: Create a lock for garbage collection"},
-  {"unlock", (PyCFunction)Mzn_lock, METH_NOARGS, "Internal: Unlock a lock for garbage collection"},
+  {"unlock", (PyCFunction)Mzn_unlock, METH_NOARGS, "Internal: Unlock a lock for garbage collection"},
   {NULL}
 };
 
@@ -1,4 +1,5 @@
 from distutils.core import setup, Extension
+import os
 import sys
 
 EXTRA_COMPILE_ARGS = [
@@ -9,10 +10,18 @@ EXTRA_COMPILE_ARGS = [
 ]
 EXTRA_LINK_ARGS = []
 
+# To build against a build directory of libminizinc instead of an installed one,
+# set MZN_BUILD_DIR to it. The libraries must be configured with
+# -DCMAKE_POSITION_INDEPENDENT_CODE=ON to be linked into the extension.
+MZN_BUILD_DIR = os.environ.get('MZN_BUILD_DIR')
+if MZN_BUILD_DIR:
+    EXTRA_COMPILE_ARGS.extend(['-I', MZN_BUILD_DIR])
+    EXTRA_LINK_ARGS.extend(['-L', MZN_BUILD_DIR])
+
 if sys.platform == 'darwin':
     EXTRA_COMPILE_ARGS.extend([
         '-stdlib=libc++',
-        '-arch', 'x86_64'
+        '-arch', 'x86_64',
         '-mmacosx-version-min=10.8',
     ])
     EXTRA_LINK_ARGS.extend(['-arch', 'x86_64', '-stdlib=libc++', '-mmacosx-version-min=10.8'])
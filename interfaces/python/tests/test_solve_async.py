@@ -0,0 +1,88 @@
+##@file test_solve_async.py
+# Solves several models at the same time with Model.solve_async and checks
+# the solutions against a sequential solve of the same models.
+#
+# Run after building the extension, with MZN_STDLIB_DIR pointing to
+# share/minizinc:
+#	python tests/test_solve_async.py
+
+import os
+import sys
+import threading
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+import minizinc
+
+N_MODELS = 8
+
+def sums_model(k):
+	# x + y = k, with 0 <= x, y <= k: k+1 solutions
+	m = minizinc.Model()
+	x = m.Variable(0, k)
+	y = m.Variable(0, k)
+	m.Constraint(x + y == k)
+	return m, x, y
+
+def solve_sequential(k):
+	m, x, y = sums_model(k)
+	m.satisfy()
+	solutions = []
+	while m.next():
+		solutions.append([x.get_value(), y.get_value()])
+	return solutions
+
+def test_all_solutions():
+	expected = [sorted(solve_sequential(k)) for k in range(1, N_MODELS+1)]
+	futures = []
+	for k in range(1, N_MODELS+1):
+		m, x, y = sums_model(k)
+		futures.append(m.solve_async([x, y]))
+	for k, future in enumerate(futures):
+		solutions = sorted(future.result(60))
+		assert solutions == expected[k], \
+			'model ' + str(k+1) + ': ' + str(solutions) + ' != ' + str(expected[k])
+		assert len(solutions) == k+2
+
+def test_optimisation_and_limit():
+	optimal = []
+	limited = []
+	for k in range(1, N_MODELS+1):
+		m, x, y = sums_model(k)
+		optimal.append(m.solve_async([x], objective = x, maximize = True))
+		m, x, y = sums_model(k)
+		limited.append(m.solve_async([x, y], limit = 1))
+	for k, future in enumerate(optimal):
+		solutions = future.result(60)
+		assert solutions[-1] == [k+1], str(solutions[-1]) + ' != ' + str([k+1])
+	for future in limited:
+		assert len(future.result(60)) == 1
+
+def test_threads():
+	# Every thread builds its own models and solves them concurrently
+	errors = []
+	def run(k):
+		try:
+			m, x, y = sums_model(k)
+			assert len(m.solve_async([x, y]).result(60)) == k+1
+		except Exception as e:
+			errors.append(e)
+	threads = [threading.Thread(target = run, args = (k,)) for k in range(1, N_MODELS+1)]
+	for t in threads:
+		t.start()
+	for t in threads:
+		t.join()
+	assert not errors, str(errors)
+
+def test_cancel():
+	m, x, y = sums_model(1000)
+	future = m.solve_async([x, y])
+	future.cancel()
+	solutions = future.result(60)
+	assert future.done()
+	assert len(solutions) <= 1001
+
+if __name__ == '__main__':
+	for test in [test_all_solutions, test_optimisation_and_limit, test_threads, test_cancel]:
+		test()
+		print(test.__name__ + ' ... passed')
+	sys.exit(0)
@@ -32,6 +32,7 @@
 #include <minizinc/prettyprinter.hh>
 //#include <ostream>
 
+#include <list>
 #include <map>
 
 
@@ -442,6 +443,7 @@ namespace MiniZinc {
         propagateViews(fChanges);
         propagateImplViews(fChanges);
       } while ( fChanges );
+      finalizeCliqueNumbers();
 
       MIPD__stats[ N_POSTs__varsInvolved ] = vVarDescr.size();
     }
@@ -642,7 +644,8 @@ namespace MiniZinc {
     /// Could be better to mark the calls instead:
     UNORDERED_NAMESPACE::unordered_set<Call*> sCallLinEq2, sCallInt2Float, sCallLinEqN;
     
-    class TClique : public std::vector<LinEq2Vars> {       // need more info?
+    /// A list so that joining cliques is a constant-time splice
+    class TClique : public std::list<LinEq2Vars> {       // need more info?
     public:
       /// This function takes the 1st variable && relates all to it
       /// Return false if contrad / disconnected graph
@@ -653,6 +656,27 @@ namespace MiniZinc {
     typedef std::vector<TClique> TCLiqueList;
     TCLiqueList aCliques;
     
+    /// Union-find forest over the variable indices (payloads) in vVarDescr.
+    /// While cliques are being joined, only a root's nClique is valid
+    std::vector<int> aCliqueParent;
+    
+    /// The root of variable iVar's tree, with path halving
+    int findCliqueRoot( int iVar ) {
+      while ( aCliqueParent.size() < vVarDescr.size() )    // new variables are roots
+        aCliqueParent.push_back( aCliqueParent.size() );
+      while ( aCliqueParent[iVar] != iVar ) {
+        aCliqueParent[iVar] = aCliqueParent[ aCliqueParent[iVar] ];
+        iVar = aCliqueParent[iVar];
+      }
+      return iVar;
+    }
+    
+    /// Make the clique number valid for every variable
+    void finalizeCliqueNumbers() {
+      for ( int iVar=0; iVar<vVarDescr.size(); ++iVar )
+        vVarDescr[iVar].nClique = vVarDescr[ findCliqueRoot(iVar) ].nClique;
+    }
+    
     /// register a 2-variable lin eq
     /// add it to the var clique, joining the participants' cliques if needed
     void put2VarsConnection( LinEq2Vars& led, bool fCheckinitExpr=true ) {
@@ -669,7 +693,7 @@ namespace MiniZinc {
           if ( fCheckinitExpr && vd->e() )
             checkInitExpr(vd);
         } else {
-          int nMaybeClq = vVarDescr[vd->payload()].nClique;
+          int nMaybeClq = vVarDescr[ findCliqueRoot( vd->payload() ) ].nClique;
           if ( nMaybeClq >= 0 )
             nCliqueAvailable = nMaybeClq;
 //           MZN_MIPD__assert_hard( nCliqueAvailable>=0 );
@@ -684,21 +708,21 @@ namespace MiniZinc {
         << " of size " << aCliques[nCliqueAvailable].size() );
       TClique& clqNew = aCliques[nCliqueAvailable];
       clqNew.push_back( led );
+      int iRootNew = -1;
       for ( auto vd : led.vd ) {       // merging cliques
-        int& nMaybeClq = vVarDescr[vd->payload()].nClique;
+        int iRoot = findCliqueRoot( vd->payload() );
+        int nMaybeClq = vVarDescr[iRoot].nClique;
         if ( nMaybeClq >= 0 && nMaybeClq != nCliqueAvailable ) {
           TClique& clqOld = aCliques[nMaybeClq];
           MZN_MIPD__assert_hard( clqOld.size() );
-          for ( auto& eq2 : clqOld ) {
-            for ( auto vd : eq2.vd ) {    // point all the variables to the new clique
-              vVarDescr[ vd->payload() ].nClique = nCliqueAvailable;
-            }
-          }
-          clqNew.insert(clqNew.end(), clqOld.begin(), clqOld.end());
-          clqOld.clear();                // Can use C++11 move      TODO
+          clqNew.splice(clqNew.end(), clqOld);
           DBGOUT_MIPD ( "    +++ Joining cliques" );
-        }          
-        nMaybeClq = nCliqueAvailable;  // Could mark as 'unused'  TODO
+        }
+        if ( iRootNew < 0 )
+          iRootNew = iRoot;
+        else if ( iRoot != iRootNew )
+          aCliqueParent[iRoot] = iRootNew;
+        vVarDescr[iRootNew].nClique = nCliqueAvailable;  // Could mark as 'unused'  TODO
       }
     }
     
@@ -717,33 +741,38 @@ namespace MiniZinc {
         TMapVars;
       TMapVars mRef0, mRef1;   // to the main var 0, 1
       
+      /// Check existing connection v1 = A*v2 + B among the arcs m from v1
+      static bool checkExistingArc(const TMapVars& m, VarDecl* v1, VarDecl* v2,
+                                   double A, double B, bool fReportRepeat=true) {
+        auto it2 = m.find(v2);
+        if ( m.end() != it2 ) {
+          MZN_MIPD__assert_hard( std::fabs( it2->second.first - A )
+            < 1e-6 * std::max( std::fabs(it2->second.first), std::fabs(A) ) );
+          MZN_MIPD__assert_hard( std::fabs( it2->second.second - B )
+            < 1e-6 * std::max( std::fabs(it2->second.second), std::fabs(B) ) + 1e-6 );
+          MZN_MIPD__assert_hard( std::fabs( A ) != 0.0 );
+          MZN_MIPD__assert_soft ( !fVerbose || std::fabs( A ) > 1e-12,
+            " Very small coef: "
+              << v1->id()->str() << " = "
+              << A << " * " << v2->id()->str()
+              << " + " << B );
+          if ( fReportRepeat )
+            MZN_MIPD__assert_soft ( !fVerbose, "LinEqGraph: eqn between "
+              << v1->id()->str() << " && " << v2->id()->str()
+              << " is repeated. " );
+          return true;
+        }
+        return false;
+      }
+      
       class TMatrixVars : public UNORDERED_NAMESPACE::unordered_map<VarDecl*, TMapVars> {
       public:
         /// Check existing connection
         template <class IVarDecl>
         bool checkExistingArc(IVarDecl begV, double A, double B, bool fReportRepeat=true) {
           auto it1 = this->find(*begV);
-          if ( this->end() != it1 ) {
-            auto it2 = it1->second.find(*(begV+1));
-            if ( it1->second.end() != it2 ) {
-              MZN_MIPD__assert_hard( std::fabs( it2->second.first - A )
-                < 1e-6 * std::max( std::fabs(it2->second.first), std::fabs(A) ) );
-              MZN_MIPD__assert_hard( std::fabs( it2->second.second - B )
-                < 1e-6 * std::max( std::fabs(it2->second.second), std::fabs(B) ) + 1e-6 );
-              MZN_MIPD__assert_hard( std::fabs( A ) != 0.0 );
-              MZN_MIPD__assert_soft ( !fVerbose || std::fabs( A ) > 1e-12,
-                " Very small coef: "
-                  << (*begV)->id()->str() << " = "
-                  << A << " * " << (*(begV+1))->id()->str()
-                  << " + " << B );
-              if ( fReportRepeat )
-                MZN_MIPD__assert_soft ( !fVerbose, "LinEqGraph: eqn between "
-                  << (*begV)->id()->str() << " && " << (*(begV+1))->id()->str()
-                  << " is repeated. " );
-              return true;
-            }
-          }
-          return false;
+          return this->end() != it1 &&
+            TCliqueSorter::checkExistingArc( it1->second, *begV, *(begV+1), A, B, fReportRepeat );
         }
       };
       
@@ -782,45 +811,53 @@ namespace MiniZinc {
         /// Propagate linear relations from the given variable
         void propagate(iterator itStart, TMapVars& mWhereStore) {
           MZN_MIPD__assert_hard( this->end()!=itStart );
-          TMatrixVars mTemp;
-          mTemp[itStart->first] = itStart->second;       // init with existing
+          mWhereStore = itStart->second;       // init with existing
           DBGOUT_MIPD ( "Propagation started from "
             << itStart->first->id()->str()
             << "  having " << itStart->second.size() << " connections" );
-          propagate2(itStart, itStart, std::make_pair(1.0, 0.0), mTemp);
-          mWhereStore = mTemp.begin()->second;
+          propagate2(itStart, mWhereStore);
           MZN_MIPD__assert_hard_msg( mWhereStore.size() == this->size()-1,
-            "Variable " << (*(mTemp.begin()->first))
+            "Variable " << (*(itStart->first))
             << " should be connected to all others in the clique, but "
             << "|edges|==" << mWhereStore.size()
             << ", |all nodes|==" << this->size() );
         }
-        /// Propagate linear relations from it1 via it2
-        void propagate2(iterator itSrc, iterator itVia,
-                        std::pair<double, double> rel, TMatrixVars& mWhereStore) {
-          for ( auto itDst=itVia->second.begin(); itDst!=itVia->second.end(); ++itDst ) {
+        /// Propagate linear relations from itSrc depth-first through the graph.
+        /// Uses an explicit stack, long chains of views would overflow recursion
+        void propagate2(iterator itSrc, TMapVars& mWhereStore) {
+          struct TStep {
+            iterator itVia;
+            TMapVars::iterator itDst;
+            std::pair<double, double> rel;
+          };
+          std::vector<TStep> aStack( 1, TStep{ itSrc, itSrc->second.begin(),
+                                               std::make_pair(1.0, 0.0) } );
+          while ( !aStack.empty() ) {
+            TStep& step = aStack.back();
+            if ( step.itVia->second.end() == step.itDst ) {
+              aStack.pop_back();
+              continue;
+            }
+            auto itDst = step.itDst++;
           // Transform x1=A1x2+B1, x2=A2x3+B2 into x1=A1A2x3+A1B2+B1
             if ( itDst->first == itSrc->first )
               continue;
-            const double A1A2 = rel.first * itDst->second.first;
-            const double A1B2plusB1 = rel.first*itDst->second.second + rel.second;
-            bool fDive=true;
-            if ( itSrc != itVia ) {
-              PVarDecl vd[2] = { itSrc->first, itDst->first };
-              if ( ! mWhereStore.checkExistingArc(vd, A1A2, A1B2plusB1, false) ) {
-                mWhereStore[vd[0]][vd[1]] = std::make_pair(A1A2, A1B2plusB1);
-                DBGOUT_MIPD ( "   PROPAGATING: "
-                  << vd[0]->id()->str() << " = "
-                  << A1A2 << " * " << vd[1]->id()->str()
-                  << " + " << A1B2plusB1 );
-              } else
-                fDive = false;
-            }
-            if ( fDive ) {
-              auto itDST = this->find(itDst->first);
-              MZN_MIPD__assert_hard( this->end() != itDST );
-              propagate2(itSrc, itDST, std::make_pair(A1A2, A1B2plusB1), mWhereStore);
+            const double A1A2 = step.rel.first * itDst->second.first;
+            const double A1B2plusB1 = step.rel.first*itDst->second.second + step.rel.second;
+            if ( itSrc != step.itVia ) {
+              if ( TCliqueSorter::checkExistingArc(mWhereStore, itSrc->first, itDst->first,
+                                                   A1A2, A1B2plusB1, false) )
+                continue;
+              mWhereStore[itDst->first] = std::make_pair(A1A2, A1B2plusB1);
+              DBGOUT_MIPD ( "   PROPAGATING: "
+                << itSrc->first->id()->str() << " = "
+                << A1A2 << " * " << itDst->first->id()->str()
+                << " + " << A1B2plusB1 );
             }
+            auto itDST = this->find(itDst->first);
+            MZN_MIPD__assert_hard( this->end() != itDST );
+            aStack.push_back( TStep{ itDST, itDST->second.begin(),
+                                     std::make_pair(A1A2, A1B2plusB1) } );
           }
         }        
       };
@@ -1806,85 +1843,56 @@ namespace MiniZinc {
       << " from " << (*this) );
     if ( this->empty() )
       return;
+    if ( !( intv.left < intv.right ) )                      // empty open interval
+      return;
     iterator it1 = ( Interval<N>::infMinus() == intv.left ) ?
-      this->lower_bound( Interval<N>( intv.left, intv.right ) ) :
-      this->upper_bound( Interval<N>( intv.left, intv.right ) );
-    auto it2Del1 = it1;                                     // from which to delete
+      this->lower_bound( intv ) : this->upper_bound( intv );
+    // A piece of the interval before it1 which overlaps intv, if any:
+    Interval<N> intvTail;
+    bool fTail = false;
     if ( this->begin() != it1 ) {
-      --it1;
-      const N it1l = it1->left;
-      MZN_MIPD__assert_hard( it1l <= intv.left );
-      if ( it1->right > intv.left ) {                       // split it
-        it2Del1 = split( it1, intv.left ).second;
-//         it1->right = intv.left;  READ-ONLY
-//         this->erase(it1);
-//         it1 = this->end();
-//         auto iR = this->insert( Interval<N>( it1l, intv.left ) );
-//         MZN_MIPD__assert_hard( iR.second );
+      iterator it0 = it1-1;
+      MZN_MIPD__assert_hard( it0->left <= intv.left );
+      if ( it0->right > intv.left ) {                       // split it
+        intvTail = Interval<N>( intv.left, it0->right );
+        *it0 = Interval<N>( it0->left, intv.left );
+        fTail = true;
       }
     }
-    DBGOUT_MIPD__( "; after split 1: " << (*this) );
-    // Processing the right end:
-    auto it2 = this->lower_bound( Interval<N>( intv.right, intv.right+1 ) );
-    auto it2Del2 = it2;
-    if ( this->begin() != it2 ) {
-      --it2;
-      MZN_MIPD__assert_hard( it2->left < intv.right );
-      const N it2r = it2->right;
-      if ( ( Interval<N>::infPlus() == intv.right ) ?
-        ( it2r > intv.right ) : ( it2r >= intv.right ) ) {   // >=: split it
-//         it2Del2 = split( it2, intv.right ).second;
-          const bool fEEE = (it2Del1 == it2);
-          this->erase(it2);
-          it2 = this->end();
-          it2Del2 = this->insert( Interval<N>( intv.right, it2r ) );
-          if ( fEEE )
-            it2Del1 = it2Del2;
-      }
+    // Processing the right end. All intervals in [it1, it2) start inside intv
+    iterator it2 = std::lower_bound( it1, this->end(),
+                                     Interval<N>( intv.right, intv.right ) );
+    N rightLast = Interval<N>::infMinus();                 // the last of them ends here
+    bool fLast = false;
+    if ( it1 != it2 ) {
+      MZN_MIPD__assert_hard( (it2-1)->left < intv.right );
+      rightLast = (it2-1)->right;
+      fLast = true;
+    } else if ( fTail ) {
+      rightLast = intvTail.right;
+      fLast = true;
     }
-    DBGOUT_MIPD__( "; after split 2: " << (*this) );
-    DBGOUT_MIPD__( "; cutting out: " << SetOfIntervals(it2Del1, it2Del2) );
-#ifdef MZN_DBG_CHECK_ITER_CUTOUT
-    {
-      auto it=this->begin();
-      int nO=0;
-      do {
-        if ( it==it2Del1 ) {
-          MZN_MIPD__assert_hard( !nO );
-          ++ nO;
-        }
-        if ( it==it2Del2 ) {
-          MZN_MIPD__assert_hard( 1==nO );
-          ++ nO;
-        }
-        if ( this->end()==it )
-          break;
-        ++it;
-      } while ( 1 );
-      MZN_MIPD__assert_hard( 2==nO );
-    }
-#endif
-    this->erase( it2Del1,  it2Del2 );
+    const bool fKeepRight = fLast &&
+      ( ( Interval<N>::infPlus() == intv.right ) ?
+        ( rightLast > intv.right ) : ( rightLast >= intv.right ) );
+    DBGOUT_MIPD__( "; cutting out: " << SetOfIntervals(it1, it2) );
+    if ( fKeepRight ) {
+      const Interval<N> intvRight( intv.right, rightLast );
+      if ( it1 == it2 )
+        this->Base::insert( it1, intvRight );
+      else {
+        *it1 = intvRight;
+        this->erase( it1+1, it2 );
+      }
+    } else
+      this->erase( it1, it2 );
     DBGOUT_MIPD( " ... gives " << (*this) );
   }
-  template <class N> typename
-  SetOfIntervals<N>::SplitResult SetOfIntervals<N>::split(iterator& it, N pos) {
-    MZN_MIPD__assert_hard( pos>=it->left );
-    MZN_MIPD__assert_hard( pos<=it->right );
-    Interval<N> intvOld = *it;
-    this->erase(it);
-    iterator it_01 = this->insert( Interval<N> ( intvOld.left, pos ) );
-    iterator it_02 = this->insert( Interval<N> ( pos, intvOld.right ) );
-    it = this->end();
-    return std::make_pair( it_01, it_02 );
-  }
   template <class N>
   Interval<N> SetOfIntervals<N>::getBounds() const {
     if ( this->empty() )
       return Interval<N>( Interval<N>::infPlus(), Interval<N>::infMinus() );
-    iterator it2 = this->end();
-    --it2;
-    return Interval<N>( this->begin()->left, it2->right );
+    return Interval<N>( this->front().left, this->back().right );
   }
   template <class N>
   bool SetOfIntervals<N>::checkFiniteBounds() {
@@ -1910,6 +1918,9 @@ namespace MiniZinc {
     return true;
   }
   
+  /// Instantiated here so that mipdomains_test can call cutOut() directly
+  template class SetOfIntervals<double>;
+
   bool MIPD::fVerbose = false;
 
   void MIPdomains(Env& env, bool fVerbose) {
@@ -271,6 +271,23 @@ namespace MiniZinc {
       l *= (max(i) - min(i) + 1);
     return l;
   }
+  namespace {
+    /// Add \a x to fingerprint \a fp (using the MurmurHash3 finaliser)
+    inline void fp_add(unsigned long long& fp, unsigned long long x) {
+      unsigned long long h = fp ^ (x + 0x9e3779b97f4a7c15ULL);
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      fp = h;
+    }
+    /// Type component of the fingerprint, equal iff Type::operator== holds
+    inline unsigned long long fp_type(const Type& t) {
+      return static_cast<unsigned int>(t.toInt()) & ~(0xFFFu << 8);
+    }
+  }
+
   void
   ArrayLit::rehash(void) {
     init_hash();
@@ -283,6 +300,56 @@ namespace MiniZinc {
       cmb_hash(h(i));
       cmb_hash(Expression::hash(_v[i]));
     }
+
+    _flag_2 = false;
+  }
+
+  void
+  ArrayLit::computeFingerprint(void) const {
+    // Together with the hash value, the fingerprint lets
+    // Expression::equal_internal reject arrays of integer and Boolean
+    // literals quickly, so it must encode everything that equality looks at
+    // for these elements. A zero fingerprint marks arrays with other
+    // elements. Nested arrays are not included: their elements can be
+    // replaced in place, which would leave the parent's fingerprint stale.
+    bool ground = true;
+    _fp = 0x243f6a8885a308d3ULL;
+    fp_add(_fp, _v.size());
+    fp_add(_fp, _dims.size());
+    for (unsigned int i=0; i<_dims.size(); i++)
+      fp_add(_fp, static_cast<unsigned long long>(static_cast<long long>(_dims[i])));
+    for (unsigned int i=0; ground && i<_v.size(); i++) {
+      const Expression* e = _v[i];
+      if (e==NULL) {
+        ground = false;
+      } else if (e->isUnboxedInt()) {
+        fp_add(_fp, 1);
+        fp_add(_fp, static_cast<unsigned long long>(e->unboxedIntToIntVal().toInt()));
+      } else {
+        fp_add(_fp, fp_type(e->type()));
+        switch (e->eid()) {
+          case E_INTLIT:
+          {
+            IntVal v = e->cast<IntLit>()->v();
+            if (v.isFinite()) {
+              fp_add(_fp, 2);
+              fp_add(_fp, static_cast<unsigned long long>(v.toInt()));
+            } else {
+              ground = false;
+            }
+          }
+            break;
+          case E_BOOLLIT:
+            fp_add(_fp, e->cast<BoolLit>()->v() ? 3 : 4);
+            break;
+          default:
+            ground = false;
+        }
+      }
+    }
+    if (!ground)
+      _fp = 0;
+    const_cast<ArrayLit*>(this)->_flag_2 = true;
   }
 
   void
@@ -972,6 +1039,18 @@ namespace MiniZinc {
             return false;
           }
         }
+        // Different fingerprints prove that the arrays differ; equal ones
+        // may collide, so the elements are still compared
+        if (a0->ground() && a1->ground() && !ArrayLit::sameFingerprint(a0, a1)) {
+#ifdef MZN_VERIFY_FINGERPRINTS
+          bool same = true;
+          for (unsigned int i=0; same && i<a0->v().size(); i++)
+            same = Expression::equal( a0->v()[i], a1->v()[i] );
+          if (same)
+            throw InternalError("array literal fingerprint mismatch");
+#endif
+          return false;
+        }
         for (unsigned int i=0; i<a0->v().size(); i++) {
           if (!Expression::equal( a0->v()[i], a1->v()[i] )) {
             return false;
@@ -1201,6 +1280,7 @@ namespace MiniZinc {
     ids.set_eq = ASTString("set_eq");
     ids.set_in = ASTString("set_in");
     ids.set_card = ASTString("set_card");
+    ids.array_int_element = ASTString("array_int_element");
     
     ids.introduced_var = ASTString("__INTRODUCED");
 
@@ -1410,6 +1490,7 @@ namespace MiniZinc {
     v.push_back(new StringLit(Location(),ids.set_eq));
     v.push_back(new StringLit(Location(),ids.set_in));
     v.push_back(new StringLit(Location(),ids.set_card));
+    v.push_back(new StringLit(Location(),ids.array_int_element));
 
     v.push_back(new StringLit(Location(),ids.assert));
     v.push_back(new StringLit(Location(),ids.trace));
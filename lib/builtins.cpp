@@ -17,6 +17,7 @@
 #include <minizinc/prettyprinter.hh>
 #include <minizinc/flatten_internal.hh>
 #include <minizinc/file_utils.hh>
+#include <minizinc/number_format.hh>
 
 #include <iomanip>
 #include <climits>
@@ -1447,6 +1448,15 @@ namespace MiniZinc {
     }
   }
   
+  /// Pad \a s with spaces to \a width characters: on the left for a positive width,
+  /// on the right for a negative one
+  static std::string padFormatted(const std::string& s, int width) {
+    if (s.size() >= std::abs(width))
+      return s;
+    std::string pad(std::abs(width)-s.size(), ' ');
+    return width < 0 ? s + pad : pad + s;
+  }
+
   std::string b_format(EnvI& env, Call* call) {
     ASTExprVec<Expression> args = call->args();
     int width = 0;
@@ -1469,51 +1479,21 @@ namespace MiniZinc {
     }
     if (e->type() == Type::parint()) {
       long long int i = eval_int(env,e).toInt();
-      std::ostringstream formatted;
-      if (width > 0) {
-        formatted.width(width);
-      } else if (width < 0) {
-        formatted.width(-width);
-        formatted.flags(std::ios::left);
-      }
-      if (prec != -1)
-        formatted.precision(prec);
-      formatted << i;
-      return formatted.str();
+      return padFormatted(NumberFormat::toString(i), width);
     } else if (e->type() == Type::parfloat()) {
-      FloatVal i = eval_float(env,e);
-      std::ostringstream formatted;
-      if (width > 0) {
-        formatted.width(width);
-      } else if (width < 0) {
-        formatted.width(-width);
-        formatted.flags(std::ios::left);
-      }
-      formatted.setf(std::ios::fixed);
-      formatted.precision(std::numeric_limits<double>::digits10+2);
-      if (prec != -1)
-        formatted.precision(prec);
-      formatted << i;
-      return formatted.str();
+      FloatVal f = eval_float(env,e);
+      std::string formatted;
+      if (!f.isFinite())
+        formatted = f.isPlusInfinity() ? "infinity" : "-infinity";
+      else
+        formatted = NumberFormat::fixed(f.toDouble(),
+                                        prec != -1 ? prec : std::numeric_limits<double>::digits10+2);
+      return padFormatted(formatted, width);
     } else {
       std::string s = show(env,e);
       if (prec >= 0 && prec < s.size())
         s = s.substr(0,prec);
-      std::ostringstream oss;
-      if (s.size() < std::abs(width)) {
-        int addLeft = width < 0 ? 0 : (width - s.size());
-        if (addLeft < 0) addLeft = 0;
-        int addRight = width < 0 ? (-width-s.size()) : 0;
-        if (addRight < 0) addRight = 0;
-        for (int i=addLeft; i--;)
-          oss << " ";
-        oss << s;
-        for (int i=addRight; i--;)
-          oss << " ";
-        return oss.str();
-      } else {
-        return s;
-      }
+      return padFormatted(s, width);
     }
   }
   
@@ -1525,18 +1505,12 @@ namespace MiniZinc {
     std::ostringstream oss;
     if (IntLit* iv = e->dyn_cast<IntLit>()) {
       int justify = static_cast<int>(eval_int(env,args[0]).toInt());
-      std::ostringstream oss_length;
-      oss_length << iv->v();
-      int iv_length = static_cast<int>(oss_length.str().size());
-      int addLeft = justify < 0 ? 0 : (justify - iv_length);
-      if (addLeft < 0) addLeft = 0;
-      int addRight = justify < 0 ? (-justify-iv_length) : 0;
-      if (addRight < 0) addRight = 0;
-      for (int i=addLeft; i--;)
-        oss << " ";
-      oss << iv->v();
-      for (int i=addRight; i--;)
-        oss << " ";
+      std::string formatted;
+      if (!iv->v().isFinite())
+        formatted = iv->v().isPlusInfinity() ? "infinity" : "-infinity";
+      else
+        formatted = NumberFormat::toString(iv->v().toInt());
+      oss << padFormatted(formatted, justify);
     } else {
       Printer p(oss,0,false);
       p.print(e);
@@ -1555,18 +1529,12 @@ namespace MiniZinc {
       int prec = static_cast<int>(eval_int(env,args[1]).toInt());
       if (prec < 0)
         throw EvalError(env, args[1]->loc(), "number of digits in show_float cannot be negative");
-      std::ostringstream oss_length;
-      oss_length << std::setprecision(prec) << std::fixed << fv->v();
-      int fv_length = static_cast<int>(oss_length.str().size());
-      int addLeft = justify < 0 ? 0 : (justify - fv_length);
-      if (addLeft < 0) addLeft = 0;
-      int addRight = justify < 0 ? (-justify-fv_length) : 0;
-      if (addRight < 0) addRight = 0;
-      for (int i=addLeft; i--;)
-        oss << " ";
-      oss << std::setprecision(prec) << std::fixed << fv->v();
-      for (int i=addRight; i--;)
-        oss << " ";
+      std::string formatted;
+      if (!fv->v().isFinite())
+        formatted = fv->v().isPlusInfinity() ? "infinity" : "-infinity";
+      else
+        formatted = NumberFormat::fixed(fv->v().toDouble(), prec);
+      oss << padFormatted(formatted, justify);
     } else {
       Printer p(oss,0,false);
       p.print(e);
@@ -17,6 +17,8 @@
 #include <minizinc/optimize.hh>
 #include <minizinc/astiterator.hh>
 #include <minizinc/output.hh>
+#include <minizinc/phase_profile.hh>
+#include <minizinc/flatten_profile.hh>
 
 #include <minizinc/stl_map_set.hh>
 
@@ -169,7 +171,7 @@ namespace MiniZinc {
 
 #define MZN_FILL_REIFY_MAP(T,ID) reifyMap.insert(std::pair<ASTString,ASTString>(constants().ids.T.ID,constants().ids.T ## reif.ID));
 
-  EnvI::EnvI(Model* orig0) : orig(orig0), output(new Model), ignorePartial(false), maxCallStack(0), collect_vardecls(false), in_redundant_constraint(0), in_maybe_partial(0), _flat(new Model), _failed(false), ids(0) {
+  EnvI::EnvI(Model* orig0) : orig(orig0), output(new Model), ignorePartial(false), maxCallStack(0), collect_vardecls(false), in_redundant_constraint(0), in_maybe_partial(0), profiler(NULL), _flat(new Model), _failed(false), ids(0) {
     MZN_FILL_REIFY_MAP(int_,lin_eq);
     MZN_FILL_REIFY_MAP(int_,lin_le);
     MZN_FILL_REIFY_MAP(int_,lin_ne);
@@ -229,6 +231,8 @@ namespace MiniZinc {
       } else {
         return map.end();
       }
+      if (profiler)
+        profiler->cseHit();
     }
     return it;
   }
@@ -255,6 +259,8 @@ namespace MiniZinc {
     if (_failed)
       return;
     _flat->addItem(i);
+    if (profiler)
+      profiler->addedItem(i);
     Expression* toAnnotate = NULL;
     Expression* toAdd = NULL;
     switch (i->iid()) {
@@ -479,11 +485,15 @@ namespace MiniZinc {
       env.in_maybe_partial++;
     env.callStack.push_back(e);
     env.maxCallStack = std::max(env.maxCallStack, static_cast<unsigned int>(env.callStack.size()));
+    if (env.profiler)
+      env.profiler->enter(e);
   }
   CallStackItem::CallStackItem(EnvI& env0, Id* ident, IntVal i) : env(env0) {
     Expression* ee = ident->tag();
     env.callStack.push_back(ee);
     env.maxCallStack = std::max(env.maxCallStack, static_cast<unsigned int>(env.callStack.size()));
+    if (env.profiler)
+      env.profiler->enterGenerator();
   }
   CallStackItem::~CallStackItem(void) {
     Expression* e = env.callStack.back()->untag();
@@ -494,6 +504,8 @@ namespace MiniZinc {
     if (e->ann().contains(constants().ann.maybe_partial))
       env.in_maybe_partial--;
     env.callStack.pop_back();
+    if (env.profiler)
+      env.profiler->leave();
   }
   
   class CallArgItem {
@@ -5290,6 +5302,10 @@ namespace MiniZinc {
   
   void flatten(Env& e, FlatteningOptions opt) {
     
+    if (opt.profiler) {
+      e.envi().profiler = opt.profiler;
+      opt.profiler->start();
+    }
     try {
 
       EnvI& env = e.envi();
@@ -5434,10 +5450,14 @@ namespace MiniZinc {
       std::vector<VarDecl*> deletedVarDecls;
 
       // Create output model
-      if (opt.keepOutputInFzn) {
-        copyOutput(env);
-      } else {
-        createOutput(env, deletedVarDecls, opt.outputMode);
+      {
+        PhaseProfileScope ps(opt.profile, "output generation");
+        if (opt.keepOutputInFzn) {
+          copyOutput(env);
+        } else {
+          createOutput(env, deletedVarDecls, opt.outputMode);
+        }
+        ps.stop(env.output);
       }
       
       // Flatten remaining redefinitions
@@ -5815,6 +5835,7 @@ namespace MiniZinc {
       }
       
       // Add redefinitions for output variables that may have been redefined since createOutput
+      PhaseProfileScope outputPhase(opt.profile, "output generation");
       for (unsigned int i=0; i<env.output->size(); i++) {
         if (VarDeclI* vdi = (*env.output)[i]->dyn_cast<VarDeclI>()) {
           IdMap<KeepAlive>::iterator it;
@@ -5856,6 +5877,7 @@ namespace MiniZinc {
           }
         }
       }
+      outputPhase.stop(env.output);
 
       for (unsigned int i=0; i<m.size(); i++) {
         if (ConstraintI* ci = m[i]->dyn_cast<ConstraintI>()) {
@@ -5905,6 +5927,10 @@ namespace MiniZinc {
     } catch (ModelInconsistent& e) {
       
     }
+    if (opt.profiler) {
+      opt.profiler->stop();
+      e.envi().profiler = NULL;
+    }
   }
   
   void clearInternalAnnotations(Expression* e) {
@@ -6336,19 +6362,7 @@ namespace MiniZinc {
     m->compact();
     e.envi().output->compact();
 
-    for (IdMap<VarOccurrences::Items>::iterator it = env.vo._m.begin();
-         it != env.vo._m.end(); ++it) {
-      std::vector<Item*> toRemove;
-      for (VarOccurrences::Items::iterator iit = it->second.begin();
-           iit != it->second.end(); ++iit) {
-        if ((*iit)->removed()) {
-          toRemove.push_back(*iit);
-        }
-      }
-      for (unsigned int i=0; i<toRemove.size(); i++) {
-        it->second.erase(toRemove[i]);
-      }
-    }
+    env.vo.eraseRemoved();
 
     class Cmp {
     public:
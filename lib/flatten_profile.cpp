@@ -0,0 +1,293 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <minizinc/flatten_profile.hh>
+#include <minizinc/number_format.hh>
+
+namespace MiniZinc {
+
+  namespace {
+    /// Frame names must not contain the separators of the folded format
+    std::string foldedName(const std::string& s) {
+      std::string r = s;
+      for (unsigned int i=0; i<r.size(); i++)
+        if (r[i]==';' || r[i]==' ' || r[i]=='\n')
+          r[i] = '_';
+      return r;
+    }
+    std::string baseName(const std::string& f) {
+      size_t pos = f.find_last_of("/\\");
+      return pos==std::string::npos ? f : f.substr(pos+1);
+    }
+  }
+
+  FlatteningProfiler::FlatteningProfiler(void)
+    : _startMs(0.0), _totalMs(0.0), _vars(0), _constraints(0), _cseHits(0), _nFrames(0) {
+    for (unsigned int i=0; i<64; i++) {
+      _fileCache[i].s = NULL;
+      _fileCache[i].idx = 0;
+    }
+    _files.push_back("<unknown>");
+    _nodes.push_back(Node(NONE, ""));
+  }
+
+  void
+  FlatteningProfiler::start(void) {
+    _startMs = _timer.ms();
+  }
+
+  void
+  FlatteningProfiler::stop(void) {
+    _totalMs += _timer.ms()-_startMs;
+  }
+
+  FlatteningProfiler::Cost
+  FlatteningProfiler::now(void) const {
+    Cost c;
+    c.ms = _timer.ms();
+    c.vars = _vars;
+    c.constraints = _constraints;
+    c.cseHits = _cseHits;
+    return c;
+  }
+
+  unsigned int
+  FlatteningProfiler::file(const ASTString& f) {
+    if (f.size()==0)
+      return 0;
+    const char* s = f.c_str();
+    FileCache& fc = _fileCache[(reinterpret_cast<uintptr_t>(s) >> 4) & 63];
+    if (fc.s==s && _files[fc.idx].size()==f.size()
+        && std::strncmp(_files[fc.idx].c_str(), s, f.size())==0)
+      return fc.idx;
+    std::string name(s, f.size());
+    UNORDERED_NAMESPACE::unordered_map<std::string,unsigned int>::iterator it = _fileIdx.find(name);
+    unsigned int idx;
+    if (it==_fileIdx.end()) {
+      idx = static_cast<unsigned int>(_files.size());
+      _files.push_back(name);
+      _fileIdx.insert(std::make_pair(name, idx));
+    } else {
+      idx = it->second;
+    }
+    fc.s = s;
+    fc.idx = idx;
+    return idx;
+  }
+
+  unsigned int
+  FlatteningProfiler::location(const Location& loc) {
+    unsigned int f = file(loc.filename);
+    uint64_t key = (static_cast<uint64_t>(f) << 40)
+      | (static_cast<uint64_t>(loc.first_line & 0xFFFFFF) << 16)
+      | static_cast<uint64_t>(loc.first_column & 0xFFFF);
+    UNORDERED_NAMESPACE::unordered_map<uint64_t,unsigned int>::iterator it = _locIdx.find(key);
+    if (it != _locIdx.end())
+      return it->second;
+    unsigned int idx = static_cast<unsigned int>(_locations.size());
+    _locations.push_back(Entry());
+    std::ostringstream oss;
+    oss << _files[f] << ":" << loc.first_line << "." << loc.first_column;
+    _locations.back().name = oss.str();
+    _locIdx.insert(std::make_pair(key, idx));
+    return idx;
+  }
+
+  unsigned int
+  FlatteningProfiler::function(const FunctionI* fi) {
+    UNORDERED_NAMESPACE::unordered_map<const FunctionI*,unsigned int>::iterator it = _fnIdx.find(fi);
+    if (it != _fnIdx.end())
+      return it->second;
+    unsigned int idx = static_cast<unsigned int>(_functions.size());
+    _functions.push_back(Entry());
+    _functions.back().name = fi->id().str();
+    _fnIdx.insert(std::make_pair(fi, idx));
+    return idx;
+  }
+
+  unsigned int
+  FlatteningProfiler::child(unsigned int node, uint64_t key, const std::string& name) {
+    UNORDERED_NAMESPACE::unordered_map<uint64_t,unsigned int>::iterator it = _nodes[node].children.find(key);
+    if (it != _nodes[node].children.end())
+      return it->second;
+    unsigned int n = static_cast<unsigned int>(_nodes.size());
+    _nodes[node].children.insert(std::make_pair(key, n));
+    _nodes.push_back(Node(node, foldedName(name)));
+    return n;
+  }
+
+  void
+  FlatteningProfiler::enter(const Expression* e) {
+    Frame f;
+    f.fn = NONE;
+    f.loc = NONE;
+    f.node = _stack.empty() ? 0 : _stack.back().node;
+    const Call* c = e->dyn_cast<Call>();
+    if (c && c->decl()) {
+      f.fn = function(c->decl());
+      f.loc = location(c->loc());
+    } else if (_nFrames==0) {
+      f.loc = location(e->loc());
+    }
+    if (f.loc != NONE) {
+      if (_nFrames==0) {
+        // Stacks start with the location of the top-level item
+        std::string name = baseName(_files[file(e->loc().filename)])+":"
+          +NumberFormat::toString(static_cast<long long int>(e->loc().first_line));
+        f.node = child(f.node, f.loc, name);
+      }
+      if (f.fn != NONE) {
+        f.node = child(f.node, (static_cast<uint64_t>(1) << 32) | f.fn, _functions[f.fn].name);
+        _functions[f.fn].calls++;
+        _functions[f.fn].active++;
+      }
+      _locations[f.loc].calls++;
+      _locations[f.loc].active++;
+      f.startCost = now();
+      f.start = f.startCost.ms;
+      _nFrames++;
+    }
+    _stack.push_back(f);
+  }
+
+  void
+  FlatteningProfiler::enterGenerator(void) {
+    Frame f;
+    f.fn = NONE;
+    f.loc = NONE;
+    f.node = _stack.empty() ? 0 : _stack.back().node;
+    _stack.push_back(f);
+  }
+
+  void
+  FlatteningProfiler::leave(void) {
+    assert(!_stack.empty());
+    Frame f = _stack.back();
+    _stack.pop_back();
+    if (f.loc==NONE)
+      return;
+    _nFrames--;
+    Cost cur = now();
+    Cost incl;
+    incl.ms = cur.ms-f.start;
+    incl.vars = cur.vars-f.startCost.vars;
+    incl.constraints = cur.constraints-f.startCost.constraints;
+    incl.cseHits = cur.cseHits-f.startCost.cseHits;
+    Cost excl;
+    excl.ms = incl.ms-f.children.ms;
+    excl.vars = incl.vars-f.children.vars;
+    excl.constraints = incl.constraints-f.children.constraints;
+    excl.cseHits = incl.cseHits-f.children.cseHits;
+    Entry* entries[2] = { f.fn==NONE ? NULL : &_functions[f.fn], &_locations[f.loc] };
+    for (unsigned int i=0; i<2; i++) {
+      Entry* en = entries[i];
+      if (en==NULL)
+        continue;
+      en->excl.ms += excl.ms;
+      en->excl.vars += excl.vars;
+      en->excl.constraints += excl.constraints;
+      en->excl.cseHits += excl.cseHits;
+      if (--en->active == 0) {
+        en->incl.ms += incl.ms;
+        en->incl.vars += incl.vars;
+        en->incl.constraints += incl.constraints;
+        en->incl.cseHits += incl.cseHits;
+      }
+    }
+    _nodes[f.node].ms += excl.ms;
+    for (unsigned int i=static_cast<unsigned int>(_stack.size()); i--;) {
+      if (_stack[i].loc != NONE) {
+        Cost& ch = _stack[i].children;
+        ch.ms += incl.ms;
+        ch.vars += incl.vars;
+        ch.constraints += incl.constraints;
+        ch.cseHits += incl.cseHits;
+        break;
+      }
+    }
+  }
+
+  void
+  FlatteningProfiler::printEntries(std::ostream& os, const std::string& title,
+                                   const std::vector<Entry>& entries) const {
+    std::vector<unsigned int> order(entries.size());
+    for (unsigned int i=0; i<order.size(); i++)
+      order[i] = i;
+    struct ByTime {
+      const std::vector<Entry>& e;
+      ByTime(const std::vector<Entry>& e0) : e(e0) {}
+      bool operator ()(unsigned int a, unsigned int b) const {
+        return e[a].incl.ms > e[b].incl.ms || (e[a].incl.ms == e[b].incl.ms && a < b);
+      }
+    };
+    std::sort(order.begin(), order.end(), ByTime(entries));
+    os << title << " (" << entries.size() << ")\n"
+       << "    incl ms     excl ms      calls  vars incl  vars excl  cons incl  cons excl   cse incl   cse excl  name\n";
+    for (unsigned int i=0; i<order.size(); i++) {
+      const Entry& e = entries[order[i]];
+      os << std::setw(11) << NumberFormat::fixed(e.incl.ms, 1)
+         << " " << std::setw(11) << NumberFormat::fixed(e.excl.ms, 1)
+         << " " << std::setw(10) << e.calls
+         << " " << std::setw(10) << e.incl.vars
+         << " " << std::setw(10) << e.excl.vars
+         << " " << std::setw(10) << e.incl.constraints
+         << " " << std::setw(10) << e.excl.constraints
+         << " " << std::setw(10) << e.incl.cseHits
+         << " " << std::setw(10) << e.excl.cseHits
+         << "  " << e.name << "\n";
+    }
+    os << "\n";
+  }
+
+  void
+  FlatteningProfiler::printReport(std::ostream& os) const {
+    double itemsMs = 0.0;
+    for (UNORDERED_NAMESPACE::unordered_map<uint64_t,unsigned int>::const_iterator it = _nodes[0].children.begin();
+         it != _nodes[0].children.end(); ++it) {
+      // Inclusive time of a top-level frame is the sum over its subtree
+      std::vector<unsigned int> todo(1, it->second);
+      while (!todo.empty()) {
+        const Node& n = _nodes[todo.back()];
+        todo.pop_back();
+        itemsMs += n.ms;
+        for (UNORDERED_NAMESPACE::unordered_map<uint64_t,unsigned int>::const_iterator c = n.children.begin();
+             c != n.children.end(); ++c)
+          todo.push_back(c->second);
+      }
+    }
+    os << "Flattening profile\n"
+       << "  total " << NumberFormat::fixed(_totalMs, 1) << " ms, "
+       << NumberFormat::fixed(std::max(0.0, _totalMs-itemsMs), 1) << " ms outside of profiled expressions\n"
+       << "  " << _vars << " variables, " << _constraints << " constraints, "
+       << _cseHits << " CSE hits\n\n";
+    printEntries(os, "Functions", _functions);
+    printEntries(os, "Locations", _locations);
+  }
+
+  void
+  FlatteningProfiler::printFolded(std::ostream& os) const {
+    std::vector<std::string> path(_nodes.size());
+    for (unsigned int i=1; i<_nodes.size(); i++) {
+      // Parents are created before their children
+      const Node& n = _nodes[i];
+      path[i] = n.parent==0 ? n.name : path[n.parent]+";"+n.name;
+      long long int us = static_cast<long long int>(n.ms*1000.0 + 0.5);
+      if (us > 0)
+        os << path[i] << " " << us << "\n";
+    }
+  }
+
+}
@@ -50,6 +50,9 @@ void Flattener::printHelp(ostream& os)
   << "  -e, --model-check-only\n    Check the model (without requiring data) for errors, but do not\n    convert to FlatZinc." << std::endl
   << "  --model-interface-only\n    Only extract parameters and output variables." << std::endl
   << "  --no-optimize\n    Do not optimize the FlatZinc" << std::endl
+  << "  --no-propagate-bounds\n    Do not tighten bounds from linear and element constraints" << std::endl
+  << "  --propagate-bounds-limit <n>\n    Maximum number of propagation steps when tightening bounds\n    (default: 10 per constraint)" << std::endl
+  << "  --propagate-bounds-time <ms>\n    Time limit for tightening bounds (default: 5000, 0 for none)" << std::endl
   // \n    Currently does nothing (only available for compatibility with 1.6)
   << "  -d <file>, --data <file>\n    File named <file> contains data used by the model." << std::endl
   << "  -D <data>, --cmdline-data <data>\n    Include the given data assignment in the model." << std::endl
@@ -70,6 +73,10 @@ void Flattener::printHelp(ostream& os)
   << "  -O, --ozn, --output-ozn-to-file <file>\n    Filename for model output specification (-O- for none)" << std::endl
   << "  --output-to-stdout, --output-fzn-to-stdout\n    Print generated FlatZinc to standard output" << std::endl
   << "  --output-ozn-to-stdout\n    Print model output specification to standard output" << std::endl
+  << "  --fzb <file>, --output-fzb-to-file <file>\n    Also write the flat model and the output specification in binary\n    FlatZinc, which solvers and solns2out accept instead of .fzn/.ozn" << std::endl
+  << "  --profile-json <file>\n    Write wall and CPU time, garbage collections, heap size and item counts\n    of each compilation phase to <file> as JSON" << std::endl
+  << "  --profile-flattening <file>\n    Write the flattening time, generated variables and constraints and CSE\n    hits of each function and source location to <file>" << std::endl
+  << "  --profile-folded <file>\n    Write the flattening time of each call stack to <file> in the folded\n    format of flame graph tools" << std::endl
   << "  --output-mode <item|dzn|json>\n    Create output according to output item (default), or output compatible\n    with dzn or json format" << std::endl
   << "  -Werror\n    Turn warnings into errors" << std::endl
   ;
@@ -98,6 +105,10 @@ bool Flattener::processOption(int& i, const int argc, const char** argv)
     flag_newfzn = true;
   } else if ( cop.getOption( "--no-optimize --no-optimise") ) {
     flag_optimize = false;
+  } else if ( cop.getOption( "--no-propagate-bounds") ) {
+    optopts.propagateBounds = false;
+  } else if ( cop.getOption( "--propagate-bounds-limit", &optopts.boundsPropagationLimit) ) {
+  } else if ( cop.getOption( "--propagate-bounds-time", &optopts.boundsPropagationTime) ) {
   } else if ( cop.getOption( "--no-output-ozn -O-") ) {
     flag_no_output_ozn = true;
   } else if ( cop.getOption( "--output-base", &flag_output_base ) ) {
@@ -106,6 +117,10 @@ bool Flattener::processOption(int& i, const int argc, const char** argv)
       "-o --fzn --output-to-file --output-fzn-to-file"
       : "--fzn --output-fzn-to-file", &flag_output_fzn) ) {
   } else if ( cop.getOption( "-O --ozn --output-ozn-to-file", &flag_output_ozn) ) {
+  } else if ( cop.getOption( "--fzb --output-fzb-to-file", &flag_output_fzb) ) {
+  } else if ( cop.getOption( "--profile-json", &flag_profile_json) ) {
+  } else if ( cop.getOption( "--profile-flattening", &flag_profile_flattening) ) {
+  } else if ( cop.getOption( "--profile-folded", &flag_profile_folded) ) {
   } else if ( cop.getOption( "--output-to-stdout --output-fzn-to-stdout" ) ) {
     flag_output_fzn_stdout = true;
   } else if ( cop.getOption( "--output-ozn-to-stdout" ) ) {
@@ -156,9 +171,10 @@ bool Flattener::processOption(int& i, const int argc, const char** argv)
       goto error;
     }
     std::string extension = input_file.substr(last_dot,string::npos);
-    if (extension == ".mzn" || extension ==  ".mzc" || extension == ".fzn") {
-      if ( extension == ".fzn" ) {
-        is_flatzinc = true;
+    if (extension == ".mzn" || extension ==  ".mzc" || extension == ".fzn" || extension == ".fzb") {
+      if ( extension == ".fzn" || extension == ".fzb" ) {
+        is_flatzinc = extension == ".fzn";
+        is_fzb = extension == ".fzb";
         if ( fOutputByDefault )        // mzn2fzn mode
           goto error;
       }
@@ -197,6 +213,10 @@ void Flattener::flatten()
 {
   starttime01 = std::clock();
   lasttime = starttime01;
+  if (flag_profile || flag_profile_json != "")
+    profile.reset(new PhaseProfile());
+  if (flag_profile_flattening != "" || flag_profile_folded != "")
+    profiler.reset(new FlatteningProfiler());
   
   if (flag_verbose)
     printVersion(cerr);
@@ -278,12 +298,15 @@ void Flattener::flatten()
     }
   }
 
-  {
+  if (is_fzb) {
+    loadFzb();
+  } else {
     std::stringstream errstream;
     try {
       Model* m;
       pEnv.reset(new Env());
       Env& env = *getEnv();
+      PhaseProfileScope parsePhase(profile.get(), "parse");
       if (flag_stdinInput) {
         if (flag_verbose)
           std::cerr << "Parsing standard input ..." << endl;
@@ -302,6 +325,7 @@ void Flattener::flatten()
         }
         m = parse(env, filenames, datafiles, includePaths, flag_ignoreStdlib, false, flag_verbose, errstream);
       }
+      parsePhase.stop(m);
       if (m) {
         env.model(m);
 //         pModel.reset(m);   // seems to be unnec
@@ -310,6 +334,7 @@ void Flattener::flatten()
             std::cerr << " done parsing (" << stoptime(lasttime) << ")" << std::endl;
           if (flag_verbose)
             std::cerr << "Typechecking ...";
+          PhaseProfileScope typecheckPhase(profile.get(), "typecheck");
           vector<TypeError> typeErrors;
           MiniZinc::typecheck(env, m, typeErrors, flag_model_check_only || flag_model_interface_only);
           if (typeErrors.size() > 0) {
@@ -322,6 +347,7 @@ void Flattener::flatten()
             exit(EXIT_FAILURE);
           }
           MiniZinc::registerBuiltins(env, m);
+          typecheckPhase.stop(m);
           if (flag_verbose)
             std::cerr << " done (" << stoptime(lasttime) << ")" << std::endl;
 
@@ -338,9 +364,12 @@ void Flattener::flatten()
               if (flag_verbose)
                 std::cerr << "Flattening ...";
 
+              PhaseProfileScope flattenPhase(profile.get(), "flatten");
               try {
                 fopts.onlyRangeDomains = flag_only_range_domains;
                 fopts.outputMode = flag_output_mode;
+                fopts.profile = profile.get();
+                fopts.profiler = profiler.get();
                 ::flatten(env,fopts);
               } catch (LocationException& e) {
                 if (flag_verbose)
@@ -357,6 +386,7 @@ void Flattener::flatten()
                 exit(EXIT_FAILURE);
               }
               env.clearWarnings();
+              flattenPhase.stop(env.flat());
               //            Model* flat = env.flat();
               if (flag_verbose)
                 std::cerr << " done (" << stoptime(lasttime)
@@ -365,7 +395,9 @@ void Flattener::flatten()
               if ( ! flag_noMIPdomains ) {
                 if (flag_verbose)
                   std::cerr << "MIP domains ...";
+                PhaseProfileScope ps(profile.get(), "MIPdomains");
                 MIPdomains(env, flag_statistics);
+                ps.stop(env.flat());
                 if (flag_verbose)
                   std::cerr << " done (" << stoptime(lasttime) << ")" << std::endl;
               }
@@ -373,7 +405,9 @@ void Flattener::flatten()
               if (flag_optimize) {
                 if (flag_verbose)
                   std::cerr << "Optimizing ...";
-                optimize(env);
+                PhaseProfileScope ps(profile.get(), "optimize");
+                optimize(env, optopts, &optstats);
+                ps.stop(env.flat());
                 for (unsigned int i=0; i<env.warnings().size(); i++) {
                   std::cerr << (flag_werror ? "\n  ERROR: " : "\n  WARNING: ") << env.warnings()[i];
                 }
@@ -387,7 +421,9 @@ void Flattener::flatten()
               if (!flag_newfzn) {
                 if (flag_verbose)
                   std::cerr << "Converting to old FlatZinc ...";
+                PhaseProfileScope ps(profile.get(), "oldflatzinc");
                 oldflatzinc(env);
+                ps.stop(env.flat());
                 if (flag_verbose)
                   std::cerr << " done (" << stoptime(lasttime) << ")" << std::endl;
               } else {
@@ -417,6 +453,16 @@ void Flattener::flatten()
               if (!ho)
                 std::cerr << "none";
               std::cerr << "\n";
+              if (flag_optimize && optopts.propagateBounds) {
+                std::cerr << "Bounds propagation: " << optstats.n_tightened_domains << " domains tightened, "
+                  << optstats.n_removed_ct << " constraints removed, "
+                  << optstats.n_propagations << " propagations";
+                if (optstats.limit_reached)
+                  std::cerr << " (limit reached)";
+                std::cerr << "\n";
+              }
+              std::cerr << "Function resolution: " << env.model()->fnCacheHits() << " cached, "
+                << env.model()->fnCacheMisses() << " searched\n";
               /// Objective+bounds / SAT
               SolveI* solveItem = env.flat()->solveItem();
               if (solveItem->st() != SolveI::SolveType::ST_SAT) {
@@ -432,10 +478,11 @@ void Flattener::flatten()
               }
             }
 
+            PhaseProfileScope writePhase(profile.get(), "write");
             if (flag_output_fzn_stdout) {
               if (flag_verbose)
                 std::cerr << "Printing FlatZinc to stdout ..." << std::endl;
-              Printer p(std::cout,0);
+              FznPrinter p(std::cout);
               p.print(env.flat());
               if (flag_verbose)
                 std::cerr << " done (" << stoptime(lasttime) << ")" << std::endl;
@@ -446,13 +493,33 @@ void Flattener::flatten()
               std::ofstream os;
               os.open(flag_output_fzn.c_str(), ios::out);
               checkIOStatus (os.good(), " I/O error: cannot open fzn output file. ");
-              Printer p(os,0);
-              p.print(env.flat());
+              {
+                FznPrinter p(os);
+                p.print(env.flat());
+              }
               checkIOStatus (os.good(), " I/O error: cannot write fzn output file. ");
               os.close();
               if (flag_verbose)
                 std::cerr << " done (" << stoptime(lasttime) << ")" << std::endl;
             }
+            if (flag_output_fzb != "") {
+              if (flag_verbose)
+                std::cerr << "Writing binary FlatZinc to '"
+                << flag_output_fzb << "' ..." << std::flush;
+              std::ofstream os;
+              os.open(flag_output_fzb.c_str(), ios::out | ios::binary);
+              checkIOStatus (os.good(), " I/O error: cannot open fzb output file. ");
+              {
+                FznBinaryWriter w(os);
+                w.add(env.flat());
+                w.output(env.output());
+                w.finish();
+              }
+              checkIOStatus (os.good(), " I/O error: cannot write fzb output file. ");
+              os.close();
+              if (flag_verbose)
+                std::cerr << " done (" << stoptime(lasttime) << ")" << std::endl;
+            }
             if (!flag_no_output_ozn) {
               if (flag_output_ozn_stdout) {
                 if (flag_verbose)
@@ -476,6 +543,7 @@ void Flattener::flatten()
                   std::cerr << " done (" << stoptime(lasttime) << ")" << std::endl;
               }
             }
+            writePhase.stop();
             /// To cout:
             //             std::cout << "\n\n\n   -------------------  DUMPING env  --------------------------------" << std::endl;
             //             env.envi().dump();
@@ -510,6 +578,27 @@ void Flattener::flatten()
   if (getEnv()->envi().failed()) {
     status = SolverInstance::UNSAT;
   }
+
+  if (profile.get())
+    profile->stopAll();
+  if (profile.get() && flag_profile_json != "") {
+    std::ofstream os(flag_profile_json.c_str(), ios::out);
+    checkIOStatus (os.good(), " I/O error: cannot open profile output file. ");
+    profile->printJSON(os);
+    checkIOStatus (os.good(), " I/O error: cannot write profile output file. ");
+  }
+  if (profiler.get() && flag_profile_flattening != "") {
+    std::ofstream os(flag_profile_flattening.c_str(), ios::out);
+    checkIOStatus (os.good(), " I/O error: cannot open flattening profile file. ");
+    profiler->printReport(os);
+    checkIOStatus (os.good(), " I/O error: cannot write flattening profile file. ");
+  }
+  if (profiler.get() && flag_profile_folded != "") {
+    std::ofstream os(flag_profile_folded.c_str(), ios::out);
+    checkIOStatus (os.good(), " I/O error: cannot open folded profile file. ");
+    profiler->printFolded(os);
+    checkIOStatus (os.good(), " I/O error: cannot write folded profile file. ");
+  }
   
 //   if (flag_verbose)
   if (flag_verbose) {
@@ -526,6 +615,57 @@ void Flattener::flatten()
   }
 }
 
+void Flattener::loadFzb()
+{
+  try {
+    pEnv.reset(new Env());
+    Env& env = *getEnv();
+    if (flag_verbose)
+      std::cerr << "Loading binary FlatZinc '" << filenames[0] << "' ..." << std::flush;
+    PhaseProfileScope loadPhase(profile.get(), "load");
+    FznBinaryFile fzb(filenames[0]);
+    // The output model is stored as text and typechecked against the library
+    std::stringstream errstream;
+    std::vector<SyntaxError> se;
+    Model* m = parseFromString(fzb.output(), filenames[0], includePaths, flag_ignoreStdlib,
+                               false, false, errstream, se);
+    if (m == NULL) {
+      if (flag_verbose)
+        std::cerr << std::endl;
+      std::copy(istreambuf_iterator<char>(errstream),istreambuf_iterator<char>(),ostreambuf_iterator<char>(std::cerr));
+      exit(EXIT_FAILURE);
+    }
+    env.model(m);
+    vector<TypeError> typeErrors;
+    // Output variables are assigned from the solutions
+    MiniZinc::typecheck(env, m, typeErrors, true);
+    if (typeErrors.size() > 0) {
+      for (unsigned int i=0; i<typeErrors.size(); i++) {
+        std::cerr << typeErrors[i].loc() << ":" << std::endl;
+        std::cerr << typeErrors[i].what() << ": " << typeErrors[i].msg() << std::endl;
+      }
+      exit(EXIT_FAILURE);
+    }
+    MiniZinc::registerBuiltins(env, m);
+    env.envi().swap_output();
+    loadFznBinary(env, fzb);
+    loadPhase.stop(env.flat());
+    if (flag_verbose)
+      std::cerr << " done (" << stoptime(lasttime) << ")" << std::endl;
+  } catch (LocationException& e) {
+    if (flag_verbose)
+      std::cerr << std::endl;
+    std::cerr << e.loc() << ":" << std::endl;
+    std::cerr << e.what() << ": " << e.msg() << std::endl;
+    exit(EXIT_FAILURE);
+  } catch (Exception& e) {
+    if (flag_verbose)
+      std::cerr << std::endl;
+    std::cerr << e.what() << ": " << e.msg() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
 void Flattener::printStatistics(ostream&)
 {
 }
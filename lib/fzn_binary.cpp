@@ -0,0 +1,756 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <minizinc/fzn_binary.hh>
+#include <minizinc/hash.hh>
+#include <minizinc/number_format.hh>
+#include <minizinc/prettyprinter.hh>
+
+namespace MiniZinc {
+
+  using namespace FznBinary;
+
+  namespace {
+    const char MAGIC[8] = { 'M', 'Z', 'N', 'F', 'Z', 'B', '\n', '\0' };
+    const uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+    Node mkNode(NodeKind k) {
+      Node n;
+      std::memset(&n, 0, sizeof(n));
+      n.kind = static_cast<uint8_t>(k);
+      return n;
+    }
+
+    /// Name of \a id as printed in FlatZinc
+    std::string idName(const Id* id) {
+      if (id->idn() == -1)
+        return id->v().str();
+      std::string s("X_INTRODUCED_");
+      NumberFormat::append(s, id->idn());
+      s += '_';
+      return s;
+    }
+
+    std::string exprString(const Expression* e) {
+      std::ostringstream oss;
+      oss << *e;
+      return oss.str();
+    }
+  }
+
+  FznBinaryWriter::FznBinaryWriter(std::ostream& os)
+    : _os(os), _nNodes(0), _nDecls(0), _fSolve(false), _fFinished(false) {
+    _buf.reserve(1<<16);
+    Header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.byteOrder = BYTE_ORDER_MARK;
+    _buf.append(reinterpret_cast<const char*>(&h), sizeof(h));
+    std::memset(&_solve, 0, sizeof(_solve));
+    _solve.st = SolveI::ST_SAT;
+    _solve.objective = NONE;
+    _solve.ann = NONE;
+  }
+
+  FznBinaryWriter::~FznBinaryWriter(void) {
+    flush();
+  }
+
+  void
+  FznBinaryWriter::flush(void) {
+    if (!_buf.empty()) {
+      _os.write(_buf.data(), _buf.size());
+      _buf.clear();
+    }
+  }
+
+  uint32_t
+  FznBinaryWriter::str(const std::string& s) {
+    UNORDERED_NAMESPACE::unordered_map<std::string,uint32_t>::iterator it = _strIdx.find(s);
+    if (it != _strIdx.end())
+      return it->second;
+    uint32_t i = static_cast<uint32_t>(_strOffsets.size());
+    _strOffsets.push_back(_strData.size());
+    _strData.append(s.c_str(), s.size()+1);
+    _strIdx.insert(std::make_pair(s, i));
+    return i;
+  }
+
+  uint32_t
+  FznBinaryWriter::var(const VarDecl* vd) {
+    UNORDERED_NAMESPACE::unordered_map<const VarDecl*,uint32_t>::iterator it = _varIdx.find(vd);
+    if (it != _varIdx.end())
+      return it->second;
+    Var v;
+    std::memset(&v, 0, sizeof(v));
+    v.name = str(idName(vd->id()));
+    v.type = vd->type().toInt();
+    v.domain = v.rhs = v.ann = v.index = NONE;
+    uint32_t i = static_cast<uint32_t>(_vars.size());
+    _vars.push_back(v);
+    _declared.push_back(false);
+    _varIdx.insert(std::make_pair(vd, i));
+    return i;
+  }
+
+  uint32_t
+  FznBinaryWriter::emit(const Node& n) {
+    if (_nNodes == NONE)
+      throw FznBinaryError("too many expression nodes");
+    _buf.append(reinterpret_cast<const char*>(&n), sizeof(n));
+    if (_buf.size() >= (1<<16))
+      flush();
+    return _nNodes++;
+  }
+
+  Node
+  FznBinaryWriter::encodeInt(const IntVal& i) {
+    Node n = mkNode(N_INT);
+    if (i.isFinite())
+      n.v.i = i.toInt();
+    else
+      n.flags = i.isPlusInfinity() ? NF_PLUS_INF : NF_MINUS_INF;
+    return n;
+  }
+
+  Node
+  FznBinaryWriter::encodeFloat(const FloatVal& f) {
+    Node n = mkNode(N_FLOAT);
+    if (f.isFinite())
+      n.v.f = f.toDouble();
+    else
+      n.flags = f.isPlusInfinity() ? NF_PLUS_INF : NF_MINUS_INF;
+    return n;
+  }
+
+  Node
+  FznBinaryWriter::encodeRanges(const IntSetVal* isv) {
+    Node n = mkNode(N_INTSET);
+    n.a = isv->size();
+    n.v.ref.first = _nNodes;
+    for (unsigned int i=0; i<isv->size(); i++) {
+      emit(encodeInt(isv->min(i)));
+      emit(encodeInt(isv->max(i)));
+    }
+    return n;
+  }
+
+  Node
+  FznBinaryWriter::encodeRanges(const FloatSetVal* fsv) {
+    Node n = mkNode(N_FLOATSET);
+    n.a = fsv->size();
+    n.v.ref.first = _nNodes;
+    for (unsigned int i=0; i<fsv->size(); i++) {
+      emit(encodeFloat(fsv->min(i)));
+      emit(encodeFloat(fsv->max(i)));
+    }
+    return n;
+  }
+
+  Node
+  FznBinaryWriter::encodeArray(const std::vector<const Expression*>& v, Type t) {
+    // The elements have to be contiguous, so their children go first
+    std::vector<Node> elems(v.size());
+    for (unsigned int i=0; i<v.size(); i++)
+      elems[i] = encode(v[i]);
+    Node n = mkNode(N_ARRAY);
+    n.a = static_cast<uint32_t>(v.size());
+    n.v.ref.first = _nNodes;
+    n.v.ref.type = t.toInt();
+    for (unsigned int i=0; i<elems.size(); i++)
+      emit(elems[i]);
+    return n;
+  }
+
+  Node
+  FznBinaryWriter::encode(const Expression* e) {
+    switch (e->eid()) {
+    case Expression::E_INTLIT:
+      return encodeInt(e->cast<IntLit>()->v());
+    case Expression::E_FLOATLIT:
+      return encodeFloat(e->cast<FloatLit>()->v());
+    case Expression::E_BOOLLIT:
+      {
+        Node n = mkNode(N_BOOL);
+        n.v.i = e->cast<BoolLit>()->v() ? 1 : 0;
+        return n;
+      }
+    case Expression::E_STRINGLIT:
+      {
+        Node n = mkNode(N_STRING);
+        n.a = str(e->cast<StringLit>()->v().str());
+        return n;
+      }
+    case Expression::E_ID:
+      {
+        if (e == constants().absent)
+          return mkNode(N_ABSENT);
+        const Id* id = e->cast<Id>();
+        if (id->decl() && id->decl()->type().bt() != Type::BT_ANN) {
+          Node n = mkNode(N_VAR);
+          n.a = var(id->decl());
+          return n;
+        }
+        Node n = mkNode(N_ANNID);
+        n.a = str(idName(id));
+        return n;
+      }
+    case Expression::E_SETLIT:
+      {
+        const SetLit* sl = e->cast<SetLit>();
+        if (sl->isv())
+          return encodeRanges(sl->isv());
+        if (sl->fsv())
+          return encodeRanges(sl->fsv());
+      }
+      break;
+    case Expression::E_ARRAYLIT:
+      {
+        const ArrayLit* al = e->cast<ArrayLit>();
+        if (al->dims() != 1 || al->min(0) != 1)
+          break;
+        std::vector<const Expression*> v(al->v().size());
+        for (unsigned int i=0; i<v.size(); i++)
+          v[i] = al->v()[i];
+        return encodeArray(v, al->type());
+      }
+    case Expression::E_CALL:
+      {
+        const Call* c = e->cast<Call>();
+        std::vector<const Expression*> args(c->args().size());
+        for (unsigned int i=0; i<args.size(); i++)
+          args[i] = c->args()[i];
+        Node n = mkNode(N_CALL);
+        n.v.ref.first = emit(encodeArray(args, Type::top(1)));
+        n.v.ref.type = c->type().toInt();
+        n.a = str(c->id().str());
+        return n;
+      }
+    default:
+      break;
+    }
+    throw FznBinaryError("cannot write expression " + exprString(e));
+  }
+
+  uint32_t
+  FznBinaryWriter::emitAnn(const Annotation& ann) {
+    if (ann.isEmpty())
+      return NONE;
+    std::vector<const Expression*> v;
+    for (ExpressionSetIter it = ann.begin(); it != ann.end(); ++it)
+      v.push_back(*it);
+    return emit(encodeArray(v, Type::ann(1)));
+  }
+
+  void
+  FznBinaryWriter::add(const Item* item) {
+    if (item->removed())
+      return;
+    if (const VarDeclI* vdi = item->dyn_cast<VarDeclI>()) {
+      const VarDecl* vd = vdi->e();
+      const uint32_t iVar = var(vd);
+      if (_declared[iVar])
+        throw FznBinaryError("variable " + idName(vd->id()) + " declared twice");
+      _declared[iVar] = true;
+      // Encoding can add variables, so _vars[iVar] is only written at the end
+      uint32_t domain = NONE;
+      if (vd->ti()->domain())
+        domain = emit(encode(vd->ti()->domain()));
+      uint32_t index = NONE;
+      if (vd->ti()->isarray()) {
+        const ArrayLit* al = Expression::dyn_cast<ArrayLit>(vd->e());
+        std::vector<Node> ranges(vd->ti()->ranges().size());
+        for (unsigned int i=0; i<ranges.size(); i++) {
+          if (Expression* d = vd->ti()->ranges()[i]->domain()) {
+            ranges[i] = encode(d);
+          } else if (al && static_cast<int>(i) < al->dims()) {
+            GCLock lock;
+            ranges[i] = encodeRanges(IntSetVal::a(al->min(i), al->max(i)));
+          } else {
+            throw FznBinaryError("array " + idName(vd->id()) + " has no index set");
+          }
+        }
+        Node n = mkNode(N_ARRAY);
+        n.a = static_cast<uint32_t>(ranges.size());
+        n.v.ref.first = _nNodes;
+        n.v.ref.type = Type::parsetint(1).toInt();
+        for (unsigned int i=0; i<ranges.size(); i++)
+          emit(ranges[i]);
+        index = emit(n);
+      }
+      const uint32_t rhs = vd->e() ? emit(encode(vd->e())) : NONE;
+      const uint32_t ann = emitAnn(vd->ann());
+      Var& v = _vars[iVar];
+      v.domain = domain;
+      v.index = index;
+      v.rhs = rhs;
+      v.ann = ann;
+      v.flags = vd->introduced() ? VF_INTRODUCED : 0;
+      v.seq = _nDecls++;
+    } else if (const ConstraintI* ci = item->dyn_cast<ConstraintI>()) {
+      Constraint c;
+      std::memset(&c, 0, sizeof(c));
+      if (const Call* call = ci->e()->dyn_cast<Call>()) {
+        std::vector<const Expression*> args(call->args().size());
+        for (unsigned int i=0; i<args.size(); i++)
+          args[i] = call->args()[i];
+        c.args = emit(encodeArray(args, Type::top(1)));
+        c.name = str(call->id().str());
+      } else {
+        // constraint true/false or a Boolean variable
+        c.args = emit(encode(ci->e()));
+        c.name = NONE;
+      }
+      c.ann = emitAnn(ci->e()->ann());
+      _constraints.push_back(c);
+    } else if (const SolveI* si = item->dyn_cast<SolveI>()) {
+      if (_fSolve)
+        throw FznBinaryError("more than one solve item");
+      _fSolve = true;
+      _solve.st = si->st();
+      _solve.objective = si->e() ? emit(encode(si->e())) : NONE;
+      _solve.ann = emitAnn(si->ann());
+    }
+  }
+
+  void
+  FznBinaryWriter::add(const Model* flat) {
+    // Number the variables in the order of their declarations
+    for (unsigned int i=0; i<flat->size(); i++)
+      if (const VarDeclI* vdi = (*flat)[i]->dyn_cast<VarDeclI>())
+        if (!vdi->removed())
+          var(vdi->e());
+    for (unsigned int i=0; i<flat->size(); i++)
+      add((*flat)[i]);
+  }
+
+  void
+  FznBinaryWriter::output(const Model* ozn) {
+    std::ostringstream oss;
+    Printer p(oss,0);
+    p.print(ozn);
+    _ozn = oss.str();
+  }
+
+  void
+  FznBinaryWriter::finish(void) {
+    if (_fFinished)
+      return;
+    _fFinished = true;
+    for (unsigned int i=0; i<_vars.size(); i++)
+      if (!_declared[i])
+        throw FznBinaryError(std::string("variable ") + (_strData.c_str()+_strOffsets[_vars[i].name])
+                             + " is used but not declared");
+    Trailer t;
+    std::memset(&t, 0, sizeof(t));
+    uint64_t pos = sizeof(Header) + static_cast<uint64_t>(_nNodes)*sizeof(Node);
+    t.nodes.offset = sizeof(Header);
+    t.nodes.count = _nNodes;
+    struct Put {
+      std::string& buf;
+      uint64_t& pos;
+      void operator()(const void* p, size_t n) {
+        buf.append(static_cast<const char*>(p), n);
+        pos += n;
+      }
+      void pad(void) {
+        static const char zero[8] = { 0 };
+        if (pos % 8)
+          (*this)(zero, 8 - pos % 8);
+      }
+    } put = { _buf, pos };
+    t.vars.offset = pos;
+    t.vars.count = _vars.size();
+    put(_vars.data(), _vars.size()*sizeof(Var));
+    t.constraints.offset = pos;
+    t.constraints.count = _constraints.size();
+    put(_constraints.data(), _constraints.size()*sizeof(Constraint));
+    t.solve.offset = pos;
+    t.solve.count = 1;
+    put(&_solve, sizeof(_solve));
+    t.strings.offset = pos;
+    t.strings.count = _strOffsets.size();
+    put(_strOffsets.data(), _strOffsets.size()*sizeof(uint64_t));
+    t.stringData.offset = pos;
+    t.stringData.count = _strData.size();
+    put(_strData.data(), _strData.size());
+    put.pad();
+    t.output.offset = pos;
+    t.output.count = _ozn.size();
+    put(_ozn.data(), _ozn.size());
+    put.pad();
+    std::memcpy(t.magic, MAGIC, sizeof(MAGIC));
+    put(&t, sizeof(t));
+    flush();
+    _os.flush();
+  }
+
+  FznBinaryFile::FznBinaryFile(const std::string& filename)
+    : _data(NULL), _size(0), _map(NULL) {
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw FznBinaryError("cannot open file " + filename);
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        _map = p;
+        _data = static_cast<const char*>(p);
+        _size = st.st_size;
+      }
+    }
+    close(fd);
+#endif
+    if (_map == NULL) {
+      std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+      if (!is.good())
+        throw FznBinaryError("cannot open file " + filename);
+      is.seekg(0, std::ios::end);
+      std::streamoff n = is.tellg();
+      is.seekg(0, std::ios::beg);
+      if (n < 0)
+        throw FznBinaryError("cannot read file " + filename);
+      _size = static_cast<size_t>(n);
+      _copy.resize((_size + 7) / 8);
+      if (_size)
+        is.read(reinterpret_cast<char*>(_copy.data()), _size);
+      if (!is.good())
+        throw FznBinaryError("cannot read file " + filename);
+      _data = reinterpret_cast<const char*>(_copy.data());
+    }
+    try {
+      init();
+    } catch (const FznBinaryError& e) {
+#ifndef _WIN32
+      if (_map)
+        munmap(_map, _size);
+#endif
+      throw FznBinaryError(filename + ": " + e.msg());
+    }
+  }
+
+  FznBinaryFile::FznBinaryFile(const char* data, size_t size)
+    : _data(data), _size(size), _map(NULL) {
+    init();
+  }
+
+  FznBinaryFile::~FznBinaryFile(void) {
+#ifndef _WIN32
+    if (_map) {
+      munmap(_map, _size);
+      _map = NULL;
+    }
+#endif
+  }
+
+  void
+  FznBinaryFile::init(void) {
+    if (_size < sizeof(Header) + sizeof(Trailer))
+      throw FznBinaryError("not a binary FlatZinc file");
+    Header h;
+    std::memcpy(&h, _data, sizeof(h));
+    Trailer t;
+    std::memcpy(&t, _data + _size - sizeof(t), sizeof(t));
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0
+        || std::memcmp(t.magic, MAGIC, sizeof(MAGIC)) != 0)
+      throw FznBinaryError("not a binary FlatZinc file");
+    if (h.byteOrder != BYTE_ORDER_MARK)
+      throw FznBinaryError("written on a machine with a different byte order");
+    if (h.version != VERSION) {
+      std::ostringstream oss;
+      oss << "format version " << h.version << ", expected " << VERSION;
+      throw FznBinaryError(oss.str());
+    }
+    const uint64_t end = _size - sizeof(t);
+    /// Checks that a section lies within the file and returns its start
+    struct Check {
+      const char* data;
+      uint64_t end;
+      const char* operator()(const Section& s, size_t recSize, bool fAligned) const {
+        if (s.offset > end || s.count > 0xFFFFFFFFu || s.count * recSize > end - s.offset
+            || (fAligned && s.offset % 8 != 0))
+          throw FznBinaryError("corrupt section table");
+        return data + s.offset;
+      }
+    } check = { _data, end };
+    _nodes = reinterpret_cast<const Node*>(check(t.nodes, sizeof(Node), true));
+    _nNodes = static_cast<uint32_t>(t.nodes.count);
+    _vars = reinterpret_cast<const Var*>(check(t.vars, sizeof(Var), true));
+    _nVars = static_cast<uint32_t>(t.vars.count);
+    _constraints = reinterpret_cast<const Constraint*>(check(t.constraints, sizeof(Constraint), true));
+    _nConstraints = static_cast<uint32_t>(t.constraints.count);
+    if (t.solve.count != 1)
+      throw FznBinaryError("corrupt section table");
+    _solve = reinterpret_cast<const Solve*>(check(t.solve, sizeof(Solve), true));
+    _strOffsets = reinterpret_cast<const uint64_t*>(check(t.strings, sizeof(uint64_t), true));
+    _nStrings = static_cast<uint32_t>(t.strings.count);
+    _strData = check(t.stringData, 1, false);
+    _strSize = static_cast<size_t>(t.stringData.count);
+    if (_strSize && _strData[_strSize-1] != '\0')
+      throw FznBinaryError("corrupt string table");
+    for (uint32_t i=0; i<_nStrings; i++)
+      if (_strOffsets[i] >= _strSize)
+        throw FznBinaryError("corrupt string table");
+    _ozn = check(t.output, 1, false);
+    _oznSize = static_cast<size_t>(t.output.count);
+  }
+
+  const Node&
+  FznBinaryFile::node(uint32_t i) const {
+    if (i >= _nNodes)
+      throw FznBinaryError("node index out of range");
+    return _nodes[i];
+  }
+
+  const Node&
+  FznBinaryFile::elem(const Node& n, uint32_t j) const {
+    if (j >= n.a)
+      throw FznBinaryError("element index out of range");
+    return node(n.v.ref.first + j);
+  }
+
+  const char*
+  FznBinaryFile::str(uint32_t i) const {
+    if (i >= _nStrings)
+      throw FznBinaryError("string index out of range");
+    return _strData + _strOffsets[i];
+  }
+
+  std::string
+  FznBinaryFile::output(void) const {
+    return std::string(_ozn, _oznSize);
+  }
+
+  namespace {
+    /// Rebuilds the flat model from a binary FlatZinc file
+    class FznBinaryLoader {
+    public:
+      FznBinaryLoader(const FznBinaryFile& f) : _f(f) {}
+      void load(Model* flat);
+    private:
+      const FznBinaryFile& _f;
+      std::vector<VarDecl*> _decls;
+
+      Expression* expr(uint32_t i);
+      /// Index of the first child of node \a i, which has \a n children before it
+      uint32_t children(uint32_t i, uint64_t n);
+      IntVal intVal(uint32_t i);
+      FloatVal floatVal(uint32_t i);
+      std::vector<Expression*> elems(uint32_t i);
+      void annotate(Expression* e, uint32_t ann);
+    };
+
+    uint32_t
+    FznBinaryLoader::children(uint32_t i, uint64_t n) {
+      const Node& node = _f.node(i);
+      // Children precede their parents, which also rules out cycles
+      if (static_cast<uint64_t>(node.v.ref.first) + n > i)
+        throw FznBinaryError("corrupt expression node");
+      return node.v.ref.first;
+    }
+
+    IntVal
+    FznBinaryLoader::intVal(uint32_t i) {
+      const Node& n = _f.node(i);
+      if (n.kind != N_INT)
+        throw FznBinaryError("integer expected");
+      if (n.flags & NF_PLUS_INF)
+        return IntVal::infinity();
+      if (n.flags & NF_MINUS_INF)
+        return -IntVal::infinity();
+      return n.v.i;
+    }
+
+    FloatVal
+    FznBinaryLoader::floatVal(uint32_t i) {
+      const Node& n = _f.node(i);
+      if (n.kind != N_FLOAT)
+        throw FznBinaryError("float expected");
+      if (n.flags & NF_PLUS_INF)
+        return FloatVal::infinity();
+      if (n.flags & NF_MINUS_INF)
+        return -FloatVal::infinity();
+      return n.v.f;
+    }
+
+    std::vector<Expression*>
+    FznBinaryLoader::elems(uint32_t i) {
+      const Node& n = _f.node(i);
+      if (n.kind != N_ARRAY)
+        throw FznBinaryError("array expected");
+      const uint32_t first = children(i, n.a);
+      std::vector<Expression*> v(n.a);
+      for (uint32_t j=0; j<n.a; j++)
+        v[j] = expr(first+j);
+      return v;
+    }
+
+    Expression*
+    FznBinaryLoader::expr(uint32_t i) {
+      const Node& n = _f.node(i);
+      switch (n.kind) {
+      case N_BOOL:
+        return constants().boollit(n.v.i != 0);
+      case N_INT:
+        return IntLit::a(intVal(i));
+      case N_FLOAT:
+        return FloatLit::a(floatVal(i));
+      case N_STRING:
+        return new StringLit(Location().introduce(), std::string(_f.str(n.a)));
+      case N_VAR:
+        if (n.a >= _decls.size())
+          throw FznBinaryError("variable index out of range");
+        return _decls[n.a]->id();
+      case N_ANNID:
+        {
+          Id* id = new Id(Location().introduce(), std::string(_f.str(n.a)), NULL);
+          id->type(Type::ann());
+          return id;
+        }
+      case N_ABSENT:
+        return constants().absent;
+      case N_ARRAY:
+        {
+          ArrayLit* al = new ArrayLit(Location().introduce(), elems(i));
+          al->type(Type::fromInt(n.v.ref.type));
+          return al;
+        }
+      case N_INTSET:
+        {
+          const uint32_t first = children(i, 2*static_cast<uint64_t>(n.a));
+          std::vector<IntSetVal::Range> ranges(n.a);
+          for (uint32_t j=0; j<n.a; j++)
+            ranges[j] = IntSetVal::Range(intVal(first+2*j), intVal(first+2*j+1));
+          SetLit* sl = new SetLit(Location().introduce(), IntSetVal::a(ranges));
+          sl->type(Type::parsetint());
+          return sl;
+        }
+      case N_FLOATSET:
+        {
+          const uint32_t first = children(i, 2*static_cast<uint64_t>(n.a));
+          std::vector<FloatSetVal::Range> ranges(n.a);
+          for (uint32_t j=0; j<n.a; j++)
+            ranges[j] = FloatSetVal::Range(floatVal(first+2*j), floatVal(first+2*j+1));
+          SetLit* sl = new SetLit(Location().introduce(), FloatSetVal::a(ranges));
+          sl->type(Type::parsetfloat());
+          return sl;
+        }
+      case N_CALL:
+        {
+          Call* c = new Call(Location().introduce(), std::string(_f.str(n.a)),
+                             elems(children(i, 1)));
+          c->type(Type::fromInt(n.v.ref.type));
+          return c;
+        }
+      default:
+        throw FznBinaryError("unknown expression node");
+      }
+    }
+
+    void
+    FznBinaryLoader::annotate(Expression* e, uint32_t ann) {
+      if (ann == NONE)
+        return;
+      std::vector<Expression*> v = elems(ann);
+      for (unsigned int i=0; i<v.size(); i++)
+        e->addAnnotation(v[i]);
+    }
+
+    void
+    FznBinaryLoader::load(Model* flat) {
+      const uint32_t nVars = _f.nVars();
+      _decls.resize(nVars);
+      std::vector<uint32_t> bySeq(nVars, NONE);
+      // Declarations first, so that any expression can refer to any variable
+      for (uint32_t i=0; i<nVars; i++) {
+        const Var& v = _f.var(i);
+        Type t = Type::fromInt(v.type);
+        std::vector<TypeInst*> ranges;
+        if (v.index != NONE) {
+          std::vector<Expression*> sets = elems(v.index);
+          for (unsigned int j=0; j<sets.size(); j++)
+            ranges.push_back(new TypeInst(Location().introduce(), Type::parint(), sets[j]));
+        }
+        Expression* domain = v.domain == NONE ? NULL : expr(v.domain);
+        TypeInst* ti = new TypeInst(Location().introduce(), t, ASTExprVec<TypeInst>(ranges), domain);
+        VarDecl* vd = new VarDecl(Location().introduce(), ti, std::string(_f.str(v.name)));
+        vd->introduced((v.flags & VF_INTRODUCED) != 0);
+        _decls[i] = vd;
+        if (v.seq >= nVars || bySeq[v.seq] != NONE)
+          throw FznBinaryError("corrupt variable table");
+        bySeq[v.seq] = i;
+      }
+      for (uint32_t s=0; s<nVars; s++) {
+        const Var& v = _f.var(bySeq[s]);
+        VarDecl* vd = _decls[bySeq[s]];
+        if (v.rhs != NONE)
+          vd->e(expr(v.rhs));
+        annotate(vd, v.ann);
+        flat->addItem(new VarDeclI(Location().introduce(), vd));
+      }
+      for (uint32_t i=0; i<_f.nConstraints(); i++) {
+        const Constraint& c = _f.constraint(i);
+        Expression* e;
+        if (c.name == NONE) {
+          e = expr(c.args);
+        } else {
+          Call* call = new Call(Location().introduce(), std::string(_f.str(c.name)), elems(c.args));
+          call->type(Type::varbool());
+          e = call;
+        }
+        annotate(e, c.ann);
+        flat->addItem(new ConstraintI(Location().introduce(), e));
+      }
+      const Solve& s = _f.solve();
+      SolveI* si;
+      if (s.st == SolveI::ST_SAT) {
+        si = SolveI::sat(Location().introduce());
+      } else if (s.objective != NONE && (s.st == SolveI::ST_MIN || s.st == SolveI::ST_MAX)) {
+        Expression* obj = expr(s.objective);
+        si = s.st == SolveI::ST_MIN ? SolveI::min(Location().introduce(), obj)
+                                    : SolveI::max(Location().introduce(), obj);
+      } else {
+        throw FznBinaryError("corrupt solve item");
+      }
+      if (s.ann != NONE) {
+        std::vector<Expression*> v = elems(s.ann);
+        for (unsigned int i=0; i<v.size(); i++)
+          si->ann().add(v[i]);
+      }
+      flat->addItem(si);
+    }
+  }
+
+  void
+  loadFznBinary(Env& env, const FznBinaryFile& f) {
+    GCLock lock;
+    FznBinaryLoader l(f);
+    l.load(env.flat());
+  }
+
+}
@@ -14,6 +14,7 @@
 #include <minizinc/hash.hh>
 #include <minizinc/model.hh>
 #include <minizinc/config.hh>
+#include <minizinc/timer.hh>
 
 #include <vector>
 #include <cstring>
@@ -117,6 +118,12 @@ namespace MiniZinc {
     size_t _gc_threshold;
     /// High water mark of all allocated memory
     size_t _max_alloced_mem;
+    /// High water mark since the last call to GC::resetPeakMem
+    size_t _peak_alloced_mem;
+    /// Number of garbage collections
+    unsigned long int _n_collections;
+    /// Total time spent in garbage collection (in milliseconds)
+    double _gc_time;
 
     /// A trail item
     struct TItem {
@@ -138,7 +145,10 @@ namespace MiniZinc {
       , _alloced_mem(0)
       , _free_mem(0)
       , _gc_threshold(10)
-      , _max_alloced_mem(0) {
+      , _max_alloced_mem(0)
+      , _peak_alloced_mem(0)
+      , _n_collections(0)
+      , _gc_time(0.0) {
       for (int i=_max_fl+1; i--;)
         _fl[i] = NULL;
     }
@@ -159,6 +169,7 @@ namespace MiniZinc {
 #endif
       _alloced_mem += s;
       _max_alloced_mem = std::max(_max_alloced_mem, _alloced_mem);
+      _peak_alloced_mem = std::max(_peak_alloced_mem, _alloced_mem);
       _free_mem += s;
       if (exact && _page) {
         new (newPage) HeapPage(_page->next,s);
@@ -222,23 +233,28 @@ namespace MiniZinc {
     }
 
     void rungc(void) {
-      if (_alloced_mem > _gc_threshold) {
+      if (_alloced_mem > _gc_threshold)
+        collect();
+    }
+    void collect(void) {
 #ifdef MINIZINC_GC_STATS
-        std::cerr << "GC\n\talloced " << (_alloced_mem/1024) << "\n\tfree " << (_free_mem/1024) << "\n\tdiff "
-                  << ((_alloced_mem-_free_mem)/1024)
-                  << "\n\tthreshold " << (_gc_threshold/1024)
-                  << "\n";
+      std::cerr << "GC\n\talloced " << (_alloced_mem/1024) << "\n\tfree " << (_free_mem/1024) << "\n\tdiff "
+                << ((_alloced_mem-_free_mem)/1024)
+                << "\n\tthreshold " << (_gc_threshold/1024)
+                << "\n";
 #endif
-        mark();
-        sweep();
-        _gc_threshold = static_cast<size_t>(_alloced_mem * 1.5);
+      Timer t;
+      mark();
+      sweep();
+      _gc_threshold = static_cast<size_t>(_alloced_mem * 1.5);
+      _gc_time += t.ms();
+      _n_collections++;
 #ifdef MINIZINC_GC_STATS
-        std::cerr << "done\n\talloced " << (_alloced_mem/1024) << "\n\tfree " << (_free_mem/1024) << "\n\tdiff "
-                  << ((_alloced_mem-_free_mem)/1024)
-                  << "\n\tthreshold " << (_gc_threshold/1024)
-                  << "\n";
+      std::cerr << "done\n\talloced " << (_alloced_mem/1024) << "\n\tfree " << (_free_mem/1024) << "\n\tdiff "
+                << ((_alloced_mem-_free_mem)/1024)
+                << "\n\tthreshold " << (_gc_threshold/1024)
+                << "\n";
 #endif
-      }
     }
     void mark(void);
     void sweep(void);
@@ -346,6 +362,11 @@ namespace MiniZinc {
     assert(locked());
     gc()->_lock_count--;
   }
+  void
+  GC::collect(void) {
+    if (gc()!=NULL && gc()->_lock_count==0)
+      gc()->_heap->collect();
+  }
 
   const size_t GC::Heap::pageSize;
 
@@ -662,6 +683,31 @@ namespace MiniZinc {
     GC* gc = GC::gc();
     return gc->_heap->_max_alloced_mem;
   }
+  size_t
+  GC::peakMem(void) {
+    GC* gc = GC::gc();
+    return gc->_heap->_peak_alloced_mem;
+  }
+  void
+  GC::resetPeakMem(void) {
+    GC* gc = GC::gc();
+    gc->_heap->_peak_alloced_mem = gc->_heap->_alloced_mem;
+  }
+  size_t
+  GC::allocedMem(void) {
+    GC* gc = GC::gc();
+    return gc->_heap->_alloced_mem;
+  }
+  unsigned long int
+  GC::collections(void) {
+    GC* gc = GC::gc();
+    return gc->_heap->_n_collections;
+  }
+  double
+  GC::collectionTime(void) {
+    GC* gc = GC::gc();
+    return gc->_heap->_gc_time;
+  }
   
 
   void*
@@ -114,8 +114,8 @@ namespace MiniZinc {
               char rest[3];
               is.read(rest,sizeof(rest));
               column += sizeof(rest);
-              if (!is.good() || rest != string("rue"))
-                throw JSONError(env,errLocation(),"unexpected token `"+string(rest)+"'");
+              if (!is.good() || string(rest,sizeof(rest)) != "rue")
+                throw JSONError(env,errLocation(),"unexpected token `"+string(rest,sizeof(rest))+"'");
               state = S_NOTHING;
               return Token(true);
             }
@@ -125,18 +125,18 @@ namespace MiniZinc {
               char rest[4];
               is.read(rest,sizeof(rest));
               column += sizeof(rest);
-              if (!is.good() || rest != string("alse"))
-                throw JSONError(env,errLocation(),"unexpected token "+string(rest));
+              if (!is.good() || string(rest,sizeof(rest)) != "alse")
+                throw JSONError(env,errLocation(),"unexpected token "+string(rest,sizeof(rest)));
               state = S_NOTHING;
               return Token(false);
             }
               break;
             default:
-              if (buf[0]>='0' && buf[0]<='9') {
-                result = buf;
+              if ((buf[0]>='0' && buf[0]<='9') || buf[0]=='-') {
+                result = string(1,buf[0]);
                 state=S_INT;
               } else {
-                throw JSONError(env,errLocation(),"unexpected token "+string(buf));
+                throw JSONError(env,errLocation(),"unexpected token "+string(1,buf[0]));
               }
               break;
           }
@@ -149,6 +149,10 @@ namespace MiniZinc {
           result += buf[0];
           break;
         case S_INT:
+          if (result=="-" && !(buf[0]>='0' && buf[0]<='9')) {
+            // a minus sign must be followed by a digit
+            throw JSONError(env,errLocation(),"unexpected token "+result);
+          }
           if (buf[0]=='.') {
             result += buf[0];
             state=S_FLOAT;
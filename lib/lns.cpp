@@ -0,0 +1,246 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+
+#include <minizinc/lns.hh>
+#include <minizinc/timer.hh>
+
+namespace MiniZinc {
+
+  namespace {
+    /// Finds a relax_and_reconstruct annotation, also inside seq_search
+    Call* findRelaxAndReconstruct(Expression* e) {
+      if (Call* c = e->dyn_cast<Call>()) {
+        if (c->id().str() == "relax_and_reconstruct" && c->args().size() == 2)
+          return c;
+        if (c->id().str() == "seq_search") {
+          if (ArrayLit* anns = c->args()[0]->dyn_cast<ArrayLit>()) {
+            for (unsigned int i=0; i<anns->v().size(); i++)
+              if (Call* rr = findRelaxAndReconstruct(anns->v()[i]))
+                return rr;
+          }
+        }
+      }
+      return NULL;
+    }
+  }
+
+  LNS::LNS(SolverInstanceBase2& si) : _si(si) {}
+
+  void
+  LNS::collectVars(void) {
+    Model* flat = _si.getEnv()->flat();
+    SolveI* solve = flat->solveItem();
+    if (solve->st() != SolveI::ST_SAT && solve->e() && solve->e()->isa<Id>()) {
+      _obj = solve->e();
+      _fMax = solve->st() == SolveI::ST_MAX;
+      _fIntObj = !_obj->type().isfloat();
+    }
+    VarDecl* objDecl = _obj ? _obj->cast<Id>()->decl() : NULL;
+
+    Call* rr = NULL;
+    for (ExpressionSetIter it = solve->ann().begin(); it != solve->ann().end() && !rr; ++it)
+      rr = findRelaxAndReconstruct(*it);
+    if (rr) {
+      Expression* x = rr->args()[0];
+      if (Id* id = x->dyn_cast<Id>())
+        x = id->decl()->e();
+      if (ArrayLit* al = x ? x->dyn_cast<ArrayLit>() : NULL) {
+        for (unsigned int i=0; i<al->v().size(); i++)
+          if (Id* id = al->v()[i]->dyn_cast<Id>())
+            if (id->type().isvar() && id->decl()->e() == NULL && id->decl() != objDecl)
+              _vars.push_back(id->decl());
+      }
+    } else {
+      // Variables defined by a constraint follow the others, so leave them free
+      for (VarDeclIterator it = flat->begin_vardecls(); it != flat->end_vardecls(); ++it) {
+        if (it->removed())
+          continue;
+        VarDecl* vd = it->e();
+        if (vd->type().isvar() && vd->type().dim() == 0
+            && (vd->type().isint() || vd->type().isbool())
+            && vd->e() == NULL && vd != objDecl
+            && !vd->ann().contains(constants().ann.is_defined_var))
+          _vars.push_back(vd);
+      }
+    }
+    _vals.resize(_vars.size());
+  }
+
+  void
+  LNS::storeSolution(void) {
+    GCLock lock;
+    for (unsigned int i=0; i<_vars.size(); i++) {
+      Expression* v = _si.getSolutionValue(_vars[i]->id());
+      if (IntLit* il = v->dyn_cast<IntLit>())
+        _vals[i] = il->v().toInt();
+      else if (BoolLit* bl = v->dyn_cast<BoolLit>())
+        _vals[i] = bl->v();
+    }
+    ++nSolutions;
+    // next() has already assigned the output; the solver's own printSolution()
+    // may hold it back for the end of the search
+    _si.SolverInstanceBase2::printSolution();
+    if (_obj == NULL)
+      return;
+
+    Expression* v = _si.getSolutionValue(_obj->cast<Id>());
+    Expression* bound;
+    if (_fIntObj) {
+      _intObj = v->isa<IntLit>() ? v->cast<IntLit>()->v().toInt() : v->cast<BoolLit>()->v();
+      bound = IntLit::a(_intObj);
+    } else {
+      _floatObj = v->cast<FloatLit>()->v().toDouble();
+      bound = FloatLit::a(_floatObj);
+    }
+    std::vector<Expression*> args(2);
+    args[_fMax ? 1 : 0] = _obj;
+    args[_fMax ? 0 : 1] = bound;
+    Model m;
+    m.addItem(new ConstraintI(Location(), new Call(Location(), _fIntObj ? "int_lt" : "float_lt", args)));
+    _si.processPermanentConstraints(m.begin(), m.end());
+  }
+
+  SolverInstance::Status
+  LNS::search(Model& m, long long int nodes, long long int timeMs, bool fFirst, bool& fImproved) {
+    _si.getOptions().setIntParam("nodes", nodes);
+    _si.getOptions().setIntParam("time", timeMs);
+    _si.resetWithConstraints(m.begin(), m.end());
+    SolverInstance::Status st;
+    while ((st = _si.next()) == SolverInstance::SAT) {
+      fImproved = true;
+      storeSolution();
+      if (fFirst || _obj == NULL)
+        break;
+    }
+    return st;
+  }
+
+  SolverInstance::Status
+  LNS::run(void) {
+    Timer timer;
+    collectVars();
+    Options& o = _si.getOptions();
+    const long long int maxIterations = o.getIntParam("lns_iterations", 0);
+    const long long int timeLimit = o.getIntParam("lns_time", 0);
+    const long long int itNodes = o.getIntParam("lns_nodes", 1000);
+    const long long int itTime = o.getIntParam("lns_iteration_time", 0);
+    double fix = o.getIntParam("lns_fix", 70);
+    const double adapt = o.getIntParam("lns_adapt", 5);
+    _rnd.seed(static_cast<unsigned int>(o.getIntParam("seed", 1)));
+    _fVerbose = o.getBoolParam(constants().opts.verbose.str(), false);
+    _fStats = o.getBoolParam(constants().opts.statistics.str(), false);
+    if (!o.hasParam("lns_fix")) {
+      SolveI* solve = _si.getEnv()->flat()->solveItem();
+      for (ExpressionSetIter it = solve->ann().begin(); it != solve->ann().end(); ++it)
+        if (Call* rr = findRelaxAndReconstruct(*it)) {
+          if (IntLit* p = rr->args()[1]->dyn_cast<IntLit>())
+            fix = p->v().toInt();
+          break;
+        }
+    }
+    /// Time left for the solver in ms, 0 if there is no limit
+    auto timeLeft = [&]() -> long long int {
+      if (timeLimit <= 0)
+        return 0;
+      return std::max(1LL, timeLimit - static_cast<long long int>(timer.ms()));
+    };
+    if (_fVerbose)
+      std::cerr << "  LNS: " << _vars.size() << " neighbourhood variables, fixing "
+                << fix << "% at the start" << std::endl;
+
+    // First solution: no fixings, only the overall time limit
+    bool fImproved = false;
+    SolverInstance::Status st;
+    {
+      Model m;
+      st = search(m, 0, timeLeft(), true, fImproved);
+    }
+    if (nSolutions == 0 || _obj == NULL) {
+      dTime = timer.ms();
+      return st;
+    }
+
+    bool fOptimal = false;
+    while ((maxIterations <= 0 || nIterations < maxIterations)
+           && (timeLimit <= 0 || timer.ms() < timeLimit)) {
+      ++nIterations;
+      Timer itTimer;
+      Model m;
+      unsigned int nFixed = 0;
+      {
+        GCLock lock;
+        std::uniform_real_distribution<double> percent(0.0, 100.0);
+        for (unsigned int i=0; i<_vars.size(); i++) {
+          if (percent(_rnd) >= fix)
+            continue;
+          std::vector<Expression*> args(2);
+          args[0] = _vars[i]->id();
+          if (_vars[i]->type().isbool()) {
+            args[1] = constants().boollit(_vals[i] != 0);
+            m.addItem(new ConstraintI(Location(), new Call(Location(), "bool_eq", args)));
+          } else {
+            args[1] = IntLit::a(_vals[i]);
+            m.addItem(new ConstraintI(Location(), new Call(Location(), "int_eq", args)));
+          }
+          ++nFixed;
+        }
+      }
+      long long int t = timeLeft();
+      if (itTime > 0)
+        t = t > 0 ? std::min(t, itTime) : itTime;
+      fImproved = false;
+      st = search(m, itNodes, t, false, fImproved);
+      if (fImproved)
+        ++nImproving;
+      const bool fExhausted = st == SolverInstance::UNSAT;
+      if (fExhausted) {
+        ++nExhausted;
+        // Nothing fixed and nothing better left: the incumbent is optimal
+        fOptimal = nFixed == 0;
+        if (!fImproved)
+          fix = std::max(0.0, fix - adapt);
+      } else if (!fImproved) {
+        fix = std::min(100.0, fix + adapt);
+      }
+      if (_fStats || _fVerbose) {
+        std::cerr << "%%  LNS iteration " << nIterations << ": fixed " << nFixed
+                  << " of " << _vars.size() << ", "
+                  << (fExhausted ? "exhausted" : "limit reached");
+        if (fImproved) {
+          std::cerr << ", objective ";
+          if (_fIntObj)
+            std::cerr << _intObj;
+          else
+            std::cerr << _floatObj;
+        }
+        std::cerr << ", " << itTimer.ms() << " ms" << std::endl;
+      }
+      if (fOptimal)
+        break;
+      if (!fExhausted && st != SolverInstance::UNKNOWN)
+        break;                      // error
+    }
+    dTime = timer.ms();
+    return fOptimal ? SolverInstance::OPT : SolverInstance::SAT;
+  }
+
+  void
+  LNS::printStatistics(std::ostream& os) const {
+    os << "%%  LNS iterations:  " << nIterations << std::endl
+       << "%%  LNS improving:   " << nImproving << std::endl
+       << "%%  LNS exhausted:   " << nExhausted << std::endl
+       << "%%  LNS solutions:   " << nSolutions << std::endl
+       << "%%  LNS time:        " << dTime/1000.0 << " s" << std::endl;
+  }
+
+}
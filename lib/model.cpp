@@ -18,7 +18,8 @@
 
 namespace MiniZinc {
   
-  Model::Model(void) : _parent(NULL), _solveItem(NULL), _outputItem(NULL) {
+  Model::Model(void) : _fnCacheValid(false), _fnCacheEnv(NULL), _fnCacheHits(0), _fnCacheMisses(0),
+                       _parent(NULL), _solveItem(NULL), _outputItem(NULL) {
     GC::add(this);
   }
 
@@ -91,6 +92,9 @@ namespace MiniZinc {
     Model* m = this;
     while (m->_parent)
       m = m->_parent;
+    // parameter types of newly registered functions may not be known yet
+    m->_fnCache.clear();
+    m->_fnCacheValid = false;
     FnMap::iterator i_id = m->fnmap.find(fi->id());
     if (i_id == m->fnmap.end()) {
       // new element
@@ -142,6 +146,16 @@ namespace MiniZinc {
     if (i_id == m->fnmap.end()) {
       return NULL;
     }
+    FnCacheKey k;
+    k.id = i_id->first;
+    k.t.resize(t.size());
+    for (unsigned int i=0; i<t.size(); i++)
+      k.t[i] = t[i].toInt();
+    k.strictEnums = strictEnums;
+    k.byType = true;
+    FunctionI* cached;
+    if (m->fnCacheLookup(env, k, cached))
+      return cached;
     std::vector<FunctionI*>& v = i_id->second;
     for (unsigned int i=0; i<v.size(); i++) {
       FunctionI* fi = v[i];
@@ -161,13 +175,48 @@ namespace MiniZinc {
           }
         }
         if (match) {
+          m->fnCacheInsert(k, fi);
           return fi;
         }
       }
     }
+    m->fnCacheInsert(k, NULL);
     return NULL;
   }
 
+  bool
+  Model::fnCacheLookup(EnvI& env, const FnCacheKey& k, FunctionI*& fi) const {
+    if (_fnCacheEnv != &env) {
+      // enum ids in the key are only meaningful relative to one environment
+      _fnCache.clear();
+      _fnCacheEnv = &env;
+    }
+    FnCache::const_iterator it = _fnCacheValid ? _fnCache.find(k) : _fnCache.end();
+    if (it == _fnCache.end()) {
+      _fnCacheMisses++;
+      return false;
+    }
+    _fnCacheHits++;
+    fi = it->second;
+    return true;
+  }
+
+  unsigned long long
+  Model::fnCacheHits(void) const {
+    const Model* m = this;
+    while (m->_parent)
+      m = m->_parent;
+    return m->_fnCacheHits;
+  }
+
+  unsigned long long
+  Model::fnCacheMisses(void) const {
+    const Model* m = this;
+    while (m->_parent)
+      m = m->_parent;
+    return m->_fnCacheMisses;
+  }
+
   void
   Model::mergeStdLib(EnvI &env, Model *m) const {
     for (FnMap::const_iterator it=fnmap.begin(); it != fnmap.end(); ++it) {
@@ -203,12 +252,21 @@ namespace MiniZinc {
     Model* m = this;
     while (m->_parent)
       m = m->_parent;
+    m->_fnCache.clear();
     FunSort funsort;
     for (FnMap::iterator it=m->fnmap.begin(); it!=m->fnmap.end(); ++it) {
       std::sort(it->second.begin(),it->second.end(),funsort);
     }
   }
 
+  void
+  Model::enableFnCache(void) {
+    Model* m = this;
+    while (m->_parent)
+      m = m->_parent;
+    m->_fnCacheValid = true;
+  }
+
   void
   Model::checkFnOverloading(EnvI& env) {
     Model* m = this;
@@ -241,6 +299,56 @@ namespace MiniZinc {
     }
   }
   
+  namespace {
+    /// Return the overload in \a v matching the argument expressions \a args
+    template<class Args>
+    FunctionI* matchArgs(EnvI& env, const std::vector<FunctionI*>& v,
+                         const Args& args, bool strictEnums) {
+      std::vector<FunctionI*> matched;
+      const Expression* botarg = NULL;
+      for (unsigned int i=0; i<v.size(); i++) {
+        FunctionI* fi = v[i];
+#ifdef MZN_DEBUG_FUNCTION_REGISTRY
+        std::cerr << "try " << *fi;
+#endif
+        if (fi->params().size() == args.size()) {
+          bool match=true;
+          for (unsigned int j=0; j<args.size(); j++) {
+            if (!env.isSubtype(args[j]->type(),fi->params()[j]->type(),strictEnums)) {
+#ifdef MZN_DEBUG_FUNCTION_REGISTRY
+              std::cerr << args[j]->type().toString(env) << " does not match "
+              << fi->params()[j]->type().toString(env) << "\n";
+              std::cerr << "Wrong argument is " << *args[j];
+#endif
+              match=false;
+              break;
+            }
+            if (args[j]->type().isbot() && fi->params()[j]->type().bt()!=Type::BT_TOP) {
+              botarg = args[j];
+            }
+          }
+          if (match) {
+            if (botarg)
+              matched.push_back(fi);
+            else
+              return fi;
+          }
+        }
+      }
+      if (matched.empty())
+        return NULL;
+      if (matched.size()==1)
+        return matched[0];
+      Type t = matched[0]->ti()->type();
+      t.ti(Type::TI_PAR);
+      for (unsigned int i=1; i<matched.size(); i++) {
+        if (!env.isSubtype(t,matched[i]->ti()->type(),strictEnums))
+          throw TypeError(env, botarg->loc(), "ambiguous overloading on return type of function");
+      }
+      return matched[0];
+    }
+  }
+
   FunctionI*
   Model::matchFn(EnvI& env, const ASTString& id,
                  const std::vector<Expression*>& args,
@@ -254,48 +362,19 @@ namespace MiniZinc {
     if (it == m->fnmap.end()) {
       return NULL;
     }
-    const std::vector<FunctionI*>& v = it->second;
-    std::vector<FunctionI*> matched;
-    Expression* botarg = NULL;
-    for (unsigned int i=0; i<v.size(); i++) {
-      FunctionI* fi = v[i];
-#ifdef MZN_DEBUG_FUNCTION_REGISTRY
-      std::cerr << "try " << *fi;
-#endif
-      if (fi->params().size() == args.size()) {
-        bool match=true;
-        for (unsigned int j=0; j<args.size(); j++) {
-          if (!env.isSubtype(args[j]->type(),fi->params()[j]->type(),strictEnums)) {
-#ifdef MZN_DEBUG_FUNCTION_REGISTRY
-            std::cerr << args[j]->type().toString(env) << " does not match "
-            << fi->params()[j]->type().toString(env) << "\n";
-#endif
-            match=false;
-            break;
-          }
-          if (args[j]->type().isbot() && fi->params()[j]->type().bt()!=Type::BT_TOP) {
-            botarg = args[j];
-          }
-        }
-        if (match) {
-          if (botarg)
-            matched.push_back(fi);
-          else
-            return fi;
-        }
-      }
-    }
-    if (matched.empty())
-      return NULL;
-    if (matched.size()==1)
-      return matched[0];
-    Type t = matched[0]->ti()->type();
-    t.ti(Type::TI_PAR);
-    for (unsigned int i=1; i<matched.size(); i++) {
-      if (!env.isSubtype(t,matched[i]->ti()->type(),strictEnums))
-        throw TypeError(env, botarg->loc(), "ambiguous overloading on return type of function");
+    FnCacheKey k;
+    k.id = it->first;
+    k.t.resize(args.size());
+    for (unsigned int i=0; i<args.size(); i++)
+      k.t[i] = args[i]->type().toInt();
+    k.strictEnums = strictEnums;
+    k.byType = false;
+    FunctionI* fi;
+    if (!m->fnCacheLookup(env, k, fi)) {
+      fi = matchArgs(env, it->second, args, strictEnums);
+      m->fnCacheInsert(k, fi);
     }
-    return matched[0];
+    return fi;
   }
   
   FunctionI*
@@ -309,49 +388,19 @@ namespace MiniZinc {
     if (it == m->fnmap.end()) {
       return NULL;
     }
-    const std::vector<FunctionI*>& v = it->second;
-    std::vector<FunctionI*> matched;
-    Expression* botarg = NULL;
-    for (unsigned int i=0; i<v.size(); i++) {
-      FunctionI* fi = v[i];
-#ifdef MZN_DEBUG_FUNCTION_REGISTRY
-      std::cerr << "try " << *fi;
-#endif
-      if (fi->params().size() == c->args().size()) {
-        bool match=true;
-        for (unsigned int j=0; j<c->args().size(); j++) {
-          if (!env.isSubtype(c->args()[j]->type(),fi->params()[j]->type(),strictEnums)) {
-#ifdef MZN_DEBUG_FUNCTION_REGISTRY
-            std::cerr << c->args()[j]->type().toString(env) << " does not match "
-            << fi->params()[j]->type().toString(env) << "\n";
-            std::cerr << "Wrong argument is " << *c->args()[j];
-#endif
-            match=false;
-            break;
-          }
-          if (c->args()[j]->type().isbot() && fi->params()[j]->type().bt()!=Type::BT_TOP) {
-            botarg = c->args()[j];
-          }
-        }
-        if (match) {
-          if (botarg)
-            matched.push_back(fi);
-          else
-            return fi;
-        }
-      }
-    }
-    if (matched.empty())
-      return NULL;
-    if (matched.size()==1)
-      return matched[0];
-    Type t = matched[0]->ti()->type();
-    t.ti(Type::TI_PAR);
-    for (unsigned int i=1; i<matched.size(); i++) {
-      if (!env.isSubtype(t,matched[i]->ti()->type(),strictEnums))
-        throw TypeError(env, botarg->loc(), "ambiguous overloading on return type of function");
+    FnCacheKey k;
+    k.id = it->first;
+    k.t.resize(c->args().size());
+    for (unsigned int i=0; i<c->args().size(); i++)
+      k.t[i] = c->args()[i]->type().toInt();
+    k.strictEnums = strictEnums;
+    k.byType = false;
+    FunctionI* fi;
+    if (!m->fnCacheLookup(env, k, fi)) {
+      fi = matchArgs(env, it->second, c->args(), strictEnums);
+      m->fnCacheInsert(k, fi);
     }
-    return matched[0];
+    return fi;
   }
 
   Item*&
@@ -0,0 +1,77 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <minizinc/number_format.hh>
+
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace MiniZinc { namespace NumberFormat {
+
+  int intToChars(char* buf, long long int i) {
+    char tmp[24];
+    char* end = tmp+sizeof(tmp);
+    char* c = end;
+    unsigned long long int u = i < 0 ? 0ULL-static_cast<unsigned long long int>(i) : i;
+    do {
+      *--c = static_cast<char>('0' + u % 10);
+      u /= 10;
+    } while (u);
+    if (i < 0)
+      *--c = '-';
+    memcpy(buf, c, end-c);
+    return static_cast<int>(end-c);
+  }
+
+  int doubleToChars(char* buf, double d) {
+    // 15 significant digits are exact for every decimal of up to 15 digits, so
+    // %.15g is shortest whenever it reads back; 17 digits always do. Subnormal
+    // numbers have fewer digits and are tried from the shortest
+    const double absd = d < 0 ? -d : d;
+    for (int prec = (absd != 0.0 && absd < DBL_MIN) ? 1 : 15; prec < 17; prec++) {
+      int n = snprintf(buf, BUFSIZE, "%.*g", prec, d);
+      if (strtod(buf, NULL) == d)
+        return n;
+    }
+    return snprintf(buf, BUFSIZE, "%.17g", d);
+  }
+
+  std::string fixed(double d, int prec) {
+    char buf[BUFSIZE];
+    int n = snprintf(buf, sizeof(buf), "%.*f", prec, d);
+    if (n < static_cast<int>(sizeof(buf)))
+      return std::string(buf, n);
+    std::vector<char> big(n+1);
+    snprintf(big.data(), big.size(), "%.*f", prec, d);
+    return std::string(big.data(), n);
+  }
+
+  void append(std::string& s, long long int i) {
+    char buf[BUFSIZE];
+    s.append(buf, intToChars(buf, i));
+  }
+
+  void append(std::string& s, double d, bool fDot) {
+    char buf[BUFSIZE];
+    int n = doubleToChars(buf, d);
+    s.append(buf, n);
+    if (fDot && strpbrk(buf, ".e") == NULL)
+      s += ".0";
+  }
+
+}}
@@ -17,11 +17,112 @@
 #include <minizinc/flatten_internal.hh>
 #include <minizinc/eval_par.hh>
 #include <minizinc/optimize_constraints.hh>
+#include <minizinc/timer.hh>
 
 #include <vector>
+#include <cstring>
 
 namespace MiniZinc {
 
+  VarOccurrences::Items::Items(const Items& items)
+  : _n(0), _cap(_inlineCap), _index(NULL) {
+    *this = items;
+  }
+
+  VarOccurrences::Items&
+  VarOccurrences::Items::operator =(const Items& items) {
+    if (this != &items) {
+      if (items._n > _cap) {
+        if (_cap > _inlineCap)
+          delete[] _heap;
+        _heap = new Item*[items._n];
+        _cap = items._n;
+      }
+      _n = items._n;
+      if (_n > 0) {
+        Item* const* src = items._cap==_inlineCap ? items._inline : items._heap;
+        std::memcpy(data(), src, _n*sizeof(Item*));
+      }
+      delete _index;
+      _index = items._index ? new Index(*items._index) : NULL;
+    }
+    return *this;
+  }
+
+  VarOccurrences::Items::~Items(void) {
+    if (_cap > _inlineCap)
+      delete[] _heap;
+    delete _index;
+  }
+
+  int VarOccurrences::Items::find(Item* i) {
+    if (_index) {
+      Index::iterator it = _index->find(i);
+      return it==_index->end() ? -1 : static_cast<int>(it->second);
+    }
+    Item** d = data();
+    for (unsigned int k=0; k<_n; k++) {
+      if (d[k]==i)
+        return static_cast<int>(k);
+    }
+    return -1;
+  }
+
+  void VarOccurrences::Items::insert(Item* i) {
+    if (find(i) != -1)
+      return;
+    if (_n==_cap) {
+      unsigned int ncap = _cap*2;
+      Item** nd = new Item*[ncap];
+      std::memcpy(nd, data(), _n*sizeof(Item*));
+      if (_cap > _inlineCap)
+        delete[] _heap;
+      _heap = nd;
+      _cap = ncap;
+    }
+    data()[_n] = i;
+    if (_index) {
+      _index->insert(std::make_pair(i,_n));
+    } else if (_n+1 > _maxLinear) {
+      _index = new Index();
+      Item** d = data();
+      for (unsigned int k=0; k<=_n; k++)
+        _index->insert(std::make_pair(d[k],k));
+    }
+    _n++;
+  }
+
+  void VarOccurrences::Items::erase(Item* i) {
+    int pos = find(i);
+    if (pos == -1)
+      return;
+    Item** d = data();
+    _n--;
+    d[pos] = d[_n];
+    if (_index) {
+      _index->erase(i);
+      if (static_cast<unsigned int>(pos) != _n)
+        (*_index)[d[pos]] = pos;
+    }
+  }
+
+  void VarOccurrences::Items::eraseRemoved(void) {
+    Item** d = data();
+    unsigned int j=0;
+    for (unsigned int k=0; k<_n; k++) {
+      if (!d[k]->removed())
+        d[j++] = d[k];
+    }
+    if (j < _n) {
+      _n = j;
+      if (_index) {
+        _index->clear();
+        for (unsigned int k=0; k<_n; k++)
+          _index->insert(std::make_pair(d[k],k));
+      }
+    }
+  }
+
   void VarOccurrences::add(VarDeclI *i, int idx_i)
   {
     idx.insert(i->e()->id(), idx_i);
@@ -78,7 +179,8 @@ namespace MiniZinc {
       if (vi1 == _m.end()) {
         _m.insert(v1->id(), vi0->second);
       } else {
-        vi1->second.insert(vi0->second.begin(), vi0->second.end());
+        for (Items::iterator it = vi0->second.begin(); it != vi0->second.end(); ++it)
+          vi1->second.insert(*it);
       }
       _m.remove(v0->id());
     }
@@ -87,6 +189,12 @@ namespace MiniZinc {
     id0->redirect(id1);    
   }
   
+  void VarOccurrences::eraseRemoved(void) {
+    for (IdMap<Items>::iterator it = _m.begin(); it != _m.end(); ++it) {
+      it->second.eraseRemoved();
+    }
+  }
+  
   void VarOccurrences::clear(void) {
     _m.clear();
     idx.clear();
@@ -266,9 +374,15 @@ namespace MiniZinc {
     
   }
   
-  void optimize(Env& env) {
+  void propagateBounds(EnvI& env, std::vector<VarDecl*>& deletedVarDecls,
+                       const OptimizeOptions& opt, OptimizeStatistics& stats);
+
+  void optimize(Env& env, const OptimizeOptions& opt, OptimizeStatistics* stats) {
     if (env.envi().failed())
       return;
+    OptimizeStatistics localStats;
+    if (stats==NULL)
+      stats = &localStats;
     try {
       EnvI& envi = env.envi();
       Model& m = *envi.flat();
@@ -741,6 +855,12 @@ namespace MiniZinc {
 
       }
       
+      if (opt.propagateBounds && !envi.failed()) {
+        propagateBounds(envi, deletedVarDecls, opt, *stats);
+        if (envi.failed())
+          return;
+      }
+
       while (!deletedVarDecls.empty()) {
         VarDecl* cur = deletedVarDecls.back(); deletedVarDecls.pop_back();
         if (envi.vo.occurrences(cur) == 0) {
@@ -779,6 +899,404 @@ namespace MiniZinc {
     }
   }
 
+  /**
+   * \brief Worklist-based bounds propagation on the flat model
+   *
+   * Tightens the bounds of integer variables using the root-level
+   * constraints int_le, int_lt, int_lin_le, int_lin_eq and
+   * array_int_element. Bounds are kept in a separate table during
+   * propagation, since FlatZinc cannot represent half-bounded domains.
+   * Finite bounds are then written back into the variable domains, and
+   * constraints that are entailed by the new domains are removed.
+   */
+  class BoundsPropagator {
+  protected:
+    typedef UNORDERED_NAMESPACE::unordered_map<VarDecl*,std::pair<IntVal,IntVal> > BoundsMap;
+    EnvI& env;
+    std::vector<VarDecl*>& deletedVarDecls;
+    OptimizeStatistics& stats;
+    /// Constraints waiting to be propagated
+    std::vector<ConstraintI*> queue;
+    /// Current bounds of variables that have been tightened
+    BoundsMap bm;
+
+    /// Return call if \a ci is a constraint handled by the propagator
+    static Call* boundsCall(ConstraintI* ci) {
+      Call* c = Expression::dyn_cast<Call>(ci->e());
+      if (c==NULL)
+        return NULL;
+      if ((c->id()==constants().ids.int_.lin_le || c->id()==constants().ids.int_.lin_eq ||
+           c->id()==constants().ids.array_int_element) && c->args().size()==3)
+        return c;
+      if ((c->id()==constants().ids.int_.le || c->id()==constants().ids.int_.lt) &&
+          c->args().size()==2)
+        return c;
+      return NULL;
+    }
+    /// Add \a ci to the queue unless it is already queued
+    void push(ConstraintI* ci) {
+      if (!ci->removed() && !ci->flag() && boundsCall(ci)) {
+        ci->flag(true);
+        queue.push_back(ci);
+      }
+    }
+    /// Add all constraints in which \a vd occurs to the queue
+    void pushDependent(VarDecl* vd) {
+      IdMap<VarOccurrences::Items>::iterator it = env.vo._m.find(vd->id()->decl()->id());
+      if (it != env.vo._m.end()) {
+        for (VarOccurrences::Items::iterator item = it->second.begin(); item != it->second.end(); ++item) {
+          if (ConstraintI* ci = (*item)->dyn_cast<ConstraintI>())
+            push(ci);
+        }
+      }
+    }
+    /// Return integer variable declaration for \a e, or NULL if \a e is a literal
+    static VarDecl* intVar(Expression* e) {
+      if (Id* id = e->dyn_cast<Id>()) {
+        VarDecl* vd = id->decl()->id()->decl();
+        if (vd->type().isvar() && vd->type().isint() && vd->type().dim()==0 &&
+            !(vd->e() && vd->e()->isa<IntLit>()))
+          return vd;
+      }
+      return NULL;
+    }
+    /// Compute bounds of variable \a vd from its domain
+    void domainBounds(VarDecl* vd, IntVal& lb, IntVal& ub) {
+      if (vd->ti()->domain()) {
+        IntSetVal* dom = eval_intset(env, vd->ti()->domain());
+        lb = dom->min();
+        ub = dom->max();
+      } else {
+        lb = -IntVal::infinity();
+        ub = IntVal::infinity();
+      }
+    }
+    /// Compute bounds of \a e (a literal or an identifier)
+    void bounds(Expression* e, IntVal& lb, IntVal& ub) {
+      if (VarDecl* vd = intVar(e)) {
+        BoundsMap::iterator it = bm.find(vd);
+        if (it != bm.end()) {
+          lb = it->second.first;
+          ub = it->second.second;
+        } else {
+          domainBounds(vd, lb, ub);
+        }
+      } else {
+        lb = ub = eval_int(env, e);
+      }
+    }
+    /// Restrict \a e to the interval [\a lb,\a ub], return false on failure
+    bool tighten(Expression* e, IntVal lb, IntVal ub) {
+      VarDecl* vd = intVar(e);
+      if (vd==NULL) {
+        IntVal v = eval_int(env, e);
+        return lb <= v && v <= ub;
+      }
+      IntVal curLb, curUb;
+      bounds(e, curLb, curUb);
+      if (lb <= curLb && curUb <= ub)
+        return true;
+      lb = std::max(lb, curLb);
+      ub = std::min(ub, curUb);
+      if (lb > ub)
+        return false;
+      bm[vd] = std::make_pair(lb, ub);
+      pushDependent(vd);
+      return true;
+    }
+    /// Integer division rounding towards minus infinity
+    static IntVal floorDiv(IntVal a, IntVal b) {
+      long long int x = a.toInt();
+      long long int y = b.toInt();
+      long long int q = x / y;
+      if (x % y != 0 && ((x < 0) != (y < 0)))
+        q--;
+      return q;
+    }
+    /// Integer division rounding towards plus infinity
+    static IntVal ceilDiv(IntVal a, IntVal b) {
+      long long int x = a.toInt();
+      long long int y = b.toInt();
+      long long int q = x / y;
+      if (x % y != 0 && ((x < 0) == (y < 0)))
+        q++;
+      return q;
+    }
+    /// Compute bounds of sum(i in index_set(x))(\a sign * a[i]*x[i])
+    void linBounds(ArrayLit* a, ArrayLit* x, int sign,
+                   std::vector<IntVal>& coeff, std::vector<IntVal>& minTerm,
+                   IntVal& minSum, IntVal& maxSum,
+                   int& minInf, int& maxInf, unsigned int& minInfIdx) {
+      unsigned int n = x->v().size();
+      coeff.resize(n);
+      minTerm.resize(n);
+      minSum = 0;
+      maxSum = 0;
+      minInf = 0;
+      maxInf = 0;
+      minInfIdx = 0;
+      for (unsigned int i=0; i<n; i++) {
+        coeff[i] = eval_int(env, a->v()[i]) * sign;
+        minTerm[i] = 0;
+        if (coeff[i]==0)
+          continue;
+        IntVal lb, ub;
+        bounds(x->v()[i], lb, ub);
+        IntVal lo = coeff[i] > 0 ? lb : ub;
+        IntVal hi = coeff[i] > 0 ? ub : lb;
+        if (lo.isFinite()) {
+          minTerm[i] = coeff[i]*lo;
+          minSum += minTerm[i];
+        } else {
+          minInf++;
+          minInfIdx = i;
+        }
+        if (hi.isFinite()) {
+          maxSum += coeff[i]*hi;
+        } else {
+          maxInf++;
+        }
+      }
+    }
+    /// Propagate sum(i in index_set(x))(\a sign * a[i]*x[i]) <= \a sign * \a rhs
+    bool propagateLinLe(ArrayLit* a, ArrayLit* x, IntVal rhs, int sign) {
+      std::vector<IntVal> coeff;
+      std::vector<IntVal> minTerm;
+      IntVal minSum, maxSum;
+      int minInf, maxInf;
+      unsigned int minInfIdx;
+      linBounds(a, x, sign, coeff, minTerm, minSum, maxSum, minInf, maxInf, minInfIdx);
+      rhs = rhs * sign;
+      if (minInf==0 && minSum > rhs)
+        return false;
+      if (minInf > 1)
+        return true;
+      for (unsigned int i=0; i<coeff.size(); i++) {
+        if (coeff[i]==0 || intVar(x->v()[i])==NULL)
+          continue;
+        IntVal rest;
+        if (minInf==0) {
+          rest = minSum - minTerm[i];
+        } else if (minInfIdx==i) {
+          rest = minSum;
+        } else {
+          continue;
+        }
+        IntVal slack = rhs - rest;
+        bool ok = coeff[i] > 0 ?
+          tighten(x->v()[i], -IntVal::infinity(), floorDiv(slack, coeff[i])) :
+          tighten(x->v()[i], ceilDiv(slack, coeff[i]), IntVal::infinity());
+        if (!ok)
+          return false;
+      }
+      return true;
+    }
+    /// Propagate array_int_element(idx, a, res)
+    bool propagateElement(Call* c) {
+      Expression* idx = c->args()[0];
+      ArrayLit* a = eval_array_lit(env, c->args()[1]);
+      Expression* res = c->args()[2];
+      if (a->v().size()==0)
+        return false;
+      IntVal idxLb, idxUb, resLb, resUb;
+      bounds(idx, idxLb, idxUb);
+      bounds(res, resLb, resUb);
+      long long int n = a->v().size();
+      long long int first = idxLb.isFinite() ? std::max(idxLb.toInt(), 1LL) : 1LL;
+      long long int last = idxUb.isFinite() ? std::min(idxUb.toInt(), n) : n;
+      while (first <= last) {
+        IntVal v = eval_int(env, a->v()[first-1]);
+        if (resLb <= v && v <= resUb)
+          break;
+        first++;
+      }
+      while (last >= first) {
+        IntVal v = eval_int(env, a->v()[last-1]);
+        if (resLb <= v && v <= resUb)
+          break;
+        last--;
+      }
+      if (first > last || !tighten(idx, first, last))
+        return false;
+      IntVal vmin = IntVal::infinity();
+      IntVal vmax = -IntVal::infinity();
+      for (long long int i=first; i<=last; i++) {
+        IntVal v = eval_int(env, a->v()[i-1]);
+        vmin = std::min(vmin, v);
+        vmax = std::max(vmax, v);
+      }
+      return tighten(res, vmin, vmax);
+    }
+    /// Propagate \a c, return false on failure
+    bool propagate(Call* c) {
+      if (c->id()==constants().ids.array_int_element)
+        return propagateElement(c);
+      if (c->id()==constants().ids.int_.le || c->id()==constants().ids.int_.lt) {
+        // x <= y + offset
+        IntVal offset = c->id()==constants().ids.int_.lt ? -1 : 0;
+        IntVal xLb, xUb, yLb, yUb;
+        bounds(c->args()[0], xLb, xUb);
+        bounds(c->args()[1], yLb, yUb);
+        if (yUb.isFinite() && !tighten(c->args()[0], -IntVal::infinity(), yUb+offset))
+          return false;
+        return !xLb.isFinite() || tighten(c->args()[1], xLb-offset, IntVal::infinity());
+      }
+      ArrayLit* a = follow_id(c->args()[0])->cast<ArrayLit>();
+      ArrayLit* x = follow_id(c->args()[1])->cast<ArrayLit>();
+      IntVal rhs = eval_int(env, c->args()[2]);
+      if (!propagateLinLe(a, x, rhs, 1))
+        return false;
+      return c->id()!=constants().ids.int_.lin_eq || propagateLinLe(a, x, rhs, -1);
+    }
+    /// Check whether \a c is entailed by the variable domains
+    bool entailed(Call* c) {
+      if (c->id()==constants().ids.array_int_element) {
+        IntVal idxLb, idxUb, resLb, resUb;
+        bounds(c->args()[0], idxLb, idxUb);
+        bounds(c->args()[2], resLb, resUb);
+        if (idxLb != idxUb || resLb != resUb || !idxLb.isFinite())
+          return false;
+        ArrayLit* a = eval_array_lit(env, c->args()[1]);
+        if (idxLb < 1 || idxLb > a->v().size())
+          return false;
+        return eval_int(env, a->v()[idxLb.toInt()-1]) == resLb;
+      }
+      if (c->id()==constants().ids.int_.le || c->id()==constants().ids.int_.lt) {
+        IntVal offset = c->id()==constants().ids.int_.lt ? -1 : 0;
+        IntVal xLb, xUb, yLb, yUb;
+        bounds(c->args()[0], xLb, xUb);
+        bounds(c->args()[1], yLb, yUb);
+        return xUb.isFinite() && yLb.isFinite() && xUb <= yLb+offset;
+      }
+      ArrayLit* a = follow_id(c->args()[0])->cast<ArrayLit>();
+      ArrayLit* x = follow_id(c->args()[1])->cast<ArrayLit>();
+      IntVal rhs = eval_int(env, c->args()[2]);
+      std::vector<IntVal> coeff;
+      std::vector<IntVal> minTerm;
+      IntVal minSum, maxSum;
+      int minInf, maxInf;
+      unsigned int minInfIdx;
+      linBounds(a, x, 1, coeff, minTerm, minSum, maxSum, minInf, maxInf, minInfIdx);
+      if (maxInf > 0 || maxSum > rhs)
+        return false;
+      return c->id()==constants().ids.int_.lin_le || (minInf==0 && minSum==rhs);
+    }
+    /// Write finite bounds back into the variable domains, return false on failure
+    bool updateDomains(void) {
+      for (BoundsMap::iterator it = bm.begin(); it != bm.end(); ++it) {
+        VarDecl* vd = it->first;
+        IntVal lb = it->second.first;
+        IntVal ub = it->second.second;
+        // FlatZinc cannot represent half-bounded domains
+        if (!lb.isFinite() || !ub.isFinite())
+          continue;
+        IntVal curLb, curUb;
+        domainBounds(vd, curLb, curUb);
+        IntSetVal* nd;
+        if (vd->ti()->domain()) {
+          IntSetVal* dom = eval_intset(env, vd->ti()->domain());
+          IntSetRanges dr(dom);
+          IntSetVal* r = IntSetVal::a(lb, ub);
+          IntSetRanges rr(r);
+          Ranges::Inter<IntVal,IntSetRanges,IntSetRanges> inter(dr, rr);
+          nd = IntSetVal::ai(inter);
+        } else {
+          nd = IntSetVal::a(lb, ub);
+        }
+        if (nd->size()==0)
+          return false;
+        if (nd->min()==curLb && nd->max()==curUb)
+          continue;
+        vd->ti()->domain(new SetLit(Location().introduce(), nd));
+        vd->ti()->setComputedDomain(false);
+        stats.n_tightened_domains++;
+      }
+      bm.clear();
+      return true;
+    }
+    /// Remove entailed constraint \a ci from the flat model
+    void removeEntailed(ConstraintI* ci) {
+      Call* c = ci->e()->cast<Call>();
+      for (ExpressionSetIter it = c->ann().begin(); it != c->ann().end(); ++it) {
+        if (Call* defines = Expression::dyn_cast<Call>(*it)) {
+          if (defines->id()==constants().ann.defines_var) {
+            if (Id* ident = defines->args()[0]->dyn_cast<Id>())
+              ident->decl()->ann().remove(constants().ann.is_defined_var);
+          }
+        }
+      }
+      CollectDecls cd(env.vo, deletedVarDecls, ci);
+      topDown(cd, c);
+      env.flat_removeItem(ci);
+      stats.n_removed_ct++;
+    }
+  public:
+    BoundsPropagator(EnvI& env0, std::vector<VarDecl*>& deletedVarDecls0,
+                     OptimizeStatistics& stats0)
+    : env(env0), deletedVarDecls(deletedVarDecls0), stats(stats0) {}
+    /// Run propagation until fixpoint or until a limit is reached
+    void run(const OptimizeOptions& opt) {
+      GCLock lock;
+      Timer timer;
+      Model& m = *env.flat();
+      std::vector<ConstraintI*> candidates;
+      for (unsigned int i=0; i<m.size(); i++) {
+        if (ConstraintI* ci = m[i]->dyn_cast<ConstraintI>()) {
+          ci->flag(false);
+          push(ci);
+        }
+      }
+      candidates = queue;
+      unsigned int limit = opt.boundsPropagationLimit;
+      if (limit==0)
+        limit = 10*static_cast<unsigned int>(queue.size());
+      unsigned int n_propagations = 0;
+      bool failed = false;
+      while (!queue.empty()) {
+        if (n_propagations >= limit ||
+            (opt.boundsPropagationTime > 0.0 && (n_propagations & 0x3f)==0 &&
+             timer.ms() > opt.boundsPropagationTime)) {
+          stats.limit_reached = true;
+          break;
+        }
+        ConstraintI* ci = queue.back();
+        queue.pop_back();
+        ci->flag(false);
+        n_propagations++;
+        try {
+          if (!propagate(boundsCall(ci))) {
+            failed = true;
+            break;
+          }
+        } catch (ArithmeticError&) {
+          // overflow while computing bounds: leave constraint untouched
+        }
+      }
+      for (unsigned int i=0; i<queue.size(); i++)
+        queue[i]->flag(false);
+      stats.n_propagations += n_propagations;
+      if (failed || !updateDomains()) {
+        env.fail();
+        return;
+      }
+      for (unsigned int i=0; i<candidates.size(); i++) {
+        if (candidates[i]->removed())
+          continue;
+        try {
+          if (entailed(boundsCall(candidates[i])))
+            removeEntailed(candidates[i]);
+        } catch (ArithmeticError&) {
+        }
+      }
+    }
+  };
+
+  void propagateBounds(EnvI& env, std::vector<VarDecl*>& deletedVarDecls,
+                       const OptimizeOptions& opt, OptimizeStatistics& stats) {
+    BoundsPropagator bp(env, deletedVarDecls, stats);
+    bp.run(opt);
+  }
+
   class SubstitutionVisitor : public EVisitor {
   protected:
     std::vector<VarDecl*> removed;
@@ -809,6 +1327,7 @@ namespace MiniZinc {
       for (unsigned int i=0; i<al.v().size(); i++) {
         al.v()[i] = subst(al.v()[i]);
       }
+      const_cast<ArrayLit&>(al).invalidateFingerprint();
     }
     /// Visit call
     void vCall(const Call& c) {
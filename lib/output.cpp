@@ -439,19 +439,7 @@ namespace MiniZinc {
       }
     }
     
-    for (IdMap<VarOccurrences::Items>::iterator it = e.output_vo._m.begin();
-         it != e.output_vo._m.end(); ++it) {
-      std::vector<Item*> toRemove;
-      for (VarOccurrences::Items::iterator iit = it->second.begin();
-           iit != it->second.end(); ++iit) {
-        if ((*iit)->removed()) {
-          toRemove.push_back(*iit);
-        }
-      }
-      for (unsigned int i=0; i<toRemove.size(); i++) {
-        it->second.erase(toRemove[i]);
-      }
-    }
+    e.output_vo.eraseRemoved();
   }
   
   void createDznOutput(EnvI& e) {
@@ -0,0 +1,146 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+
+#include <minizinc/phase_profile.hh>
+#include <minizinc/gc.hh>
+#include <minizinc/number_format.hh>
+
+namespace MiniZinc {
+
+  namespace {
+    std::string jsonString(const std::string& s) {
+      std::string r = "\"";
+      for (unsigned int i=0; i<s.size(); i++) {
+        switch (s[i]) {
+          case '"': r += "\\\""; break;
+          case '\\': r += "\\\\"; break;
+          case '\n': r += "\\n"; break;
+          case '\t': r += "\\t"; break;
+          default: r += s[i];
+        }
+      }
+      return r + "\"";
+    }
+    double cpuMs(std::clock_t c) {
+      return static_cast<double>(c) * 1000.0 / CLOCKS_PER_SEC;
+    }
+  }
+
+  PhaseProfile::PhaseProfile(void)
+    : _cpuStart(std::clock()), _gcCollectionsStart(GC::collections()),
+      _gcMsStart(GC::collectionTime()), _cpu(_cpuStart),
+      _gcCollections(_gcCollectionsStart), _gcMs(_gcMsStart),
+      _heapPeak(GC::peakMem()) {
+    GC::resetPeakMem();
+  }
+
+  void
+  PhaseProfile::sample(void) {
+    std::clock_t cpu = std::clock();
+    unsigned long int gcCollections = GC::collections();
+    double gcMs = GC::collectionTime();
+    size_t heapPeak = GC::peakMem();
+    _heapPeak = std::max(_heapPeak, heapPeak);
+    if (!_running.empty()) {
+      Phase& p = _phases[_running.back()];
+      p.wallMs += _wall.ms();
+      p.cpuMs += cpuMs(cpu-_cpu);
+      p.gcCollections += gcCollections-_gcCollections;
+      p.gcMs += gcMs-_gcMs;
+      p.heapPeak = std::max(p.heapPeak, heapPeak);
+      p.heap = GC::allocedMem();
+    }
+    _wall.reset();
+    _cpu = cpu;
+    _gcCollections = gcCollections;
+    _gcMs = gcMs;
+    GC::resetPeakMem();
+  }
+
+  size_t
+  PhaseProfile::heapPeak(void) const {
+    return std::max(_heapPeak, GC::peakMem());
+  }
+
+  void
+  PhaseProfile::start(const std::string& name) {
+    sample();
+    unsigned int i = 0;
+    while (i < _phases.size() && _phases[i].name != name)
+      i++;
+    if (i == _phases.size()) {
+      _phases.push_back(Phase());
+      _phases.back().name = name;
+    }
+    _phases[i].count++;
+    _running.push_back(i);
+  }
+
+  void
+  PhaseProfile::stop(const Model* m) {
+    if (_running.empty())
+      return;
+    sample();
+    Phase& p = _phases[_running.back()];
+    _running.pop_back();
+    if (m) {
+      p.items = p.vars = p.constraints = 0;
+      for (unsigned int i=0; i<m->size(); i++) {
+        const Item* item = (*m)[i];
+        if (item->removed())
+          continue;
+        p.items++;
+        if (item->isa<VarDeclI>())
+          p.vars++;
+        else if (item->isa<ConstraintI>())
+          p.constraints++;
+      }
+    }
+  }
+
+  void
+  PhaseProfile::stopAll(void) {
+    while (!_running.empty())
+      stop();
+  }
+
+  void
+  PhaseProfile::printJSON(std::ostream& os) const {
+    os << "{\n  \"phases\": [";
+    for (unsigned int i=0; i<_phases.size(); i++) {
+      const Phase& p = _phases[i];
+      os << (i==0 ? "\n" : ",\n")
+         << "    {\"name\": " << jsonString(p.name)
+         << ", \"count\": " << p.count
+         << ", \"wall_ms\": " << NumberFormat::fixed(p.wallMs, 3)
+         << ", \"cpu_ms\": " << NumberFormat::fixed(p.cpuMs, 3)
+         << ", \"gc_collections\": " << p.gcCollections
+         << ", \"gc_ms\": " << NumberFormat::fixed(p.gcMs, 3)
+         << ", \"heap_peak_bytes\": " << p.heapPeak
+         << ", \"heap_bytes\": " << p.heap;
+      if (p.items >= 0)
+        os << ", \"items\": " << p.items
+           << ", \"vars\": " << p.vars
+           << ", \"constraints\": " << p.constraints;
+      os << "}";
+    }
+    os << "\n  ],\n"
+       << "  \"total\": {\"wall_ms\": " << NumberFormat::fixed(_total.ms(), 3)
+       << ", \"cpu_ms\": " << NumberFormat::fixed(cpuMs(std::clock()-_cpuStart), 3)
+       << ", \"gc_collections\": " << GC::collections()-_gcCollectionsStart
+       << ", \"gc_ms\": " << NumberFormat::fixed(GC::collectionTime()-_gcMsStart, 3)
+       << ", \"heap_peak_bytes\": " << GC::maxMem() << "}\n"
+       << "}\n";
+  }
+
+}
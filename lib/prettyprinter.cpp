@@ -17,6 +17,7 @@
 #include <iomanip>
 #include <map>
 #include <minizinc/prettyprinter.hh>
+#include <minizinc/number_format.hh>
 #include <minizinc/model.hh>
 #include <minizinc/astexception.hh>
 #include <minizinc/iter.hh>
@@ -168,11 +169,10 @@ namespace MiniZinc {
         oss << fv.toDouble();
         os << oss.str();
       } else {
-        oss << std::setprecision(std::numeric_limits<double>::digits10+1);
-        oss << fv;
-        if (oss.str().find("e") == std::string::npos && oss.str().find(".") == std::string::npos)
-          oss << ".0";
-        os << oss.str();
+        // shortest form which reads back exactly
+        std::string s;
+        NumberFormat::append(s, fv.toDouble(), true);
+        os << s;
       }
     } else {
       if (fv.isPlusInfinity())
@@ -225,7 +225,15 @@ namespace MiniZinc {
         return;
       switch (e->eid()) {
       case Expression::E_INTLIT:
-        os << e->cast<IntLit>()->v();
+        {
+          const IntVal& v = e->cast<IntLit>()->v();
+          if (v.isFinite()) {
+            char buf[NumberFormat::BUFSIZE];
+            os.write(buf, NumberFormat::intToChars(buf, v.toInt()));
+          } else {
+            os << v;
+          }
+        }
         break;
       case Expression::E_FLOATLIT:
         {
@@ -706,6 +714,272 @@ namespace MiniZinc {
 
  
 
+  FznPrinter::FznPrinter(std::ostream& os, bool printRemoved)
+    : _os(&os), _printRemoved(printRemoved) {
+    _buf.reserve(1<<16);
+  }
+  FznPrinter::FznPrinter(bool printRemoved)
+    : _os(NULL), _printRemoved(printRemoved) {
+    _buf.reserve(1<<16);
+  }
+  FznPrinter::~FznPrinter(void) {
+    flush();
+  }
+
+  void
+  FznPrinter::flush(void) {
+    if (_os && !_buf.empty()) {
+      _os->write(_buf.data(), _buf.size());
+      _buf.clear();
+    }
+  }
+
+  void
+  FznPrinter::pInt(long long int i) {
+    NumberFormat::append(_buf, i);
+  }
+
+  void
+  FznPrinter::pIntVal(const IntVal& i) {
+    if (i.isFinite())
+      pInt(i.toInt());
+    else
+      _buf += i.isPlusInfinity() ? "infinity" : "-infinity";
+  }
+
+  void
+  FznPrinter::pFloatVal(const FloatVal& f) {
+    if (!f.isFinite()) {
+      _buf += f.isPlusInfinity() ? "infinity" : "-infinity";
+      return;
+    }
+    NumberFormat::append(_buf, f.toDouble(), true);
+  }
+
+  void
+  FznPrinter::pId(const Id* id) {
+    if (id->idn() == -1) {
+      _buf.append(id->v().c_str(), id->v().size());
+    } else {
+      _buf += "X_INTRODUCED_";
+      pInt(id->idn());
+      _buf += '_';
+    }
+  }
+
+  void
+  FznPrinter::fallback(const Expression* e) {
+    std::ostringstream oss;
+    PlainPrinter pp(oss, true);
+    pp.p(e);
+    _buf += oss.str();
+  }
+
+  void
+  FznPrinter::p(const Annotation& ann) {
+    for (ExpressionSetIter it = ann.begin(); it != ann.end(); ++it) {
+      _buf += ":: ";
+      p(*it);
+    }
+  }
+
+  void
+  FznPrinter::p(const Type& type, const Expression* e) {
+    if (type.ti() == Type::TI_VAR)
+      _buf += "var ";
+    if (type.ot() == Type::OT_OPTIONAL)
+      _buf += "opt ";
+    if (type.st() == Type::ST_SET)
+      _buf += "set of ";
+    if (e == NULL) {
+      switch (type.bt()) {
+      case Type::BT_INT: _buf += "int"; break;
+      case Type::BT_BOOL: _buf += "bool"; break;
+      case Type::BT_FLOAT: _buf += "float"; break;
+      case Type::BT_STRING: _buf += "string"; break;
+      case Type::BT_ANN: _buf += "ann"; break;
+      case Type::BT_BOT: _buf += "bot"; break;
+      case Type::BT_TOP: _buf += "top"; break;
+      case Type::BT_UNKNOWN: _buf += "???"; break;
+      }
+    } else {
+      p(e);
+    }
+  }
+
+  void
+  FznPrinter::p(const Expression* e) {
+    if (e==NULL)
+      return;
+    switch (e->eid()) {
+    case Expression::E_INTLIT:
+      pIntVal(e->cast<IntLit>()->v());
+      break;
+    case Expression::E_FLOATLIT:
+      pFloatVal(e->cast<FloatLit>()->v());
+      break;
+    case Expression::E_BOOLLIT:
+      _buf += e->cast<BoolLit>()->v() ? "true" : "false";
+      break;
+    case Expression::E_ID:
+      if (e==constants().absent)
+        _buf += "<>";
+      else
+        pId(e->cast<Id>());
+      break;
+    case Expression::E_SETLIT:
+      {
+        const IntSetVal* isv = e->cast<SetLit>()->isv();
+        if (isv == NULL || (isv->size() > 1 && !(isv->min(0).isFinite()
+                                                && isv->max(isv->size()-1).isFinite()))) {
+          fallback(e);
+          return;
+        }
+        if (isv->size()==0) {
+          _buf += "1..0";
+        } else if (isv->size()==1) {
+          pIntVal(isv->min(0));
+          _buf += "..";
+          pIntVal(isv->max(0));
+        } else {
+          _buf += '{';
+          for (IntSetRanges isr(isv); isr();) {
+            for (IntVal i=isr.min(); i<=isr.max(); i++) {
+              pInt(i.toInt());
+              if (i<isr.max())
+                _buf += ',';
+            }
+            ++isr;
+            if (isr())
+              _buf += ',';
+          }
+          _buf += '}';
+        }
+      }
+      break;
+    case Expression::E_ARRAYLIT:
+      {
+        const ArrayLit& al = *e->cast<ArrayLit>();
+        if (al.dims() != 1 || al.min(0) != 1) {
+          fallback(e);
+          return;
+        }
+        _buf += '[';
+        for (unsigned int i = 0; i < al.v().size(); i++) {
+          if (i > 0)
+            _buf += ',';
+          p(al.v()[i]);
+        }
+        _buf += ']';
+      }
+      break;
+    case Expression::E_CALL:
+      {
+        const Call& c = *e->cast<Call>();
+        _buf.append(c.id().c_str(), c.id().size());
+        _buf += '(';
+        for (unsigned int i = 0; i < c.args().size(); i++) {
+          if (i > 0)
+            _buf += ',';
+          p(c.args()[i]);
+        }
+        _buf += ')';
+      }
+      break;
+    case Expression::E_VARDECL:
+      {
+        const VarDecl& vd = *e->cast<VarDecl>();
+        p(vd.ti());
+        if (vd.id()->idn() != -1 || vd.id()->v().size() != 0) {
+          _buf += ": ";
+          pId(vd.id());
+        }
+        if (vd.introduced())
+          _buf += " ::var_is_introduced ";
+        p(vd.ann());
+        if (vd.e()) {
+          _buf += " = ";
+          p(vd.e());
+        }
+      }
+      return;
+    case Expression::E_TI:
+      {
+        const TypeInst& ti = *e->cast<TypeInst>();
+        if (ti.isarray()) {
+          _buf += "array [";
+          for (unsigned int i = 0; i < ti.ranges().size(); i++) {
+            if (i > 0)
+              _buf += ',';
+            p(Type::parint(), ti.ranges()[i]);
+          }
+          _buf += "] of ";
+        }
+        p(ti.type(), ti.domain());
+      }
+      break;
+    default:
+      fallback(e);
+      return;
+    }
+    p(e->ann());
+  }
+
+  void
+  FznPrinter::print(const Item* i) {
+    if (i==NULL || (i->removed() && !_printRemoved))
+      return;
+    switch (i->iid()) {
+    case Item::II_VD:
+    case Item::II_CON:
+    case Item::II_SOL:
+      break;
+    default:
+      {
+        std::ostringstream oss;
+        PlainPrinter pp(oss, true);
+        pp.p(i);
+        _buf += oss.str();
+      }
+      return;
+    }
+    if (i->removed())
+      _buf += "% ";
+    if (const VarDeclI* vdi = i->dyn_cast<VarDeclI>()) {
+      p(vdi->e());
+    } else if (const ConstraintI* ci = i->dyn_cast<ConstraintI>()) {
+      _buf += "constraint ";
+      p(ci->e());
+    } else {
+      const SolveI* si = i->cast<SolveI>();
+      _buf += "solve ";
+      p(si->ann());
+      switch (si->st()) {
+      case SolveI::ST_SAT:
+        _buf += " satisfy";
+        break;
+      case SolveI::ST_MIN:
+        _buf += " minimize ";
+        p(si->e());
+        break;
+      case SolveI::ST_MAX:
+        _buf += " maximize ";
+        p(si->e());
+        break;
+      }
+    }
+    _buf += ";\n";
+    if (_os && _buf.size() >= (1<<16))
+      flush();
+  }
+
+  void
+  FznPrinter::print(const Model* m) {
+    for (unsigned int i = 0; i < m->size(); i++)
+      print((*m)[i]);
+    flush();
+  }
+
   template<class T>
   class ExpressionMapper {
   protected:
@@ -17,10 +17,210 @@
 
 #include <minizinc/solns2out.hh>
 #include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <queue>
 
 using namespace std;
 using namespace MiniZinc;
 
+namespace {
+  inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+  }
+  inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+  }
+  /// Reads one sorted run of a spill file, through a buffer of its own
+  class RunReader {
+  public:
+    RunReader(void) : _pos(0), _end(0), _iBuf(0) {}
+    RunReader(long pos, long end) : _pos(pos), _end(end), _iBuf(0) {}
+    /// Reads a text written by writeRecord, returns false at the end of the run
+    bool readRecord(FILE* f, string& s) {
+      uint64_t n;
+      if (!read(f, reinterpret_cast<char*>(&n), sizeof(n)))
+        return false;
+      s.resize(n);
+      return n==0 || read(f, &s[0], n);
+    }
+  private:
+    long _pos, _end;
+    vector<char> _buf;
+    size_t _iBuf;
+    bool read(FILE* f, char* p, size_t n) {
+      while (n > 0) {
+        if (_iBuf == _buf.size()) {
+          if (_pos >= _end)
+            return false;
+          _buf.resize(static_cast<size_t>(min(_end-_pos, 1L<<16)));
+          _iBuf = 0;
+          if (fseek(f, _pos, SEEK_SET) != 0 || fread(&_buf[0], 1, _buf.size(), f) != _buf.size())
+            return false;
+          _pos += static_cast<long>(_buf.size());
+        }
+        size_t k = min(n, _buf.size()-_iBuf);
+        memcpy(p, &_buf[_iBuf], k);
+        _iBuf += k;
+        p += k;
+        n -= k;
+      }
+      return true;
+    }
+  };
+  void writeRecord(FILE* f, const string& s) {
+    uint64_t n = s.size();
+    checkIOStatus( fwrite(&n, sizeof(n), 1, f) == 1 && (n == 0 || fwrite(s.data(), 1, n, f) == n),
+                   "solns2out: cannot write solutions to temporary file" );
+  }
+}
+
+SolutionSet::SolutionSet(bool fKeep, size_t bufferLimit)
+  : _fKeep(fKeep), _bufferLimit(bufferLimit), _bufferSize(0), _runFile(NULL) {}
+
+SolutionSet::~SolutionSet(void) {
+  if (_runFile)
+    fclose(_runFile);
+}
+
+/// MurmurHash3, x64 128-bit variant, seed 0
+SolutionSet::Hash128 SolutionSet::hash(const string& s) {
+  const unsigned char* data = reinterpret_cast<const unsigned char*>(s.data());
+  const size_t len = s.size();
+  const size_t nblocks = len / 16;
+  const uint64_t c1 = 0x87c37b91114253d5ULL;
+  const uint64_t c2 = 0x4cf5ad432745937fULL;
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+  for (size_t i=0; i<nblocks; i++) {
+    uint64_t k1, k2;
+    memcpy(&k1, data+i*16, 8);
+    memcpy(&k2, data+i*16+8, 8);
+    k1 *= c1; k1 = rotl64(k1,31); k1 *= c2; h1 ^= k1;
+    h1 = rotl64(h1,27); h1 += h2; h1 = h1*5+0x52dce729;
+    k2 *= c2; k2 = rotl64(k2,33); k2 *= c1; h2 ^= k2;
+    h2 = rotl64(h2,31); h2 += h1; h2 = h2*5+0x38495ab5;
+  }
+  const unsigned char* tail = data + nblocks*16;
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  switch (len & 15) {
+    case 15: k2 ^= uint64_t(tail[14]) << 48;
+    case 14: k2 ^= uint64_t(tail[13]) << 40;
+    case 13: k2 ^= uint64_t(tail[12]) << 32;
+    case 12: k2 ^= uint64_t(tail[11]) << 24;
+    case 11: k2 ^= uint64_t(tail[10]) << 16;
+    case 10: k2 ^= uint64_t(tail[ 9]) << 8;
+    case  9: k2 ^= uint64_t(tail[ 8]) << 0;
+      k2 *= c2; k2 = rotl64(k2,33); k2 *= c1; h2 ^= k2;
+    case  8: k1 ^= uint64_t(tail[ 7]) << 56;
+    case  7: k1 ^= uint64_t(tail[ 6]) << 48;
+    case  6: k1 ^= uint64_t(tail[ 5]) << 40;
+    case  5: k1 ^= uint64_t(tail[ 4]) << 32;
+    case  4: k1 ^= uint64_t(tail[ 3]) << 24;
+    case  3: k1 ^= uint64_t(tail[ 2]) << 16;
+    case  2: k1 ^= uint64_t(tail[ 1]) << 8;
+    case  1: k1 ^= uint64_t(tail[ 0]) << 0;
+      k1 *= c1; k1 = rotl64(k1,31); k1 *= c2; h1 ^= k1;
+  }
+  h1 ^= len; h2 ^= len;
+  h1 += h2; h2 += h1;
+  h1 = fmix64(h1); h2 = fmix64(h2);
+  h1 += h2; h2 += h1;
+  Hash128 h;
+  h.h1 = h1;
+  h.h2 = h2;
+  return h;
+}
+
+bool SolutionSet::insert(const string& s) {
+  if (!_hashes.insert(hash(s)).second)
+    return false;
+  if (_fKeep) {
+    _buffer.push_back(s);
+    _bufferSize += s.size();
+    if (_bufferLimit > 0 && _bufferSize > _bufferLimit)
+      spill();
+  }
+  return true;
+}
+
+void SolutionSet::spill(void) {
+  if (_runFile == NULL) {
+    _runFile = tmpfile();
+    checkIOStatus( _runFile != NULL, "solns2out: cannot create temporary file for solutions" );
+    _runStarts.push_back(0);
+  }
+  // Append after any reads by printSorted()
+  checkIOStatus( fseek(_runFile, _runStarts.back(), SEEK_SET) == 0,
+                 "solns2out: cannot write solutions to temporary file" );
+  sort(_buffer.begin(), _buffer.end());
+  for (unsigned int i=0; i<_buffer.size(); i++)
+    writeRecord(_runFile, _buffer[i]);
+  long end = ftell(_runFile);
+  checkIOStatus( fflush(_runFile) == 0 && end >= 0,
+                 "solns2out: cannot write solutions to temporary file" );
+  _runStarts.push_back(end);
+  _buffer.clear();
+  _bufferSize = 0;
+}
+
+void SolutionSet::printSorted(ostream& os, const string& comma) {
+  sort(_buffer.begin(), _buffer.end());
+  if (_runFile == NULL) {
+    for (unsigned int i=0; i<_buffer.size(); i++) {
+      if (comma.size() && i > 0)
+        os << comma << '\n';
+      os << _buffer[i];
+    }
+    return;
+  }
+  /// Merge the runs and the buffer; the texts are distinct
+  const unsigned int nRuns = static_cast<unsigned int>(_runStarts.size()-1);
+  vector<RunReader> readers(nRuns);
+  vector<string> heads(nRuns+1);
+  typedef pair<const string*,unsigned int> Head;
+  struct Greater {
+    bool operator ()(const Head& a, const Head& b) const { return *a.first > *b.first; }
+  };
+  priority_queue<Head,vector<Head>,Greater> queue;
+  for (unsigned int i=0; i<nRuns; i++) {
+    readers[i] = RunReader(_runStarts[i], _runStarts[i+1]);
+    if (readers[i].readRecord(_runFile, heads[i]))
+      queue.push(Head(&heads[i], i));
+  }
+  unsigned int iBuffer = 0;
+  const unsigned int bufferRun = nRuns;
+  if (iBuffer < _buffer.size()) {
+    heads[bufferRun] = _buffer[iBuffer++];
+    queue.push(Head(&heads[bufferRun], bufferRun));
+  }
+  bool fFirst = true;
+  while (!queue.empty()) {
+    unsigned int run = queue.top().second;
+    queue.pop();
+    if (comma.size() && !fFirst)
+      os << comma << '\n';
+    fFirst = false;
+    os << heads[run];
+    bool fMore;
+    if (run == bufferRun) {
+      fMore = iBuffer < _buffer.size();
+      if (fMore)
+        heads[run] = _buffer[iBuffer++];
+    } else {
+      fMore = readers[run].readRecord(_runFile, heads[run]);
+    }
+    if (fMore)
+      queue.push(Head(&heads[run], run));
+  }
+}
+
 
 void Solns2Out::printHelp(ostream& os)
 {
@@ -35,8 +235,9 @@ void Solns2Out::printHelp(ostream& os)
   "    Specify solution status messages. The defaults:\n"
   "    \"=====UNSATISFIABLE=====\", \"=====UNSATorUNBOUNDED=====\", \"=====UNBOUNDED=====\",\n"
   "    \"=====UNKNOWN=====\", \"=====ERROR=====\", \"==========\", respectively." << std::endl
-  << "  --unique\n    Avoid duplicate solutions.\n"
+  << "  --unique\n    Avoid duplicate solutions (recognised by 128-bit hashes).\n"
   << "  -c, --canonicalize\n    Canonicalize the output solution stream (i.e., buffer and sort).\n"
+  << "  --canonicalize-buffer <MB>\n    Keep at most <MB> megabytes (possibly fractional) of solutions in memory for\n    canonicalization and sort the rest in temporary files. The default, 0, is no limit.\n"
   << "  --output-non-canonical <file>\n    Non-buffered solution output file in case of canonicalization.\n"
   << "  --output-raw <file>\n    File to dump the solver's raw output (not for hard-linked solvers)\n"
   // Unclear how to exit then:
@@ -71,6 +272,7 @@ bool Solns2Out::processOption(int& i, const int argc, const char** argv)
     _opt.flag_unique = true;
   } else if ( cop.getOption( "-c --canonicalize") ) {
     _opt.flag_canonicalize = true;
+  } else if ( cop.getOption( "--canonicalize-buffer", &_opt.flag_canonicalize_buffer) ) {
   } else if ( cop.getOption( "--output-non-canonical", &_opt.flag_output_noncanonical) ) {
   } else if ( cop.getOption( "--output-raw", &_opt.flag_output_raw) ) {
 //   } else if ( cop.getOption( "--number-output", &_opt.flag_number_output ) ) {
@@ -170,9 +372,8 @@ bool Solns2Out::evalOutput() {
   ostringstream oss;
   if (!__evalOutput( oss, false ))
     return false;
-  if ( _opt.flag_unique || _opt.flag_canonicalize ) {
-    auto res = sSolsCanon.insert( oss.str() );
-    if ( !res.second )            // repeated solution
+  if ( pSolsCanon.get() ) {
+    if ( !pSolsCanon->insert( oss.str() ) )   // repeated solution
       return true;
   }
   ++nSolns;
@@ -240,11 +441,8 @@ bool Solns2Out::evalStatus( SolverInstance::Status status ) {
 
 bool Solns2Out::__evalOutputFinal( bool ) {
   /// Print the canonical list
-  for ( auto& sol : sSolsCanon ) {
-    if ( _opt.solution_comma.size() && &sol != &*sSolsCanon.begin() )
-      getOutput() << _opt.solution_comma << '\n';
-    getOutput() << sol;
-  }
+  if ( pSolsCanon.get() )
+    pSolsCanon->printSorted( getOutput(), _opt.solution_comma );
   return true;
 }
 
@@ -295,6 +493,11 @@ void Solns2Out::init() {
       checkIOStatus( pOut->good(), _opt.flag_output_file);
     }
   }
+  /// Duplicate detection, and the solutions to sort
+  if ( ( _opt.flag_unique || _opt.flag_canonicalize ) && 0==pSolsCanon ) {
+    pSolsCanon.reset( new SolutionSet( _opt.flag_canonicalize,
+                                       size_t(std::max(0.0, _opt.flag_canonicalize_buffer) * (1 << 20)) ) );
+  }
   /// Non-canonical output
   if ( _opt.flag_canonicalize && _opt.flag_output_noncanonical.size() ) {
     pOfs_non_canon.reset( new ofstream( _opt.flag_output_noncanonical ) );
@@ -817,6 +817,7 @@ namespace MiniZinc {
         for (unsigned int i=0; i<al.v().size(); i++) {
           al.v()[i] = addCoercion(_env, _model, al.v()[i], at)();
         }
+        al.invalidateFingerprint();
       }
       if (ty.enumId() != 0) {
         std::vector<unsigned int> enumIds(ty.dim()+1);
@@ -1420,7 +1421,15 @@ namespace MiniZinc {
           bu_ty.run(functionItems[i]->params()[j]);
       }
     }
+    // all function signatures are now typed, so overload resolution is stable
+    m->enableFnCache();
     
+    // Items are typechecked sequentially on purpose. The Typer allocates
+    // coercions and array enums through the thread-local GC and the shared
+    // EnvI, assigns types in place, and resolves calls through the model's
+    // overload cache, so none of this is safe to run concurrently. With the
+    // full standard library this phase takes a few milliseconds, which is
+    // less than the cost of starting worker threads.
     {
       Typer<true> ty(env.envi(), m, typeErrors);
       BottomUpIterator<Typer<true> > bu_ty(ty);
@@ -0,0 +1,402 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Test of the LNS driver with a solver instance which enumerates all
+ * assignments of the flat model instead of a real solver.
+ *
+ * Flattens small knapsack models and runs LNS on them. Checks that the
+ * temporary fixings agree with the incumbent, that every printed solution
+ * improves on the one before, that each objective bound becomes a permanent
+ * constraint and that the node limit of each iteration reaches the solver.
+ * With a node limit above the size of the search space, the run must end
+ * with the optimum, found by enumeration, proved. A satisfaction problem
+ * stops after the first solution. Exits with 1 if any check fails.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <minizinc/eval_par.hh>
+#include <minizinc/lns.hh>
+#include <minizinc/solver.hh>
+
+using namespace std;
+using namespace MiniZinc;
+
+namespace {
+
+  int nErrors = 0;
+
+  void check(bool fOk, const string& what) {
+    if (!fOk && ++nErrors <= 20)
+      cerr << "lns_test: " << what << endl;
+  }
+
+  /// Searches all assignments of the flat variables in lexicographic order.
+  /// Knows the few constraints the test models flatten to
+  class EnumSolverInstance : public SolverInstanceBase2 {
+  public:
+    /// One per reset: the number of temporary constraints and the node limit
+    vector<pair<int, long long int> > aResets;
+    int nPermanent = 0;
+    /// Set if a temporary fixing disagreed with the last solution
+    bool fBadFixing = false;
+
+    EnumSolverInstance(Env& env) : SolverInstanceBase2(env) { }
+
+    void processFlatZinc(void) {
+      GCLock lock;
+      Model* flat = getEnv()->flat();
+      for (ConstraintIterator it = flat->begin_constraints(); it != flat->end_constraints(); ++it) {
+        if (it->removed())
+          continue;
+        Call* c = it->e()->cast<Call>();
+        Call* dv = Expression::dyn_cast<Call>(getAnnotation(c->ann(), constants().ann.defines_var));
+        if (dv && c->id().str() == "int_lin_eq")
+          _defs.push_back(make_pair(dv->args()[0]->cast<Id>()->decl(), c));
+        else
+          _cts.push_back(c);
+      }
+      for (VarDeclIterator it = flat->begin_vardecls(); it != flat->end_vardecls(); ++it) {
+        VarDecl* vd = it->e();
+        if (it->removed() || !vd->type().isvar() || vd->type().dim() != 0 || vd->e() != NULL)
+          continue;
+        if (vd->ann().contains(constants().ann.is_defined_var))
+          continue;
+        _vars.push_back(vd);
+        vector<long long int> dom;
+        if (vd->type().isbool()) {
+          dom.push_back(0);
+          dom.push_back(1);
+        } else {
+          IntSetVal* isv = eval_intset(getEnv()->envi(), vd->ti()->domain());
+          for (IntSetRanges r(isv); r(); ++r)
+            for (IntVal v = r.min(); v <= r.max(); ++v)
+              dom.push_back(v.toInt());
+        }
+        _doms.push_back(dom);
+      }
+      _pos.assign(_vars.size(), 0);
+    }
+    Status next(void) {
+      for (;;) {
+        if (!advance())
+          return SolverInstance::UNSAT;
+        if (_nodeLimit > 0 && ++_nNodes > _nodeLimit)
+          return SolverInstance::UNKNOWN;
+        if (feasible()) {
+          _incumbent = _val;
+          return SolverInstance::SAT;
+        }
+      }
+    }
+    void resetSolver(void) {
+      _fStarted = false;
+      _fDone = false;
+      _nNodes = 0;
+      _nodeLimit = getOptions().getIntParam("nodes", 0);
+      _temp.clear();
+    }
+    void resetWithConstraints(Model::iterator begin, Model::iterator end) {
+      resetSolver();
+      for (Model::iterator it = begin; it != end; ++it) {
+        Call* c = (*it)->cast<ConstraintI>()->e()->cast<Call>();
+        _temp.push_back(c);
+        // Fixings are to the incumbent, which is the last solution
+        Id* id = c->args()[0]->cast<Id>();
+        if (_incumbent[id->decl()] != value(c->args()[1]))
+          fBadFixing = true;
+      }
+      aResets.push_back(make_pair(int(_temp.size()), _nodeLimit));
+    }
+    void processPermanentConstraints(Model::iterator begin, Model::iterator end) {
+      for (Model::iterator it = begin; it != end; ++it) {
+        _cts.push_back((*it)->cast<ConstraintI>()->e()->cast<Call>());
+        ++nPermanent;
+      }
+    }
+  protected:
+    Expression* getSolutionValue(Id* id) {
+      long long int v = _val[id->decl()];
+      if (id->type().isbool())
+        return constants().boollit(v != 0);
+      return IntLit::a(v);
+    }
+  private:
+    vector<VarDecl*> _vars;
+    vector<vector<long long int> > _doms;
+    /// Defined variables and their int_lin_eq
+    vector<pair<VarDecl*, Call*> > _defs;
+    vector<Call*> _cts, _temp;
+    vector<int> _pos;
+    /// The assignment being checked and the last solution
+    UNORDERED_NAMESPACE::unordered_map<VarDecl*, long long int> _val, _incumbent;
+    bool _fStarted = false, _fDone = false;
+    long long int _nNodes = 0, _nodeLimit = 0;
+
+    bool advance(void) {
+      if (_fDone)
+        return false;
+      if (!_fStarted) {
+        _fStarted = true;
+        _pos.assign(_vars.size(), 0);
+      } else {
+        int i = _vars.size()-1;
+        while (i >= 0 && _pos[i]+1 == int(_doms[i].size()))
+          _pos[i--] = 0;
+        if (i < 0) {
+          _fDone = true;
+          return false;
+        }
+        ++_pos[i];
+      }
+      return true;
+    }
+    long long int value(Expression* e) {
+      if (IntLit* il = e->dyn_cast<IntLit>())
+        return il->v().toInt();
+      if (BoolLit* bl = e->dyn_cast<BoolLit>())
+        return bl->v();
+      VarDecl* vd = e->cast<Id>()->decl();
+      if (vd->e())
+        return value(vd->e());
+      return _val[vd];
+    }
+    vector<long long int> values(Expression* e) {
+      if (Id* id = e->dyn_cast<Id>())
+        e = id->decl()->e();
+      ArrayLit* al = e->cast<ArrayLit>();
+      vector<long long int> v;
+      for (unsigned int i=0; i<al->v().size(); i++)
+        v.push_back(value(al->v()[i]));
+      return v;
+    }
+    long long int linear(Call* c) {
+      vector<long long int> a = values(c->args()[0]), x = values(c->args()[1]);
+      long long int s = 0;
+      for (size_t i=0; i<a.size(); i++)
+        s += a[i]*x[i];
+      return s;
+    }
+    bool holds(Call* c) {
+      const string id = c->id().str();
+      if (id == "int_lin_le")
+        return linear(c) <= value(c->args()[2]);
+      if (id == "int_lin_eq")
+        return linear(c) == value(c->args()[2]);
+      if (id == "int_le")
+        return value(c->args()[0]) <= value(c->args()[1]);
+      if (id == "int_lt")
+        return value(c->args()[0]) < value(c->args()[1]);
+      if (id == "int_eq" || id == "bool_eq")
+        return value(c->args()[0]) == value(c->args()[1]);
+      check(false, "constraint " + id + " not supported");
+      return false;
+    }
+    bool feasible(void) {
+      _val.clear();
+      for (size_t i=0; i<_vars.size(); i++)
+        _val[_vars[i]] = _doms[i][_pos[i]];
+      for (auto& d : _defs) {
+        // Solves sum a[i]*x[i] = c for the defined variable
+        vector<long long int> a = values(d.second->args()[0]);
+        ArrayLit* al = d.second->args()[1]->cast<ArrayLit>();
+        long long int s = value(d.second->args()[2]), ad = 0;
+        for (unsigned int i=0; i<al->v().size(); i++) {
+          if (al->v()[i]->cast<Id>()->decl() == d.first)
+            ad = a[i];
+          else
+            s -= a[i]*value(al->v()[i]);
+        }
+        if (ad == 0 || s % ad != 0)
+          return false;
+        _val[d.first] = s / ad;
+        if (Expression* dom = d.first->ti()->domain())
+          if (!eval_intset(getEnv()->envi(), dom)->contains(IntVal(s / ad)))
+            return false;
+      }
+      for (Call* c : _cts)
+        if (!holds(c))
+          return false;
+      for (Call* c : _temp)
+        if (!holds(c))
+          return false;
+      return true;
+    }
+  };
+
+  class EnumSolverFactory : public SolverFactory {
+  protected:
+    SolverInstanceBase* doCreateSI(Env& env) { return new EnumSolverInstance(env); }
+  public:
+    string getVersion(void) { return "enumeration for lns_test"; }
+  };
+
+  string stdlibDir;
+
+  /// The lines of a file which start with "obj = ", as numbers
+  vector<long long int> readObjectives(const string& file) {
+    vector<long long int> v;
+    ifstream is(file);
+    string line;
+    while (getline(is, line))
+      if (line.compare(0, 6, "obj = ") == 0)
+        v.push_back(atoll(line.c_str()+6));
+    return v;
+  }
+
+  /// Flattens \a model, runs LNS with \a options and checks the result
+  void run(const string& name, const string& model, const vector<pair<string, long long int> >& options,
+           long long int optimum, SolverInstance::Status stExpected, int nIterations) {
+    char mznFile[] = "/tmp/lns_testXXXXXX.mzn";
+    char outFile[] = "/tmp/lns_testXXXXXX.out";
+    close(mkstemps(mznFile, 4));
+    close(mkstemps(outFile, 4));
+    {
+      ofstream os(mznFile);
+      os << model;
+    }
+    {
+      EnumSolverFactory factory;
+      MznSolver slv;
+      slv.addFlattener();
+      vector<string> args { "lns_test", "--stdlib-dir", stdlibDir, "-o", outFile, mznFile };
+      vector<const char*> argv;
+      for (const string& a : args)
+        argv.push_back(a.c_str());
+      if (!slv.processOptions(argv.size(), argv.data(), cerr)) {
+        check(false, name + ": options");
+        return;
+      }
+      slv.flatten();
+      GCLock lock;
+      slv.addSolverInterface();
+      EnumSolverInstance& si = static_cast<EnumSolverInstance&>(*slv.getSI());
+      // as MznSolver::solve() does
+      si.getOptions().setBoolParam(constants().opts.verbose.str(), false);
+      si.getOptions().setBoolParam(constants().opts.statistics.str(), false);
+      for (auto& o : options)
+        si.getOptions().setIntParam(o.first, o.second);
+      si.processFlatZinc();
+      LNS lns(si);
+      SolverInstance::Status st = lns.run();
+      slv.s2out.evalStatus(st);
+      cout << "  " << name << ": " << lns.nIterations << " iterations, " << lns.nSolutions
+           << " solutions, " << lns.nExhausted << " neighbourhoods exhausted"
+           << (st == SolverInstance::OPT ? ", optimal" : "") << endl;
+
+      check(st == stExpected, name + ": wrong status");
+      check(!si.fBadFixing, name + ": a fixing differs from the incumbent");
+      check(nIterations < 0 || lns.nIterations == nIterations, name + ": wrong number of iterations");
+      check(si.aResets.size() == size_t(lns.nIterations + 1), name + ": one reset per iteration");
+      if (!si.aResets.empty())
+        check(0 == si.aResets[0].first && 0 == si.aResets[0].second,
+              name + ": the first search should run without fixings and node limit");
+      const long long int nodes = options.empty() ? 1000 : options[0].second;
+      bool fFixed = false;
+      for (size_t i=1; i<si.aResets.size(); i++) {
+        check(si.aResets[i].second == nodes, name + ": node limit not passed on");
+        fFixed = fFixed || si.aResets[i].first > 0;
+      }
+      check(lns.nIterations == 0 || fFixed, name + ": nothing was ever fixed");
+      vector<long long int> objs = readObjectives(outFile);
+      check(int(objs.size()) == lns.nSolutions, name + ": not every solution was printed");
+      if (optimum >= 0) {
+        check(si.nPermanent == lns.nSolutions, name + ": one bound per solution");
+        for (size_t i=1; i<objs.size(); i++)
+          check(objs[i] > objs[i-1], name + ": a solution did not improve");
+        check(!objs.empty() && objs.back() <= optimum, name + ": better than the optimum");
+        check(st != SolverInstance::OPT || objs.back() == optimum, name + ": wrong optimum proved");
+      } else {
+        check(0 == si.nPermanent && 1 == lns.nSolutions, name + ": satisfaction");
+      }
+    }
+    remove(mznFile);
+    remove(outFile);
+  }
+
+  /// Maximizes the profit of n items, up to 2 of each, with weight at most cap
+  string knapsack(int n, int cap, bool fSatisfy) {
+    ostringstream os;
+    os << "int: n = " << n << ";\n"
+       << "array[1..n] of int: w = [ 3 + (i * 7) mod 5 | i in 1..n ];\n"
+       << "array[1..n] of int: p = [ 2 + (i * 5) mod 7 | i in 1..n ];\n"
+       << "array[1..n] of var 0..2: x;\n"
+       << "var int: obj = sum(i in 1..n)(p[i] * x[i]);\n"
+       << "constraint sum(i in 1..n)(w[i] * x[i]) <= " << cap << ";\n";
+    if (fSatisfy)
+      os << "constraint obj >= 10;\nsolve satisfy;\n";
+    else
+      os << "solve maximize obj;\n";
+    os << "output [\"obj = \\(obj)\\n\"];\n";
+    return os.str();
+  }
+
+  /// The optimum of knapsack(n, cap, false)
+  long long int knapsackOptimum(int n, int cap) {
+    long long int best = -1;
+    vector<int> x(n, 0);
+    for (;;) {
+      long long int wsum = 0, psum = 0;
+      for (int i=1; i<=n; i++) {
+        wsum += (3 + (i*7) % 5) * x[i-1];
+        psum += (2 + (i*5) % 7) * x[i-1];
+      }
+      if (wsum <= cap)
+        best = max(best, psum);
+      int i = 0;
+      while (i < n && x[i] == 2)
+        x[i++] = 0;
+      if (i == n)
+        return best;
+      ++x[i];
+    }
+  }
+
+}
+
+int main(int argc, char** argv) {
+  for (int i=1; i<argc; i++) {
+    string arg(argv[i]);
+    if (arg == "--stdlib-dir" && i+1 < argc) {
+      stdlibDir = argv[++i];
+    } else {
+      cerr << "Usage: " << argv[0] << " --stdlib-dir <dir>" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (stdlibDir.empty()) {
+    cerr << "Usage: " << argv[0] << " --stdlib-dir <dir>" << endl;
+    return EXIT_FAILURE;
+  }
+  try {
+    // 3^7 assignments: with 3000 nodes, an iteration without fixings is complete
+    run("proof", knapsack(7, 20, false),
+        { {"lns_nodes", 3000}, {"lns_iterations", 500}, {"lns_fix", 50}, {"lns_adapt", 10} },
+        knapsackOptimum(7, 20), SolverInstance::OPT, -1);
+    // Every iteration hits the node limit or exhausts a small neighbourhood
+    run("limit", knapsack(8, 24, false),
+        { {"lns_nodes", 50}, {"lns_iterations", 40}, {"lns_fix", 60}, {"lns_adapt", 5} },
+        knapsackOptimum(8, 24), SolverInstance::SAT, 40);
+    run("satisfy", knapsack(6, 20, true), { }, -1, SolverInstance::SAT, 0);
+  } catch (const Exception& e) {
+    cerr << "lns_test: " << e.what() << ": " << e.msg() << endl;
+    return EXIT_FAILURE;
+  }
+  cout << "lns_test: 3 runs, " << nErrors << " errors" << endl;
+  return nErrors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
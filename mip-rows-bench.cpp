@@ -0,0 +1,154 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Gleb Belov <gleb.belov@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Benchmark of passing linear constraints to the MIP wrapper this program
+ * is linked with (one executable per MIP library, mip-rows-bench-<solver>).
+ *
+ * Adds the same random rows to a fresh wrapper twice: once with addRow()
+ * per row and a generated name, as MIP_solverinstance did before rows were
+ * buffered, and once with bufferRow() and a single flushRows(), as it does
+ * now. Reports the median rows/sec of both over several runs.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <minizinc/solvers/MIP/MIP_wrap.hh>
+#include <minizinc/utils.hh>
+
+using namespace std;
+
+namespace {
+
+  struct Rows {
+    vector<int> starts, ind;
+    vector<double> val, rhs;
+    vector<MIP_wrapper::LinConType> sense;
+  };
+
+  Rows makeRows(int nRows, int nCols, int nnz, unsigned int seed) {
+    mt19937 rnd(seed);
+    Rows r;
+    r.starts.push_back(0);
+    for (int i=0; i<nRows; ++i) {
+      const int j0 = rnd() % nCols;
+      for (int k=0; k<nnz; ++k) {
+        r.ind.push_back((j0 + k) % nCols);       // distinct columns
+        r.val.push_back(int(rnd() % 19) - 9.0);
+      }
+      r.starts.push_back(r.ind.size());
+      r.rhs.push_back(double(rnd() % 100));
+      r.sense.push_back(MIP_wrapper::LinConType(int(rnd() % 3) - 1));
+    }
+    return r;
+  }
+
+  MIP_wrapper* newWrapper(int nCols) {
+    MIP_wrapper* mip = MIP_WrapperFactory::GetDefaultMIPWrapper();
+    for (int j=0; j<nCols; ++j)
+      mip->addVar(1.0, 0.0, 100.0, MIP_wrapper::INT, "x");
+    mip->addPhase1Vars();
+    return mip;
+  }
+
+  double seconds(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+  }
+
+  double rowByRow(const Rows& r, int nCols) {
+    unique_ptr<MIP_wrapper> mip(newWrapper(nCols));
+    vector<int> ind(r.ind);
+    vector<double> val(r.val);
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i=0; i+1<r.starts.size(); ++i) {
+      // Every row was named, whether the solver needed it or not
+      std::stringstream ss;
+      ss << "row_" << (mip->nAddedRows++);
+      mip->addRow(r.starts[i+1]-r.starts[i], &ind[r.starts[i]], &val[r.starts[i]],
+                  r.sense[i], r.rhs[i], MIP_wrapper::MaskConsType_Normal, ss.str());
+    }
+    return seconds(t0);
+  }
+
+  double buffered(const Rows& r, int nCols) {
+    unique_ptr<MIP_wrapper> mip(newWrapper(nCols));
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i=0; i+1<r.starts.size(); ++i)
+      mip->bufferRow(r.starts[i+1]-r.starts[i], &r.ind[r.starts[i]], &r.val[r.starts[i]],
+                     r.sense[i], r.rhs[i]);
+    mip->flushRows();
+    return seconds(t0);
+  }
+
+  double median(vector<double> v) {
+    sort(v.begin(), v.end());
+    return v[v.size()/2];
+  }
+
+  void printHelp(ostream& os) {
+    os << "Usage: mip-rows-bench [<options>]\n"
+       << "Options:\n"
+       << "  -r <n>, --rows <n>\n    Number of rows (default 200000)." << std::endl
+       << "  -c <n>, --cols <n>\n    Number of integer columns (default 20000)." << std::endl
+       << "  --nnz <n>\n    Nonzeros per row (default 5)." << std::endl
+       << "  -n <n>, --repeat <n>\n    Number of runs (default 5)." << std::endl;
+  }
+
+}
+
+int main(int argc, const char** argv) {
+  int nRows = 200000;
+  int nCols = 20000;
+  int nnz = 5;
+  int repeat = 5;
+  for (int i=1; i<argc; ++i) {
+    MiniZinc::CLOParser cop( i, argc, argv );
+    if ( cop.getOption( "-r --rows", &nRows ) ) {
+    } else if ( cop.getOption( "-c --cols", &nCols ) ) {
+    } else if ( cop.getOption( "--nnz", &nnz ) ) {
+    } else if ( cop.getOption( "-n --repeat", &repeat ) ) {
+    } else {
+      printHelp(cerr);
+      return EXIT_FAILURE;
+    }
+  }
+  if (nRows < 1 || nCols < 1 || nnz < 1 || nnz > nCols || repeat < 1) {
+    printHelp(cerr);
+    return EXIT_FAILURE;
+  }
+
+  const Rows rows = makeRows(nRows, nCols, nnz, 1);
+  vector<double> tRow, tBuf;
+  try {
+    for (int k=0; k<repeat; ++k) {
+      tRow.push_back(rowByRow(rows, nCols));
+      tBuf.push_back(buffered(rows, nCols));
+    }
+  } catch (const exception& e) {
+    cerr << "mip-rows-bench: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+  cout << MIP_WrapperFactory::getVersion() << '\n'
+       << nRows << " rows, " << nCols << " columns, " << nnz << " nonzeros per row, median of "
+       << repeat << " runs:\n" << fixed << setprecision(0)
+       << "  addRow() per row         " << setw(12) << nRows / median(tRow) << " rows/sec\n"
+       << "  bufferRow() + flushRows()" << setw(12) << nRows / median(tBuf) << " rows/sec" << endl;
+  return EXIT_SUCCESS;
+}
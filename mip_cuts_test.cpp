@@ -0,0 +1,226 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Gleb Belov <gleb.belov@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Test and benchmark of the cut pool and the cut generator threads of
+ * MIP_solverinstance.
+ *
+ * Checks which cuts CutPool::add() passes on (violated, not seen before,
+ * also after scaling and reordering) and that its counters add up when it is
+ * called from several threads at once, with statistics read in between. Then
+ * checks that CutThreadPool::run() calls every task exactly once, also from
+ * concurrent callers, and reports the callbacks/sec of running a few short
+ * generators in the pool next to starting threads in every callback, as
+ * genCuts() did before. Exits with 1 if any check fails.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include <minizinc/solvers/MIP/MIP_solverinstance.hh>
+
+using namespace MiniZinc;
+
+namespace {
+
+  int nErrors = 0;
+
+  void check(bool fOk, const string& what) {
+    if (!fOk && ++nErrors <= 20)
+      cerr << "mip_cuts_test: " << what << endl;
+  }
+
+  class NoCutGen : public CutGen {
+  public:
+    void generate(const MIP_wrapper::Output&, MIP_wrapper::CutInput&) const { }
+  };
+
+  /// x[i] + x[j] <= rhs, with the terms in the given order and scaled by f
+  MIP_wrapper::CutDef cut(int i, int j, double rhs, double f=1.0,
+                          int mask=MIP_wrapper::MaskConsType_Usercut) {
+    MIP_wrapper::CutDef cd(MIP_wrapper::LQ, mask);
+    cd.addVar(i, f);
+    cd.addVar(j, f);
+    cd.rhs = f*rhs;
+    return cd;
+  }
+
+  void testCutPool() {
+    const vector<double> x(4, 0.75);
+    MIP_wrapper::Output out;
+    out.x = x.data();
+    out.nCols = x.size();
+    CutPool pool;
+    NoCutGen gen;
+    {
+      MIP_wrapper::CutInput cuts, cutsOut;
+      cuts.push_back(cut(0, 1, 1.0));              // violated
+      cuts.push_back(cut(2, 3, 2.0));              // not violated
+      cuts.push_back(cut(1, 0, 1.0, 2.0));         // the first, reordered and scaled
+      CutPool::KeySet keysCall;
+      pool.add(&gen, cuts, 0.0, out, keysCall, cutsOut);
+      check(1==cutsOut.size() && 1==pool.nNotViolated && 1==pool.nDuplicate
+            && 1==gen.stats.nCalls && 3==gen.stats.nCuts && 1==gen.stats.nAdded,
+            "one call: one cut passed, one not violated, one duplicate");
+    }
+    {
+      // A user cut is not passed again; a lazy one is, in another callback
+      MIP_wrapper::CutInput cuts, cutsOut;
+      cuts.push_back(cut(0, 1, 1.0));
+      cuts.push_back(cut(2, 3, 1.0, 1.0, MIP_wrapper::MaskConsType_Lazy));
+      for (int k=0; k<2; ++k) {
+        CutPool::KeySet keysCall;
+        pool.add(&gen, cuts, 0.0, out, keysCall, cutsOut);
+      }
+      check(2==cutsOut.size() && 3==pool.nDuplicate, "lazy cuts again in each callback");
+    }
+  }
+
+  void testCutPoolConcurrent() {
+    const int nThreads = 8, nCalls = 2000;
+    const vector<double> x(64, 0.75);
+    MIP_wrapper::Output out;
+    out.x = x.data();
+    out.nCols = x.size();
+    CutPool pool;
+    NoCutGen gen;
+    atomic<long> nPassed(0);
+    atomic<bool> fDone(false);
+    thread reader([&]() {
+      // as printStatistics() does while callbacks run
+      while (!fDone) {
+        lock_guard<mutex> lock(pool.getMutex());
+        check(gen.stats.nCuts == gen.stats.nAdded + pool.nDuplicate + pool.nNotViolated,
+              "counters read under the lock should add up");
+      }
+    });
+    vector<thread> aThreads;
+    for (int t=0; t<nThreads; ++t)
+      aThreads.emplace_back([&, t]() {
+        for (int k=0; k<nCalls; ++k) {
+          MIP_wrapper::CutInput cuts, cutsOut;
+          const int i = (t*nCalls + k) % 64;
+          cuts.push_back(cut(i, (i+1)%64, 1.0));
+          cuts.push_back(cut(i, (i+2)%64, 2.0));
+          CutPool::KeySet keysCall;
+          pool.add(&gen, cuts, 0.0, out, keysCall, cutsOut);
+          nPassed += cutsOut.size();
+        }
+      });
+    for (auto& thr : aThreads)
+      thr.join();
+    fDone = true;
+    reader.join();
+    check(nThreads*nCalls == gen.stats.nCalls && 2*nThreads*nCalls == gen.stats.nCuts,
+          "concurrent calls: all counted");
+    check(64 == nPassed && 64 == gen.stats.nAdded
+          && nThreads*nCalls == pool.nNotViolated && nThreads*nCalls - 64 == pool.nDuplicate,
+          "concurrent calls: each distinct cut passed once");
+  }
+
+  void testThreadPool() {
+    CutThreadPool pool;
+    vector<atomic<int> > aCount(16);
+    for (int n=0; n<2000; ++n) {
+      const int nTasks = n % 16 + 1;
+      for (int i=0; i<nTasks; ++i)
+        aCount[i] = 0;
+      pool.run(4, nTasks, [&](int i) { ++aCount[i]; });
+      for (int i=0; i<nTasks; ++i)
+        if (1 != aCount[i]) {
+          check(false, "thread pool: a task did not run exactly once");
+          return;
+        }
+    }
+    check(3 == pool.getNWorkers(), "thread pool: 3 workers for 4 threads");
+    // Concurrent callers, as from the callbacks of a parallel solver
+    atomic<long> nRuns(0);
+    vector<thread> aCallers;
+    for (int t=0; t<4; ++t)
+      aCallers.emplace_back([&]() {
+        for (int n=0; n<2000; ++n)
+          pool.run(4, 8, [&](int ) { ++nRuns; });
+      });
+    for (auto& thr : aCallers)
+      thr.join();
+    check(4*2000*8 == nRuns, "thread pool: tasks lost with concurrent callers");
+  }
+
+  double callsPerSec(int nCalls, chrono::steady_clock::time_point t0) {
+    return nCalls / chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+  }
+
+  /// A short generator, like XBZ on a small model
+  void work(vector<double>& aSum, int i) {
+    double s = 0.0;
+    for (int k=0; k<2000; ++k)
+      s += (i+k) * 1e-3;
+    aSum[i] = s;
+  }
+
+  void benchmark(int nCalls, int nThreads) {
+    vector<double> aSum(nThreads);
+    CutThreadPool pool;
+    auto t0 = chrono::steady_clock::now();
+    for (int n=0; n<nCalls; ++n)
+      pool.run(nThreads, nThreads, [&](int i) { work(aSum, i); });
+    const double dPool = callsPerSec(nCalls, t0);
+    t0 = chrono::steady_clock::now();
+    for (int n=0; n<nCalls; ++n) {
+      vector<thread> aThreads;
+      for (int t=1; t<nThreads; ++t)
+        aThreads.emplace_back([&, t]() { work(aSum, t); });
+      work(aSum, 0);
+      for (auto& thr : aThreads)
+        thr.join();
+    }
+    const double dSpawn = callsPerSec(nCalls, t0);
+    t0 = chrono::steady_clock::now();
+    for (int n=0; n<nCalls; ++n)
+      for (int i=0; i<nThreads; ++i)
+        work(aSum, i);
+    const double dInline = callsPerSec(nCalls, t0);
+    cout << "  " << nThreads << " generators per callback: " << fixed << setprecision(0)
+         << setw(9) << dPool << " callbacks/sec in the pool, "
+         << setw(9) << dSpawn << " with new threads, "
+         << setw(9) << dInline << " in one thread" << endl;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  int nCalls = 20000;
+  for (int i=1; i<argc; i++) {
+    string arg(argv[i]);
+    if ((arg == "-n" || arg == "--count") && i+1 < argc) {
+      nCalls = atoi(argv[++i]);
+    } else {
+      cerr << "Usage: " << argv[0] << " [-n <callbacks>]" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  testCutPool();
+  testCutPoolConcurrent();
+  testThreadPool();
+  cout << "mip_cuts_test: " << nErrors << " errors" << endl;
+  if (nErrors)
+    return EXIT_FAILURE;
+  benchmark(nCalls, 2);
+  benchmark(nCalls, 4);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,192 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Gleb Belov <gleb.belov@monash.edu>
+ */
+
+/* Test of MIP_portfolio with a scripted MIP wrapper instead of a solver.
+ *
+ * Each scenario runs two members which report solutions, bounds and final
+ * results in a fixed order, waiting for the cutoffs of each other where the
+ * order matters. Checks which member wins, the status and solution taken,
+ * which solutions reach the solution callback, and that the incumbent of one
+ * member reaches the other as a cutoff. Exits with 1 if any check fails.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <minizinc/solvers/MIP/MIP_portfolio.hh>
+
+using namespace std;
+
+namespace {
+
+  int nErrors = 0;
+
+  void check(bool fOk, const string& what) {
+    if (!fOk && ++nErrors <= 20)
+      cerr << "mip_portfolio_test: " << what << endl;
+  }
+
+  enum Scenario { SC_CUTOFF, SC_WINNER, SC_CALLBACKS };
+
+  /// Plays the part of a solver in each member, depending on the scenario
+  class ScriptedWrapper : public MIP_wrapper {
+  public:
+    Scenario scenario;
+    MIP_portfolio* portfolio = 0;
+    vector<double> x;
+
+    ScriptedWrapper(Scenario sc) : scenario(sc), x(2, 0.0) {
+      for (int j=0; j<2; ++j) {
+        colObj.push_back(1.0);
+        colLB.push_back(0.0);
+        colUB.push_back(1.0);
+        colTypes.push_back(BINARY);
+        colNames.push_back("x");
+      }
+      nProbType = -1;
+      output.nCols = 2;
+    }
+    virtual void doAddVars(size_t , double* , double* , double* , VarType* , std::string* ) { }
+    virtual void addRow(int , int* , double* , LinConType , double , int , std::string ) { }
+    virtual void setObjSense(int ) { }
+    virtual double getInfBound() { return 1e20; }
+    virtual int getNCols() { return colObj.size(); }
+    virtual int getNRows() { return 0; }
+    virtual const double* getValues() { return output.x; }
+    virtual double getObjValue() { return output.objVal; }
+    virtual double getBestBound() { return output.bestBound; }
+    virtual double getCPUTime() { return output.dCPUTime; }
+    virtual Status getStatus() { return output.status; }
+    virtual std::string getStatusName() { return output.statusName; }
+    virtual int getNNodes() { return output.nNodes; }
+    virtual int getNOpen() { return output.nOpenNodes; }
+
+    /// Sets the output to a solution with x[j]=1 and objective value objVal
+    void setSolution(int j, double objVal, Status st, const char* name) {
+      x.assign(2, 0.0);
+      x[j] = 1.0;
+      output.x = x.data();
+      output.objVal = objVal;
+      output.status = st;
+      output.statusName = name;
+    }
+    /// Waits for a cutoff from the other member, returns 1e308 after 10 seconds
+    double waitCutoff() {
+      for (int i=0; i<1000; ++i) {
+        double objVal;
+        if (cbui.objcutfn && (*cbui.objcutfn)(objVal, cbui.ppp))
+          return objVal;
+        this_thread::sleep_for(chrono::milliseconds(10));
+      }
+      return 1e308;
+    }
+    void newIncumbent(bool fAll) {
+      SolCallbackFn fn = fAll ? cbui.solcbfn : cbui.incumbentfn;
+      if (fn)
+        (*fn)(output, cbui.ppp);
+    }
+
+    virtual void solve() {
+      const int k = portfolio->iMember;
+      output.bestBound = 0.0;
+      switch (scenario) {
+        case SC_CUTOFF:
+          // Member 0 finds 10 and keeps searching; member 1 gets 10 as its
+          // cutoff and proves that nothing is better
+          if (0==k) {
+            setSolution(0, 10.0, SAT, "incumbent");
+            newIncumbent(false);
+            this_thread::sleep_for(chrono::seconds(30));
+            output.status = UNKNOWN;
+          } else {
+            const double cutoff = waitCutoff();
+            output.x = 0;
+            output.status = 10.0==cutoff ? UNSAT : UNKNOWN;
+            output.statusName = "infeasible under the cutoff";
+          }
+          break;
+        case SC_WINNER:
+          // Member 1 proves optimality while member 0 is still searching
+          if (0==k) {
+            this_thread::sleep_for(chrono::seconds(30));
+            output.status = UNKNOWN;
+          } else {
+            setSolution(1, 7.0, OPT, "optimal");
+            output.bestBound = 7.0;
+          }
+          break;
+        case SC_CALLBACKS:
+          // With -a, member 0 reports 12 and, after the cutoff 11 from member 1,
+          // 9. Only solutions of members with -a reach the callback
+          if (0==k) {
+            setSolution(0, 12.0, SAT, "first");
+            newIncumbent(true);
+            if (11.0 != waitCutoff()) {
+              output.status = UNKNOWN;
+              break;
+            }
+            setSolution(1, 9.0, SAT, "second");
+            newIncumbent(true);
+            output.status = OPT;
+            output.bestBound = 9.0;
+          } else {
+            if (12.0 != waitCutoff()) {
+              output.status = UNKNOWN;
+              break;
+            }
+            setSolution(1, 11.0, SAT, "shared");
+            newIncumbent(false);
+            this_thread::sleep_for(chrono::seconds(30));
+            output.status = UNKNOWN;
+          }
+          break;
+      }
+    }
+  };
+
+  vector<double> aCallbackObj;
+  void solutionCallback(const MIP_wrapper::Output& out, void* ) {
+    aCallbackObj.push_back(out.objVal);
+  }
+
+  void run(Scenario sc, bool fSolutionCallback, const string& name,
+           MIP_wrapper::Status stExpected, double objExpected, int jExpected, int iWinnerExpected) {
+    ScriptedWrapper w(sc);
+    if (fSolutionCallback)
+      w.provideSolutionCallback(solutionCallback, 0);
+    MIP_portfolio portfolio(&w, vector<string>(2, ""));
+    w.portfolio = &portfolio;
+    aCallbackObj.clear();
+    auto t0 = chrono::steady_clock::now();
+    check(portfolio.solve(), name + ": no portfolio on this platform");
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    check(sec < 20.0, name + ": took too long, a member was not stopped");
+    check(stExpected == w.output.status, name + ": status " + w.output.statusName);
+    check(portfolio.iWinner == iWinnerExpected, name + ": wrong winner");
+    if (w.output.x)
+      check(objExpected == w.output.objVal && 1.0 == w.output.x[jExpected],
+            name + ": wrong solution");
+    else
+      check(false, name + ": no solution");
+  }
+
+}
+
+int main(int , char** ) {
+  run(SC_CUTOFF, false, "cutoff", MIP_wrapper::OPT, 10.0, 0, 0);
+  check(aCallbackObj.empty(), "cutoff: incumbent without -a reached the callback");
+  run(SC_WINNER, false, "winner", MIP_wrapper::OPT, 7.0, 1, 1);
+  run(SC_CALLBACKS, true, "callbacks", MIP_wrapper::OPT, 9.0, 1, 0);
+  check(2==aCallbackObj.size() && 12.0==aCallbackObj[0] && 9.0==aCallbackObj[1],
+        "callbacks: the solution callback should get 12 and 9");
+  cout << "mip_portfolio_test: 3 scenarios, " << nErrors << " errors" << endl;
+  return nErrors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
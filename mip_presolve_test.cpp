@@ -0,0 +1,292 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Gleb Belov <gleb.belov@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Test of MIP_wrapper::presolveRows().
+ *
+ * First one small case per reduction, checking the statistics and what is
+ * left of the rows. Then random small integer models, where the integer
+ * points that satisfy the presolved rows and bounds must be exactly those
+ * that satisfy the original ones (found by enumeration). Exits with 1 if any
+ * check fails.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <minizinc/solvers/MIP/MIP_wrap.hh>
+#include <minizinc/utils.hh>
+
+using namespace std;
+
+namespace {
+
+  int nErrors = 0;
+
+  void check(bool fOk, const string& what) {
+    if (!fOk && ++nErrors <= 20)
+      cerr << "mip_presolve_test: " << what << endl;
+  }
+
+  struct Row {
+    vector<int> ind;
+    vector<double> val;
+    MIP_wrapper::LinConType sense;
+    double rhs;
+  };
+
+  /// A model of integer columns, kept to compare against the presolved one
+  struct Model {
+    vector<double> lb, ub;
+    vector<Row> rows;
+    unique_ptr<MIP_wrapper> mip;
+    bool fFeasible = true;
+    MIP_wrapper::PresolveStats stats;
+
+    int addCol(double l, double u) {
+      lb.push_back(l);
+      ub.push_back(u);
+      return lb.size()-1;
+    }
+    void addRow(const vector<int>& ind, const vector<double>& val,
+                MIP_wrapper::LinConType sense, double rhs) {
+      Row r;
+      r.ind = ind;
+      r.val = val;
+      r.sense = sense;
+      r.rhs = rhs;
+      rows.push_back(r);
+    }
+    void presolve() {
+      mip.reset(MIP_WrapperFactory::GetDefaultMIPWrapper());
+      for (size_t j=0; j<lb.size(); ++j)
+        mip->addVar(0.0, lb[j], ub[j], MIP_wrapper::INT, "x");
+      for (size_t i=0; i<rows.size(); ++i)
+        mip->bufferRow(rows[i].ind.size(), rows[i].ind.data(), rows[i].val.data(),
+                       rows[i].sense, rows[i].rhs);
+      fFeasible = mip->presolveRows(stats);
+    }
+    int nRowsLeft() const { return mip->rowBuffer.size(); }
+  };
+
+  bool satisfies(const vector<int>& x, const vector<int>& ind, const double* val,
+                 MIP_wrapper::LinConType sense, double rhs) {
+    double lhs = 0.0;
+    for (size_t k=0; k<ind.size(); ++k)
+      lhs += val[k]*x[ind[k]];
+    return (MIP_wrapper::GQ==sense || lhs <= rhs + 1e-9)
+      && (MIP_wrapper::LQ==sense || lhs >= rhs - 1e-9);
+  }
+
+  bool feasibleBefore(const Model& m, const vector<int>& x) {
+    for (size_t j=0; j<x.size(); ++j)
+      if (x[j] < m.lb[j] || x[j] > m.ub[j])
+        return false;
+    for (size_t i=0; i<m.rows.size(); ++i)
+      if (!satisfies(x, m.rows[i].ind, m.rows[i].val.data(), m.rows[i].sense, m.rows[i].rhs))
+        return false;
+    return true;
+  }
+
+  bool feasibleAfter(const Model& m, const vector<int>& x) {
+    if (!m.fFeasible)
+      return false;
+    for (size_t j=0; j<x.size(); ++j)
+      if (x[j] < m.mip->colLB[j] || x[j] > m.mip->colUB[j])
+        return false;
+    const MIP_wrapper::RowBuffer& rb = m.mip->rowBuffer;
+    for (int i=0; i<rb.size(); ++i) {
+      vector<int> ind(rb.rmatind.begin()+rb.rowStarts[i], rb.rmatind.begin()+rb.rowStarts[i+1]);
+      if (!satisfies(x, ind, &rb.rmatval[rb.rowStarts[i]], rb.sense[i], rb.rhs[i]))
+        return false;
+    }
+    return true;
+  }
+
+  /// Compares the integer points within the original bounds
+  void compareByEnumeration(const Model& m, const string& name) {
+    vector<int> x(m.lb.size());
+    for (size_t j=0; j<x.size(); ++j)
+      x[j] = int(m.lb[j]);
+    for (;;) {
+      if (feasibleBefore(m, x) != feasibleAfter(m, x)) {
+        ostringstream oss;
+        oss << name << ": point";
+        for (size_t j=0; j<x.size(); ++j)
+          oss << ' ' << x[j];
+        oss << (feasibleBefore(m, x) ? " lost" : " gained") << " by presolve";
+        check(false, oss.str());
+        return;
+      }
+      size_t j=0;
+      while (j<x.size() && x[j]==int(m.ub[j])) {
+        x[j] = int(m.lb[j]);
+        ++j;
+      }
+      if (j==x.size())
+        break;
+      ++x[j];
+    }
+  }
+
+  void testReductions() {
+    const MIP_wrapper::LinConType LQ = MIP_wrapper::LQ, EQ = MIP_wrapper::EQ, GQ = MIP_wrapper::GQ;
+    {
+      // Fixed columns go to the rhs, which leaves an empty row
+      Model m;
+      int x = m.addCol(2, 2), y = m.addCol(3, 3), z = m.addCol(0, 5);
+      m.addRow({x, y}, {1, 1}, LQ, 5);
+      m.addRow({x, z, y}, {1, 1, 1}, GQ, 6);
+      m.presolve();
+      check(m.fFeasible && m.stats.nEmpty==1 && m.stats.nFixedTerms==4, "empty row");
+      compareByEnumeration(m, "empty row");
+    }
+    {
+      // A singleton row becomes a rounded bound
+      Model m;
+      int x = m.addCol(0, 10);
+      m.addRow({x}, {2}, LQ, 7);
+      m.presolve();
+      check(m.fFeasible && m.stats.nSingleton==1 && m.nRowsLeft()==0
+            && m.mip->colUB[x]==3, "singleton row");
+    }
+    {
+      // Duplicates keep the tightest rhs; a <= / >= pair becomes an equality
+      Model m;
+      int x = m.addCol(0, 5), y = m.addCol(0, 5), z = m.addCol(0, 5);
+      m.addRow({x, y}, {1, 1}, LQ, 4);
+      m.addRow({y, x}, {1, 1}, LQ, 3);
+      m.addRow({y, z}, {1, -1}, LQ, 2);
+      m.addRow({z, y}, {1, -1}, LQ, -2);
+      m.presolve();
+      const MIP_wrapper::RowBuffer& rb = m.mip->rowBuffer;
+      check(m.fFeasible && m.stats.nDuplicate==2 && rb.size()==2
+            && rb.rhs[0]==3 && rb.sense[1]==EQ, "duplicate rows");
+      compareByEnumeration(m, "duplicate rows");
+    }
+    {
+      // Activity bounds show that a row cannot be violated
+      Model m;
+      int x = m.addCol(0, 10), y = m.addCol(0, 10);
+      m.addRow({x, y}, {1, 1}, LQ, 30);
+      m.addRow({x, y}, {1, -1}, GQ, -10);
+      m.presolve();
+      check(m.fFeasible && m.stats.nRedundant==2 && m.nRowsLeft()==0, "redundant rows");
+    }
+    {
+      // Set covering: x+y >= 1 implies x+y+z >= 1
+      Model m;
+      int x = m.addCol(0, 1), y = m.addCol(0, 1), z = m.addCol(0, 1);
+      m.addRow({x, y, z}, {1, 1, 1}, GQ, 1);
+      m.addRow({x, y}, {1, 1}, GQ, 1);
+      m.presolve();
+      check(m.fFeasible && m.stats.nDominated==1 && m.nRowsLeft()==1
+            && m.mip->rowBuffer.nnz(0)==2, "dominated covering row");
+      compareByEnumeration(m, "dominated covering row");
+    }
+    {
+      // Same support: x+2y <= 4 implies x+y <= 4 for y >= 0; an equality
+      // x+y = 2 implies x+y+z >= 1 for z >= 0
+      Model m;
+      int x = m.addCol(0, 4), y = m.addCol(0, 4), z = m.addCol(0, 4), w = m.addCol(0, 4);
+      m.addRow({x, y}, {1, 1}, LQ, 4);
+      m.addRow({x, y}, {1, 2}, LQ, 4);
+      m.addRow({z, w}, {1, 1}, EQ, 2);
+      m.addRow({z, w, x}, {1, 1, 1}, GQ, 1);
+      m.presolve();
+      check(m.fFeasible && m.stats.nDominated==2 && m.nRowsLeft()==2, "dominated rows");
+      compareByEnumeration(m, "dominated rows");
+    }
+    {
+      // No dominance between rows that only overlap
+      Model m;
+      int x = m.addCol(0, 1), y = m.addCol(0, 1), z = m.addCol(0, 1);
+      m.addRow({x, y}, {1, 1}, GQ, 1);
+      m.addRow({x, z}, {1, 1}, GQ, 1);
+      m.presolve();
+      check(m.fFeasible && m.stats.nDominated==0 && m.nRowsLeft()==2, "overlapping rows");
+    }
+    {
+      // Infeasible by activity bounds
+      Model m;
+      int x = m.addCol(0, 10), y = m.addCol(0, 10);
+      m.addRow({x, y}, {1, 1}, GQ, 25);
+      m.presolve();
+      check(!m.fFeasible, "infeasible row");
+    }
+  }
+
+  void testRandom(int nModels, unsigned int seed) {
+    mt19937 rnd(seed);
+    auto range = [&](int lo, int hi) { return lo + int(rnd() % (hi-lo+1)); };
+    for (int n=0; n<nModels; ++n) {
+      Model m;
+      const int nCols = range(2, 4);
+      for (int j=0; j<nCols; ++j) {
+        int l = range(-2, 2);
+        m.addCol(l, range(0, 3) ? l + range(0, 3) : l);
+      }
+      const int nRows = range(1, 6);
+      for (int i=0; i<nRows; ++i) {
+        if (i>0 && 0==range(0, 3)) {
+          // a copy of an earlier row, scaled, with another rhs or sense
+          Row r = m.rows[range(0, i-1)];
+          const double f = range(0, 1) ? 1.0 : -2.0;
+          for (size_t k=0; k<r.val.size(); ++k)
+            r.val[k] *= f;
+          r.rhs = f*r.rhs + range(-1, 1);
+          if (f < 0.0)
+            r.sense = MIP_wrapper::LinConType(-int(r.sense));
+          m.rows.push_back(r);
+          continue;
+        }
+        vector<int> ind;
+        vector<double> val;
+        for (int j=0; j<nCols; ++j)
+          if (range(0, 2)) {
+            ind.push_back(j);
+            val.push_back(range(-3, 3));
+          }
+        m.addRow(ind, val, MIP_wrapper::LinConType(range(-1, 1)), range(-4, 6));
+      }
+      m.presolve();
+      ostringstream oss;
+      oss << "random model " << n;
+      compareByEnumeration(m, oss.str());
+    }
+  }
+
+}
+
+int main(int argc, char** argv) {
+  int nModels = 20000;
+  unsigned int seed = 1;
+  for (int i=1; i<argc; i++) {
+    string arg(argv[i]);
+    if ((arg == "-n" || arg == "--count") && i+1 < argc) {
+      nModels = atoi(argv[++i]);
+    } else if (arg == "--seed" && i+1 < argc) {
+      seed = strtoul(argv[++i], NULL, 10);
+    } else {
+      cerr << "Usage: " << argv[0] << " [-n <count>] [--seed <n>]" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  testReductions();
+  testRandom(nModels, seed);
+  cout << "mip_presolve_test: " << nModels << " random models, " << nErrors << " errors" << endl;
+  return nErrors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Gleb Belov <gleb.belov@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Test and benchmark of SetOfIntervals::cutOut() from the MIP domains
+ * decomposition.
+ *
+ * First the edge cases of cutting an open interval out of closed ones (empty
+ * result, touching bounds, single points, infinite ends), then random sets of
+ * disjoint or touching intervals, where the result must be the same as
+ * cutting every interval separately. Then reports the cuts/sec of punching
+ * holes into one large interval, next to the same cuts on a std::multiset,
+ * the container SetOfIntervals used before. Exits with 1 if any check fails.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <minizinc/MIPdomains.hh>
+#include <minizinc/timer.hh>
+
+using namespace std;
+using namespace MiniZinc;
+
+namespace {
+
+  typedef Interval<double> Intv;
+  typedef SetOfIntervals<double> Set;
+
+  const double inf = Intv::infPlus();
+
+  int nErrors = 0;
+
+  void check(bool fOk, const string& what) {
+    if (!fOk && ++nErrors <= 20)
+      cerr << "mipdomains_test: " << what << endl;
+  }
+
+  /// What is left of one closed interval after cutting out the open (a, b),
+  /// which includes a or b if it is infinite
+  void cutOne(const Intv& iv, double a, double b, vector<Intv>& result) {
+    if (!(a < b)) {
+      result.push_back(iv);
+      return;
+    }
+    if (a > Intv::infMinus() && iv.left <= a)
+      result.push_back(Intv(iv.left, min(iv.right, a)));
+    if (b < Intv::infPlus() && iv.right >= b)
+      result.push_back(Intv(max(iv.left, b), iv.right));
+  }
+
+  vector<pair<double, double> > bounds(const vector<Intv>& v) {
+    vector<pair<double, double> > p;
+    for (const Intv& iv : v)
+      p.push_back(make_pair(iv.left, iv.right));
+    sort(p.begin(), p.end());
+    return p;
+  }
+
+  string toString(const vector<Intv>& v) {
+    ostringstream oss;
+    for (const Intv& iv : v)
+      oss << iv;
+    return oss.str();
+  }
+
+  /// Cuts (a, b) out of s and compares with cutting every interval alone
+  void checkCut(const vector<Intv>& s, double a, double b, const vector<Intv>* expected) {
+    vector<Intv> ref;
+    for (const Intv& iv : s)
+      cutOne(iv, a, b, ref);
+    Set soi(s.begin(), s.end());
+    soi.cutOut(Intv(a, b));
+    vector<Intv> res(soi.begin(), soi.end());
+    bool fSorted = true;
+    for (size_t i=1; i<res.size(); ++i)
+      fSorted = fSorted && res[i-1].left <= res[i].left;
+    if (!fSorted || bounds(res) != bounds(ref)
+        || (expected && bounds(res) != bounds(*expected))) {
+      ostringstream oss;
+      oss << "cutting " << Intv(a, b) << "from " << toString(s)
+          << "gives " << toString(res);
+      if (expected)
+        oss << ", expected " << toString(*expected);
+      check(false, oss.str());
+    }
+  }
+  void checkCut(const vector<Intv>& s, double a, double b) {
+    checkCut(s, a, b, NULL);
+  }
+  void checkCut(const vector<Intv>& s, double a, double b, const vector<Intv>& expected) {
+    checkCut(s, a, b, &expected);
+  }
+
+  void testEdgeCases() {
+    const double m = Intv::infMinus();
+    const vector<Intv> none;
+    // Empty result
+    checkCut({ Intv(1, 9) }, 0, 10, none);
+    checkCut({ Intv(m, 0), Intv(2, 3), Intv(5, inf) }, m, inf, none);
+    checkCut({ Intv(1, 2), Intv(3, 4) }, 0, 5, none);
+    checkCut({}, 0, 1, none);
+    // Touching bounds: the closed ends stay as they are or as points
+    checkCut({ Intv(0, 2), Intv(5, 7) }, 2, 5, vector<Intv>{ Intv(0, 2), Intv(5, 7) });
+    const vector<Intv> points{ Intv(2, 2), Intv(5, 5) };
+    checkCut({ Intv(2, 5) }, 2, 5, points);
+    checkCut({ Intv(1, 3), Intv(3, 5) }, 3, 4,
+             vector<Intv>{ Intv(1, 3), Intv(3, 3), Intv(4, 5) });
+    checkCut({ Intv(1, 3), Intv(3, 5) }, 2, 4,
+             vector<Intv>{ Intv(1, 2), Intv(4, 5) });
+    // Single points
+    checkCut({ Intv(3, 3) }, 2, 4, none);
+    const vector<Intv> point3{ Intv(3, 3) };
+    checkCut({ Intv(3, 3) }, 3, 4, point3);
+    checkCut({ Intv(3, 3) }, 2, 3, point3);
+    checkCut({ Intv(3, 3), Intv(3, 5) }, 3, 4,
+             vector<Intv>{ Intv(3, 3), Intv(3, 3), Intv(4, 5) });
+    checkCut({ Intv(0, 10) }, 4, 4, vector<Intv>{ Intv(0, 10) });
+    // Splitting inside one interval, and infinite ends
+    checkCut({ Intv(0, 10) }, 4, 6, vector<Intv>{ Intv(0, 4), Intv(6, 10) });
+    checkCut({ Intv(m, inf) }, m, 0, vector<Intv>{ Intv(0, inf) });
+    checkCut({ Intv(m, inf) }, 0, inf, vector<Intv>{ Intv(m, 0) });
+    checkCut({ Intv(m, 1), Intv(4, inf) }, 0, 5,
+             vector<Intv>{ Intv(m, 0), Intv(5, inf) });
+  }
+
+  void testRandom(int n, unsigned int seed) {
+    mt19937 rnd(seed);
+    auto range = [&](int lo, int hi) { return lo + int(rnd() % (hi-lo+1)); };
+    for (int k=0; k<n; ++k) {
+      // Non-decreasing ends, so intervals are disjoint, touch or are points
+      vector<double> ends(2*range(0, 5));
+      double x = range(-3, 3);
+      for (double& e : ends) {
+        e = x;
+        x += range(0, 2);
+      }
+      if (!ends.empty() && 0==range(0, 3))
+        ends.front() = Intv::infMinus();
+      if (!ends.empty() && 0==range(0, 3))
+        ends.back() = inf;
+      vector<Intv> s;
+      for (size_t i=0; i<ends.size(); i+=2)
+        s.push_back(Intv(ends[i], ends[i+1]));
+      double a = range(-4, 12);
+      double b = a + range(0, 5);
+      if (0==range(0, 5))
+        a = Intv::infMinus();
+      if (0==range(0, 5))
+        b = inf;
+      checkCut(s, a, b);
+    }
+  }
+
+  /// The same cut on the node-based container
+  void cutOutMultiset(multiset<Intv>& s, double a, double b) {
+    auto it1 = s.upper_bound(Intv(a, a));
+    if (s.begin() != it1 && prev(it1)->right > a)
+      --it1;
+    auto it2 = s.lower_bound(Intv(b, b));
+    vector<Intv> pieces;
+    for (auto it=it1; it!=it2; ++it)
+      cutOne(*it, a, b, pieces);
+    s.erase(it1, it2);
+    s.insert(pieces.begin(), pieces.end());
+  }
+
+  void benchmark(int nCuts, unsigned int seed) {
+    mt19937 rnd(seed);
+    vector<double> holes;
+    for (int i=0; i<nCuts; ++i)
+      holes.push_back(double(rnd() % (4*nCuts)));
+    Timer t;
+    Set soi{ Intv(0, 4*nCuts) };
+    for (double h : holes)
+      soi.cutOut(Intv(h + 0.25, h + 0.75));
+    double msVector = t.ms();
+    t.reset();
+    multiset<Intv> ms{ Intv(0, 4*nCuts) };
+    for (double h : holes)
+      cutOutMultiset(ms, h + 0.25, h + 0.75);
+    double msMultiset = t.ms();
+    check(bounds(vector<Intv>(soi.begin(), soi.end()))
+          == bounds(vector<Intv>(ms.begin(), ms.end())), "benchmark results differ");
+    cout << "  " << nCuts << " holes into one interval: " << fixed << setprecision(0)
+         << setw(10) << nCuts / msVector * 1e3 << " cuts/sec, std::multiset "
+         << setw(10) << nCuts / msMultiset * 1e3 << " cuts/sec" << endl;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  int n = 200000;
+  int nCuts = 20000;
+  unsigned int seed = 1;
+  for (int i=1; i<argc; i++) {
+    string arg(argv[i]);
+    if ((arg == "-n" || arg == "--count") && i+1 < argc) {
+      n = atoi(argv[++i]);
+    } else if (arg == "--cuts" && i+1 < argc) {
+      nCuts = atoi(argv[++i]);
+    } else if (arg == "--seed" && i+1 < argc) {
+      seed = strtoul(argv[++i], NULL, 10);
+    } else {
+      cerr << "Usage: " << argv[0] << " [-n <count>] [--cuts <n>] [--seed <n>]" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  testEdgeCases();
+  testRandom(n, seed);
+  cout << "mipdomains_test: " << n << " random cuts, " << nErrors << " errors" << endl;
+  if (nErrors)
+    return EXIT_FAILURE;
+  benchmark(nCuts, seed);
+  return nErrors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,620 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Compilation benchmark: flattens (and optionally solves) the instances of
+ * a manifest several times, records the median wall time of each phase, the
+ * growth of the GC heap and the size of the flat model, writes the results as
+ * JSON and compares them against the results of an earlier run.
+ *
+ * All runs share one process and one heap. The heap growth of a run is its
+ * high water mark above the pages in use after a collection at its start, so
+ * it does not include memory that an earlier run freed and this one reused.
+ * The flattener exits on errors, which ends the benchmark.
+ *
+ * A manifest has one instance per line: a model followed by its data files,
+ * relative to the directory of the manifest. Empty lines and lines starting
+ * with # are ignored.
+ *
+ * With --printer, each run also writes the flat model to a null stream, once
+ * through Printer (width 0, the former FlatZinc path) and once through
+ * FznPrinter, and reports the throughput of both.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <minizinc/solver.hh>
+#include <minizinc/number_format.hh>
+#include <minizinc/prettyprinter.hh>
+
+using namespace std;
+using namespace MiniZinc;
+
+namespace {
+
+  class BenchError : public Exception {
+  public:
+    BenchError(const std::string& msg) : Exception(msg) {}
+    ~BenchError(void) throw() {}
+    virtual const char* what(void) const throw() {
+      return "mzn-bench: error";
+    }
+  };
+
+  struct Instance {
+    string name;
+    vector<string> files;
+  };
+
+  struct PhaseResult {
+    string name;
+    vector<double> wallMs;
+    vector<double> cpuMs;
+  };
+
+  struct Result {
+    string name;
+    vector<string> files;
+    string status;
+    vector<double> wallMs;
+    vector<double> solveMs;
+    vector<PhaseResult> phases;
+    /// Heap pages allocated on top of those at the start of each run
+    vector<double> heapGrowth;
+    FlatModelStatistics stats;
+    /// With --printer: size of the FlatZinc and time to print it
+    long long int printBytes = 0;
+    vector<double> printerMs;
+    vector<double> fznPrinterMs;
+  };
+
+  double median(vector<double> v) {
+    if (v.empty())
+      return 0.0;
+    sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n/2] : (v[n/2-1]+v[n/2])/2.0;
+  }
+
+  string jsonString(const string& s) {
+    ostringstream oss;
+    oss << '"';
+    for (unsigned int i=0; i<s.size(); i++) {
+      unsigned char c = s[i];
+      if (c=='"' || c=='\\')
+        oss << '\\' << c;
+      else if (c < 0x20)
+        oss << "\\u" << hex << setw(4) << setfill('0') << int(c) << dec << setfill(' ');
+      else
+        oss << c;
+    }
+    oss << '"';
+    return oss.str();
+  }
+
+  /// The part of JSON needed to read back the results
+  struct JSONValue {
+    enum Kind { J_NULL, J_BOOL, J_NUMBER, J_STRING, J_ARRAY, J_OBJECT } kind = J_NULL;
+    double num = 0.0;
+    string str;
+    vector<JSONValue> elems;
+    vector<pair<string,JSONValue> > fields;
+    const JSONValue* get(const string& key) const {
+      for (unsigned int i=0; i<fields.size(); i++)
+        if (fields[i].first==key)
+          return &fields[i].second;
+      return NULL;
+    }
+  };
+
+  class JSONReader {
+  public:
+    JSONReader(const string& s0, const string& filename0) : s(s0), filename(filename0), pos(0) {}
+    JSONValue read(void) {
+      JSONValue v = value();
+      skip();
+      if (pos != s.size())
+        error("trailing characters");
+      return v;
+    }
+  private:
+    const string& s;
+    string filename;
+    size_t pos;
+    void error(const string& msg) {
+      ostringstream oss;
+      oss << filename << ": offset " << pos << ": " << msg;
+      throw BenchError(oss.str());
+    }
+    void skip(void) {
+      while (pos<s.size() && isspace(static_cast<unsigned char>(s[pos])))
+        pos++;
+    }
+    void expect(char c) {
+      skip();
+      if (pos>=s.size() || s[pos]!=c)
+        error(string("expected '")+c+"'");
+      pos++;
+    }
+    string str(void) {
+      expect('"');
+      string r;
+      while (pos<s.size() && s[pos]!='"') {
+        if (s[pos]=='\\') {
+          if (++pos>=s.size())
+            break;
+          switch (s[pos]) {
+            case 'n': r += '\n'; break;
+            case 't': r += '\t'; break;
+            case 'r': r += '\r'; break;
+            case 'b': r += '\b'; break;
+            case 'f': r += '\f'; break;
+            case 'u':
+              if (pos+4>=s.size())
+                error("bad escape");
+              r += static_cast<char>(strtol(s.substr(pos+1, 4).c_str(), NULL, 16));
+              pos += 4;
+              break;
+            default: r += s[pos];
+          }
+          pos++;
+        } else {
+          r += s[pos++];
+        }
+      }
+      expect('"');
+      return r;
+    }
+    JSONValue value(void) {
+      skip();
+      if (pos>=s.size())
+        error("unexpected end");
+      JSONValue v;
+      char c = s[pos];
+      if (c=='{') {
+        pos++;
+        v.kind = JSONValue::J_OBJECT;
+        skip();
+        if (pos<s.size() && s[pos]=='}') {
+          pos++;
+          return v;
+        }
+        for (;;) {
+          string key = str();
+          expect(':');
+          v.fields.push_back(make_pair(key, value()));
+          skip();
+          if (pos<s.size() && s[pos]==',') {
+            pos++;
+            continue;
+          }
+          expect('}');
+          return v;
+        }
+      } else if (c=='[') {
+        pos++;
+        v.kind = JSONValue::J_ARRAY;
+        skip();
+        if (pos<s.size() && s[pos]==']') {
+          pos++;
+          return v;
+        }
+        for (;;) {
+          v.elems.push_back(value());
+          skip();
+          if (pos<s.size() && s[pos]==',') {
+            pos++;
+            continue;
+          }
+          expect(']');
+          return v;
+        }
+      } else if (c=='"') {
+        v.kind = JSONValue::J_STRING;
+        v.str = str();
+      } else if (s.compare(pos, 4, "true")==0) {
+        v.kind = JSONValue::J_BOOL;
+        v.num = 1.0;
+        pos += 4;
+      } else if (s.compare(pos, 5, "false")==0) {
+        v.kind = JSONValue::J_BOOL;
+        pos += 5;
+      } else if (s.compare(pos, 4, "null")==0) {
+        pos += 4;
+      } else {
+        const char* begin = s.c_str()+pos;
+        char* end;
+        v.kind = JSONValue::J_NUMBER;
+        v.num = strtod(begin, &end);
+        if (end==begin)
+          error("unexpected character");
+        pos += end-begin;
+      }
+      return v;
+    }
+  };
+
+  vector<Instance> readManifest(const string& filename) {
+    ifstream is(filename.c_str());
+    checkIOStatus (is.good(), " I/O error: cannot open manifest file. ");
+    string dir;
+    size_t slash = filename.find_last_of("/\\");
+    if (slash != string::npos)
+      dir = filename.substr(0, slash+1);
+    vector<Instance> instances;
+    string line;
+    while (getline(is, line)) {
+      istringstream iss(line);
+      string file;
+      Instance inst;
+      while (iss >> file) {
+        if (inst.files.empty() && file[0]=='#')
+          break;
+        inst.files.push_back(file[0]=='/' ? file : dir+file);
+        size_t s = file.find_last_of("/\\");
+        inst.name += (inst.name.empty() ? "" : "+") + (s==string::npos ? file : file.substr(s+1));
+      }
+      if (!inst.files.empty())
+        instances.push_back(inst);
+    }
+    return instances;
+  }
+
+  /// Discards what the solver prints
+  class NullBuffer : public streambuf {
+  protected:
+    virtual int overflow(int c) { return c; }
+  };
+
+  /// Discards its output and counts the characters
+  class CountingBuffer : public streambuf {
+  public:
+    long long int n = 0;
+  protected:
+    virtual int overflow(int c) { n++; return c; }
+    virtual streamsize xsputn(const char*, streamsize count) { n += count; return count; }
+  };
+
+  double mbPerSec(long long int bytes, double ms) {
+    return ms > 0.0 ? bytes / 1e3 / ms : 0.0;
+  }
+
+  /// Prints the flat model with Printer and with FznPrinter
+  void runPrinters(Result& r, Model* flat) {
+    CountingBuffer printerBuf;
+    ostream printerOs(&printerBuf);
+    Timer timer;
+    {
+      Printer p(printerOs, 0, true);
+      p.print(flat);
+    }
+    r.printerMs.push_back(timer.ms());
+    CountingBuffer fznBuf;
+    ostream fznOs(&fznBuf);
+    timer.reset();
+    {
+      FznPrinter p(fznOs, true);
+      p.print(flat);
+    }
+    r.fznPrinterMs.push_back(timer.ms());
+    if (printerBuf.n != fznBuf.n)
+      cerr << "mzn-bench: " << r.name << ": Printer wrote " << printerBuf.n
+           << " bytes, FznPrinter " << fznBuf.n << endl;
+    r.printBytes = fznBuf.n;
+  }
+
+  void run(Result& r, const vector<string>& flatteningArgs, bool fSolve, bool fPrinter) {
+    vector<const char*> argv;
+    argv.push_back("mzn-bench");
+    for (unsigned int i=0; i<flatteningArgs.size(); i++)
+      argv.push_back(flatteningArgs[i].c_str());
+    for (unsigned int i=0; i<r.files.size(); i++)
+      argv.push_back(r.files[i].c_str());
+
+    NullBuffer nb;
+    streambuf* coutBuf = cout.rdbuf(&nb);
+    // Count only what this run allocates on top of the memory still in use
+    GC::collect();
+    GC::resetPeakMem();
+    size_t heapStart = GC::allocedMem();
+    size_t heapPeak = heapStart;
+    Timer timer;
+    {
+      MznSolver slv(false);
+      slv.addFlattener();
+      if (!slv.processOptions(static_cast<int>(argv.size()), &argv[0], cerr)) {
+        cout.rdbuf(coutBuf);
+        throw BenchError("bad flattener options");
+      }
+      slv.getFlt()->set_flag_profile(true);
+      slv.flatten();
+      r.wallMs.push_back(timer.ms());
+      r.status = slv.getFlt()->status==SolverInstance::UNSAT ? "unsat" : "ok";
+      if (r.wallMs.size()==1)
+        r.stats = statistics(*slv.getFlt()->getEnv());
+      const vector<PhaseProfile::Phase>& phases = slv.getFlt()->getProfile()->phases();
+      for (unsigned int i=0; i<phases.size(); i++) {
+        unsigned int j=0;
+        while (j<r.phases.size() && r.phases[j].name != phases[i].name)
+          j++;
+        if (j==r.phases.size()) {
+          r.phases.push_back(PhaseResult());
+          r.phases[j].name = phases[i].name;
+        }
+        r.phases[j].wallMs.push_back(phases[i].wallMs);
+        r.phases[j].cpuMs.push_back(phases[i].cpuMs);
+      }
+      if (fPrinter) {
+        GCLock lock;
+        runPrinters(r, slv.getFlt()->getEnv()->flat());
+      }
+      if (fSolve && slv.getFlt()->status==SolverInstance::UNKNOWN) {
+        Timer solveTimer;
+        {
+          GCLock lock;
+          slv.addSolverInterface();
+          slv.solve();
+        }
+        // MznSolver does not delete its solver instance
+        delete slv.getSI();
+        r.solveMs.push_back(solveTimer.ms());
+      }
+      // The phases reset the peak of the GC, the profile keeps the overall one
+      heapPeak = slv.getFlt()->getProfile()->heapPeak();
+    }
+    r.heapGrowth.push_back(static_cast<double>(heapPeak-heapStart));
+    cout.rdbuf(coutBuf);
+  }
+
+  void printJSON(ostream& os, const vector<Result>& results, int repeat, bool fSolve) {
+    os << "{\n  \"repeat\": " << repeat << ",\n  \"solve\": " << (fSolve ? "true" : "false")
+       << ",\n  \"instances\": [";
+    for (unsigned int i=0; i<results.size(); i++) {
+      const Result& r = results[i];
+      const FlatModelStatistics& st = r.stats;
+      os << (i==0 ? "\n" : ",\n")
+         << "    {\"name\": " << jsonString(r.name) << ", \"files\": [";
+      for (unsigned int j=0; j<r.files.size(); j++)
+        os << (j==0 ? "" : ", ") << jsonString(r.files[j]);
+      os << "], \"status\": " << jsonString(r.status) << ",\n"
+         << "     \"wall_ms\": " << NumberFormat::fixed(median(r.wallMs), 3)
+         << ", \"wall_ms_min\": " << NumberFormat::fixed(*min_element(r.wallMs.begin(), r.wallMs.end()), 3)
+         << ", \"wall_ms_max\": " << NumberFormat::fixed(*max_element(r.wallMs.begin(), r.wallMs.end()), 3);
+      if (!r.solveMs.empty())
+        os << ", \"solve_ms\": " << NumberFormat::fixed(median(r.solveMs), 3);
+      os << ", \"heap_growth_bytes\": " << static_cast<long long int>(median(r.heapGrowth)) << ",\n"
+         << "     \"flat\": {\"vars\": " << st.n_bool_vars+st.n_int_vars+st.n_float_vars+st.n_set_vars
+         << ", \"constraints\": " << st.n_bool_ct+st.n_int_ct+st.n_float_ct+st.n_set_ct
+         << ", \"bool_vars\": " << st.n_bool_vars << ", \"int_vars\": " << st.n_int_vars
+         << ", \"float_vars\": " << st.n_float_vars << ", \"set_vars\": " << st.n_set_vars
+         << ", \"bool_constraints\": " << st.n_bool_ct << ", \"int_constraints\": " << st.n_int_ct
+         << ", \"float_constraints\": " << st.n_float_ct << ", \"set_constraints\": " << st.n_set_ct << "},\n"
+         << "     \"phases\": {";
+      for (unsigned int j=0; j<r.phases.size(); j++)
+        os << (j==0 ? "" : ", ") << jsonString(r.phases[j].name)
+           << ": {\"wall_ms\": " << NumberFormat::fixed(median(r.phases[j].wallMs), 3)
+           << ", \"cpu_ms\": " << NumberFormat::fixed(median(r.phases[j].cpuMs), 3) << "}";
+      os << "}";
+      if (!r.fznPrinterMs.empty()) {
+        double printerMs = median(r.printerMs), fznPrinterMs = median(r.fznPrinterMs);
+        os << ",\n     \"print\": {\"bytes\": " << r.printBytes
+           << ", \"printer_ms\": " << NumberFormat::fixed(printerMs, 3)
+           << ", \"fzn_printer_ms\": " << NumberFormat::fixed(fznPrinterMs, 3)
+           << ", \"printer_mb_s\": " << NumberFormat::fixed(mbPerSec(r.printBytes, printerMs), 1)
+           << ", \"fzn_printer_mb_s\": " << NumberFormat::fixed(mbPerSec(r.printBytes, fznPrinterMs), 1)
+           << "}";
+      }
+      os << "}";
+    }
+    os << "\n  ]\n}\n";
+  }
+
+  /// Compares \a cur with field \a key of \a b, prints a line if it is worse
+  /// than the threshold, and returns whether it is. Values below \a floor are
+  /// noise, and fields missing from the baseline are not compared.
+  bool compare(ostream& os, const string& instance, const string& metric, double cur,
+               const JSONValue& b, const string& key, double threshold, double floor) {
+    const JSONValue* v = b.get(key);
+    if (v==NULL || v->kind!=JSONValue::J_NUMBER)
+      return false;
+    double base = v->num;
+    if (max(cur, base) < floor || cur <= base*(1.0+threshold/100.0))
+      return false;
+    os << "  " << instance << ": " << metric << " " << NumberFormat::fixed(base, 1)
+       << " -> " << NumberFormat::fixed(cur, 1);
+    if (base > 0.0)
+      os << " (+" << NumberFormat::fixed((cur/base-1.0)*100.0, 1) << "%)";
+    os << "\n";
+    return true;
+  }
+
+  /// Returns the number of regressions against the baseline
+  int compareBaseline(ostream& os, const vector<Result>& results, const JSONValue& baseline,
+                      double threshold, double minMs) {
+    const JSONValue* instances = baseline.get("instances");
+    if (instances==NULL || instances->kind!=JSONValue::J_ARRAY)
+      throw BenchError("baseline has no instances");
+    int nRegressions = 0;
+    int nCompared = 0;
+    os << "Regressions of more than " << NumberFormat::fixed(threshold, 1) << "% against the baseline:\n";
+    for (unsigned int i=0; i<results.size(); i++) {
+      const Result& r = results[i];
+      const JSONValue* b = NULL;
+      for (unsigned int j=0; j<instances->elems.size() && b==NULL; j++) {
+        const JSONValue* name = instances->elems[j].get("name");
+        if (name && name->str==r.name)
+          b = &instances->elems[j];
+      }
+      if (b==NULL) {
+        os << "  " << r.name << ": not in baseline\n";
+        continue;
+      }
+      nCompared++;
+      const JSONValue* status = b->get("status");
+      if (status && status->str != r.status) {
+        os << "  " << r.name << ": status " << status->str << " -> " << r.status << "\n";
+        nRegressions++;
+      }
+      nRegressions += compare(os, r.name, "wall ms", median(r.wallMs), *b, "wall_ms", threshold, minMs);
+      if (!r.solveMs.empty())
+        nRegressions += compare(os, r.name, "solve ms", median(r.solveMs), *b, "solve_ms", threshold, minMs);
+      nRegressions += compare(os, r.name, "heap growth bytes", median(r.heapGrowth),
+                              *b, "heap_growth_bytes", threshold, 0.0);
+      if (const JSONValue* flat = b->get("flat")) {
+        const FlatModelStatistics& st = r.stats;
+        nRegressions += compare(os, r.name, "flat vars",
+                                st.n_bool_vars+st.n_int_vars+st.n_float_vars+st.n_set_vars,
+                                *flat, "vars", threshold, 0.0);
+        nRegressions += compare(os, r.name, "flat constraints",
+                                st.n_bool_ct+st.n_int_ct+st.n_float_ct+st.n_set_ct,
+                                *flat, "constraints", threshold, 0.0);
+      }
+      if (const JSONValue* print = b->get("print")) {
+        if (!r.fznPrinterMs.empty())
+          nRegressions += compare(os, r.name, "FznPrinter ms", median(r.fznPrinterMs),
+                                  *print, "fzn_printer_ms", threshold, minMs);
+      }
+      if (const JSONValue* phases = b->get("phases")) {
+        for (unsigned int j=0; j<r.phases.size(); j++) {
+          if (const JSONValue* p = phases->get(r.phases[j].name))
+            nRegressions += compare(os, r.name, r.phases[j].name+" ms", median(r.phases[j].wallMs),
+                                    *p, "wall_ms", threshold, minMs);
+        }
+      }
+    }
+    os << "  " << nRegressions << " regression(s) in " << nCompared << " compared instance(s)\n";
+    return nRegressions;
+  }
+
+  void printHelp(ostream& os) {
+    os << "MiniZinc compilation benchmark.\n"
+       << "Usage: mzn-bench [<options>] <manifest> [-- <flattener options>]\n"
+       << "Flattens each instance of the manifest (one model and its data files per line,\n"
+       << "relative to the manifest) several times and reports the median times.\n"
+       << "Options:" << std::endl
+       << "  --help, -h\n    Print this help message." << std::endl
+       << "  -n <n>, --repeat <n>\n    Number of runs per instance (default 3)." << std::endl
+       << "  -o <file>, --output <file>\n    Write the results as JSON to <file> instead of the standard output." << std::endl
+       << "  --baseline <file>\n    Compare against the results of an earlier run, exit with 1 on regressions." << std::endl
+       << "  --threshold <percent>\n    Regression threshold for times, heap and flat model size (default 10)." << std::endl
+       << "  --min-ms <ms>\n    Ignore times below <ms> in the comparison (default 5)." << std::endl
+       << "  --solve\n    Also solve each instance with the built-in solver." << std::endl
+       << "  --printer\n    Also print each flat model with Printer and FznPrinter and report MB/s." << std::endl
+       << "  -v, --verbose\n    Print the progress." << std::endl;
+  }
+
+}
+
+int main(int argc, const char** argv) {
+
+#ifdef HAS_GECODE
+  static unique_ptr<SolverFactory>
+    pFactoryGECODE( SolverFactory::createF_GECODE() );
+#endif
+
+  int repeat = 3;
+  string output;
+  string baselineFile;
+  double threshold = 10.0;
+  double minMs = 5.0;
+  bool fSolve = false;
+  bool fPrinter = false;
+  bool fVerbose = false;
+  string manifest;
+  vector<string> flatteningArgs;
+
+  for (int i=1; i<argc; ++i) {
+    CLOParser cop( i, argc, argv );
+    if ( cop.getOption( "-h --help" ) ) {
+      printHelp(cout);
+      return EXIT_SUCCESS;
+    } else if ( cop.getOption( "-n --repeat", &repeat ) ) {
+    } else if ( cop.getOption( "-o --output", &output ) ) {
+    } else if ( cop.getOption( "--baseline", &baselineFile ) ) {
+    } else if ( cop.getOption( "--threshold", &threshold ) ) {
+    } else if ( cop.getOption( "--min-ms", &minMs ) ) {
+    } else if ( cop.getOption( "--solve" ) ) {
+      fSolve = true;
+    } else if ( cop.getOption( "--printer" ) ) {
+      fPrinter = true;
+    } else if ( cop.getOption( "-v --verbose" ) ) {
+      fVerbose = true;
+    } else if (string(argv[i])=="--") {
+      flatteningArgs.assign(argv+i+1, argv+argc);
+      break;
+    } else if (manifest.empty() && argv[i][0]!='-') {
+      manifest = argv[i];
+    } else {
+      cerr << "mzn-bench: Unrecognized option or bad format `" << argv[i] << "'" << endl;
+      printHelp(cerr);
+      return EXIT_FAILURE;
+    }
+  }
+  if (manifest.empty() || repeat < 1) {
+    printHelp(cerr);
+    return EXIT_FAILURE;
+  }
+  if (fSolve && getGlobalSolverRegistry()->getSolverFactories().empty()) {
+    cerr << "mzn-bench: --solve needs a solver, but none was built in." << endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    vector<Instance> instances = readManifest(manifest);
+    JSONValue baseline;
+    if (!baselineFile.empty()) {
+      ifstream is(baselineFile.c_str());
+      checkIOStatus (is.good(), " I/O error: cannot open baseline file. ");
+      string s((istreambuf_iterator<char>(is)), istreambuf_iterator<char>());
+      baseline = JSONReader(s, baselineFile).read();
+    }
+
+    vector<Result> results(instances.size());
+    for (unsigned int i=0; i<instances.size(); i++) {
+      Result& r = results[i];
+      r.name = instances[i].name;
+      r.files = instances[i].files;
+      if (fVerbose)
+        cerr << r.name << " ..." << flush;
+      for (int k=0; k<repeat; k++)
+        run(r, flatteningArgs, fSolve, fPrinter);
+      if (fVerbose) {
+        cerr << " " << NumberFormat::fixed(median(r.wallMs), 1) << " ms";
+        if (fPrinter)
+          cerr << ", Printer " << NumberFormat::fixed(mbPerSec(r.printBytes, median(r.printerMs)), 1)
+               << " MB/s, FznPrinter " << NumberFormat::fixed(mbPerSec(r.printBytes, median(r.fznPrinterMs)), 1)
+               << " MB/s";
+        cerr << endl;
+      }
+    }
+
+    if (output.empty()) {
+      printJSON(cout, results, repeat, fSolve);
+    } else {
+      ofstream os(output.c_str());
+      checkIOStatus (os.good(), " I/O error: cannot open output file. ");
+      printJSON(os, results, repeat, fSolve);
+      checkIOStatus (os.good(), " I/O error: cannot write output file. ");
+    }
+
+    if (!baselineFile.empty() && compareBaseline(cerr, results, baseline, threshold, minMs) > 0)
+      return EXIT_FAILURE;
+  } catch (const Exception& e) {
+    cerr << e.what() << ": " << e.msg() << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,566 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Synthetic model generator: writes a MiniZinc model of one of a few
+ * families and data of a given size and shape, for stress-testing the
+ * compiler with instances much larger than the examples.
+ *
+ * The data is generated from a fixed seed with our own mapping of the
+ * Mersenne twister to ranges (the std distributions differ between
+ * standard libraries), so the same options give the same instance
+ * everywhere. Every instance has a solution planted by the generator.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <minizinc/exception.hh>
+#include <minizinc/utils.hh>
+
+using namespace std;
+using namespace MiniZinc;
+
+namespace {
+
+  class GenError : public Exception {
+  public:
+    GenError(const std::string& msg) : Exception(msg) {}
+    ~GenError(void) throw() {}
+    virtual const char* what(void) const throw() {
+      return "mzn-gen: error";
+    }
+  };
+
+  /// Random numbers that only depend on the seed
+  class Random {
+  protected:
+    std::mt19937_64 _g;
+  public:
+    Random(unsigned long long int seed) : _g(seed) {}
+    /// Uniform in \a lo .. \a hi
+    long long int range(long long int lo, long long int hi) {
+      unsigned long long int n = static_cast<unsigned long long int>(hi-lo)+1;
+      if (n==0)
+        return static_cast<long long int>(_g());
+      // Reject the top 2^64 mod n values so that all residues are equally likely
+      unsigned long long int limit = ~0ULL - ((~0ULL % n) + 1) % n;
+      unsigned long long int r;
+      do {
+        r = _g();
+      } while (r > limit);
+      return lo + static_cast<long long int>(r % n);
+    }
+    /// True with probability \a percent / 100
+    bool percent(int p) {
+      return range(0, 99) < p;
+    }
+    template<class T>
+    void shuffle(vector<T>& v) {
+      for (size_t i=v.size(); i>1; i--)
+        std::swap(v[i-1], v[static_cast<size_t>(range(0, static_cast<long long int>(i)-1))]);
+    }
+  };
+
+  /// Writes parameters in .dzn or .json syntax. Arrays are written
+  /// flat, 2d arrays as rows, with line breaks so that editors cope.
+  class DataWriter {
+  protected:
+    ostream& _os;
+    bool _json;
+    bool _first;
+    void name(const string& n) {
+      if (_json)
+        _os << (_first ? "{\n" : ",\n") << "  \"" << n << "\" : ";
+      else
+        _os << n << " = ";
+      _first = false;
+    }
+    void end(void) {
+      if (!_json)
+        _os << ";\n";
+    }
+    template<class T>
+    void values(const vector<T>& v, size_t from, size_t n) {
+      _os << "[";
+      for (size_t i=0; i<n; i++) {
+        if (i > 0)
+          _os << (i % 20 == 0 ? ",\n    " : ", ");
+        _os << v[from+i];
+      }
+      _os << "]";
+    }
+  public:
+    DataWriter(ostream& os, bool json) : _os(os), _json(json), _first(true) {
+      _os << std::boolalpha;
+    }
+    void param(const string& n, long long int v) {
+      name(n);
+      _os << v;
+      end();
+    }
+    template<class T>
+    void array(const string& n, const vector<T>& v) {
+      name(n);
+      values(v, 0, v.size());
+      end();
+    }
+    /// Writes \a v as a \a rows x \a cols array
+    template<class T>
+    void array2d(const string& n, const vector<T>& v, size_t rows, size_t cols) {
+      name(n);
+      if (_json) {
+        _os << "[";
+        for (size_t r=0; r<rows; r++) {
+          _os << (r==0 ? "\n    " : ",\n    ");
+          values(v, r*cols, cols);
+        }
+        _os << "\n  ]";
+      } else {
+        _os << "[| ";
+        for (size_t i=0; i<v.size(); i++) {
+          if (i > 0)
+            _os << (i % cols == 0 ? "\n  | " : (i % cols % 20 == 0 ? ",\n    " : ", "));
+          _os << v[i];
+        }
+        _os << " |]";
+      }
+      end();
+    }
+    void close(void) {
+      if (_json)
+        _os << (_first ? "{" : "\n") << "}\n";
+    }
+  };
+
+  /// Options of all families; each family documents which it uses
+  struct Options {
+    long long int size = -1;
+    long long int width = -1;
+    long long int maxValue = -1;
+    int holes = -1;
+    long long int arity = -1;
+    unsigned long long int seed = 1;
+  };
+
+  long long int orDefault(long long int v, long long int def) {
+    return v < 0 ? def : v;
+  }
+
+  /// Sudoku of order size (default 3, a size^2 x size^2 board) with
+  /// holes percent (default 60) of the cells left empty
+  void sudoku(ostream& model, DataWriter& data, Random& rnd, const Options& o) {
+    long long int s = orDefault(o.size, 3);
+    int holes = o.holes < 0 ? 60 : o.holes;
+    if (s < 1 || s > 1000)
+      throw GenError("sudoku order must be in 1..1000");
+    long long int n = s*s;
+    // Shuffle the rows within bands, the bands, the columns within stacks,
+    // the stacks and the digits of a pattern solution
+    vector<long long int> rows, cols;
+    for (int k=0; k<2; k++) {
+      vector<long long int>& perm = k==0 ? rows : cols;
+      vector<long long int> bands(s);
+      for (long long int b=0; b<s; b++)
+        bands[b] = b;
+      rnd.shuffle(bands);
+      for (long long int b=0; b<s; b++) {
+        vector<long long int> within(s);
+        for (long long int i=0; i<s; i++)
+          within[i] = bands[b]*s+i;
+        rnd.shuffle(within);
+        perm.insert(perm.end(), within.begin(), within.end());
+      }
+    }
+    vector<long long int> digits(n);
+    for (long long int d=0; d<n; d++)
+      digits[d] = d+1;
+    rnd.shuffle(digits);
+    vector<long long int> start(n*n);
+    for (long long int r=0; r<n; r++) {
+      for (long long int c=0; c<n; c++) {
+        long long int pr = rows[r];
+        long long int pc = cols[c];
+        start[r*n+c] = rnd.percent(holes) ? 0 : digits[(s*(pr % s) + pr/s + pc) % n];
+      }
+    }
+    data.param("S", s);
+    data.array2d("start", start, n, n);
+
+    model
+      << "include \"alldifferent.mzn\";\n\n"
+      << "int: S;\n"
+      << "int: N = S * S;\n"
+      << "array[1..N,1..N] of 0..N: start;  % 0 is an empty cell\n"
+      << "array[1..N,1..N] of var 1..N: puzzle;\n\n"
+      << "constraint forall(i,j in 1..N where start[i,j] > 0)(puzzle[i,j] = start[i,j]);\n"
+      << "constraint forall(i in 1..N)(alldifferent(j in 1..N)(puzzle[i,j]));\n"
+      << "constraint forall(j in 1..N)(alldifferent(i in 1..N)(puzzle[i,j]));\n"
+      << "constraint forall(a,b in 1..S)(\n"
+      << "  alldifferent(i,j in 1..S)(puzzle[(a-1)*S+i,(b-1)*S+j]));\n\n"
+      << "solve satisfy;\n\n"
+      << "output [show(puzzle[i,j]) ++ if j=N then \"\\n\" else \" \" endif | i,j in 1..N];\n";
+  }
+
+  /// Job shop with size jobs (default 10) on width machines (default 5),
+  /// durations in 1..maxValue (default 99)
+  void jobshop(ostream& model, DataWriter& data, Random& rnd, const Options& o) {
+    long long int jobs = orDefault(o.size, 10);
+    long long int machines = orDefault(o.width, 5);
+    long long int maxDur = orDefault(o.maxValue, 99);
+    if (jobs < 1 || machines < 1 || maxDur < 1)
+      throw GenError("job shop needs at least one job, machine and time unit");
+    vector<long long int> mach(jobs*machines);
+    vector<long long int> dur(jobs*machines);
+    for (long long int j=0; j<jobs; j++) {
+      vector<long long int> order(machines);
+      for (long long int m=0; m<machines; m++)
+        order[m] = m+1;
+      rnd.shuffle(order);
+      for (long long int k=0; k<machines; k++) {
+        mach[j*machines+k] = order[k];
+        dur[j*machines+k] = rnd.range(1, maxDur);
+      }
+    }
+    data.param("n_jobs", jobs);
+    data.param("n_machines", machines);
+    data.array2d("mach", mach, jobs, machines);
+    data.array2d("dur", dur, jobs, machines);
+
+    model
+      << "int: n_jobs;\n"
+      << "int: n_machines;\n"
+      << "set of int: JOB = 1..n_jobs;\n"
+      << "set of int: TASK = 1..n_machines;\n"
+      << "array[JOB,TASK] of 1..n_machines: mach;  % machine of each task\n"
+      << "array[JOB,TASK] of int: dur;\n"
+      << "int: horizon = sum(j in JOB, k in TASK)(dur[j,k]);\n"
+      << "% the task of each job on each machine\n"
+      << "array[JOB,1..n_machines] of TASK: task =\n"
+      << "  array2d(JOB, 1..n_machines, [k | j in JOB, m in 1..n_machines, k in TASK where mach[j,k] = m]);\n\n"
+      << "array[JOB,TASK] of var 0..horizon: s;\n"
+      << "var 0..horizon: makespan;\n\n"
+      << "constraint forall(j in JOB)(\n"
+      << "  forall(k in 1..n_machines-1)(s[j,k] + dur[j,k] <= s[j,k+1]) /\\\n"
+      << "  s[j,n_machines] + dur[j,n_machines] <= makespan);\n"
+      << "constraint forall(m in 1..n_machines, j1, j2 in JOB where j1 < j2)(\n"
+      << "  let { int: k1 = task[j1,m]; int: k2 = task[j2,m] } in\n"
+      << "    s[j1,k1] + dur[j1,k1] <= s[j2,k2] \\/ s[j2,k2] + dur[j2,k2] <= s[j1,k1]);\n\n"
+      << "solve minimize makespan;\n\n"
+      << "output [\"makespan = \", show(makespan), \"\\n\"];\n";
+  }
+
+  /// Bin packing of size items (default 50) with weights in a tenth to a
+  /// half of the capacity maxValue (default 100); the number of bins is
+  /// the first-fit decreasing solution
+  void binpacking(ostream& model, DataWriter& data, Random& rnd, const Options& o) {
+    long long int items = orDefault(o.size, 50);
+    long long int capacity = orDefault(o.maxValue, 100);
+    if (items < 1 || capacity < 2)
+      throw GenError("bin packing needs at least one item and a capacity of at least 2");
+    vector<long long int> weight(items);
+    for (long long int i=0; i<items; i++)
+      weight[i] = rnd.range(std::max(1LL, capacity/10), capacity/2);
+    vector<long long int> sorted(weight);
+    std::sort(sorted.begin(), sorted.end(), std::greater<long long int>());
+    vector<long long int> load;
+    for (long long int i=0; i<items; i++) {
+      size_t b = 0;
+      while (b < load.size() && load[b]+sorted[i] > capacity)
+        b++;
+      if (b==load.size())
+        load.push_back(0);
+      load[b] += sorted[i];
+    }
+    data.param("n_items", items);
+    data.param("n_bins", static_cast<long long int>(load.size()));
+    data.param("capacity", capacity);
+    data.array("weight", weight);
+
+    model
+      << "int: n_items;\n"
+      << "int: n_bins;\n"
+      << "int: capacity;\n"
+      << "array[1..n_items] of 1..capacity: weight;\n\n"
+      << "array[1..n_items] of var 1..n_bins: bin;\n"
+      << "var 1..n_bins: used;\n\n"
+      << "constraint forall(b in 1..n_bins)(\n"
+      << "  sum(i in 1..n_items)(weight[i] * bool2int(bin[i] = b)) <= capacity);\n"
+      << "constraint forall(i in 1..n_items)(bin[i] <= used);\n"
+      << "constraint bin[1] = 1;\n\n"
+      << "solve minimize used;\n\n"
+      << "output [\"used = \", show(used), \"\\n\"];\n";
+  }
+
+  /// Sparse linear system of size variables (default 1000) in 0..maxValue
+  /// (default 100) and width constraints (default size/2) over arity
+  /// (default 10) variables each
+  void linear(ostream& model, DataWriter& data, Random& rnd, const Options& o) {
+    long long int n = orDefault(o.size, 1000);
+    long long int m = orDefault(o.width, n/2);
+    long long int ub = orDefault(o.maxValue, 100);
+    long long int rowSize = std::min(n, orDefault(o.arity, 10));
+    if (n < 1 || rowSize < 1)
+      throw GenError("linear system needs at least one variable per constraint");
+    vector<long long int> solution(n);
+    for (long long int i=0; i<n; i++)
+      solution[i] = rnd.range(0, ub);
+    vector<long long int> rowStart(1, 1);
+    vector<long long int> col;
+    vector<long long int> coef;
+    vector<long long int> rhs(m);
+    vector<long long int> row;
+    for (long long int r=0; r<m; r++) {
+      row.clear();
+      while (static_cast<long long int>(row.size()) < rowSize) {
+        long long int c = rnd.range(1, n);
+        if (std::find(row.begin(), row.end(), c)==row.end())
+          row.push_back(c);
+      }
+      std::sort(row.begin(), row.end());
+      long long int lhs = 0;
+      for (size_t k=0; k<row.size(); k++) {
+        long long int a = rnd.range(-20, 19);
+        if (a >= 0)
+          a++;
+        col.push_back(row[k]);
+        coef.push_back(a);
+        lhs += a*solution[row[k]-1];
+      }
+      rhs[r] = lhs + rnd.range(0, 10);
+      rowStart.push_back(static_cast<long long int>(col.size())+1);
+    }
+    vector<long long int> obj(n);
+    for (long long int i=0; i<n; i++)
+      obj[i] = rnd.range(1, 10);
+    data.param("n_vars", n);
+    data.param("n_cons", m);
+    data.param("ub", ub);
+    data.array("row_start", rowStart);
+    data.array("col", col);
+    data.array("coef", coef);
+    data.array("rhs", rhs);
+    data.array("obj", obj);
+
+    model
+      << "int: n_vars;\n"
+      << "int: n_cons;\n"
+      << "int: ub;\n"
+      << "% constraint r has the entries row_start[r]..row_start[r+1]-1 of col and coef\n"
+      << "array[1..n_cons+1] of int: row_start;\n"
+      << "array[int] of 1..n_vars: col;\n"
+      << "array[int] of int: coef;\n"
+      << "array[1..n_cons] of int: rhs;\n"
+      << "array[1..n_vars] of int: obj;\n\n"
+      << "array[1..n_vars] of var 0..ub: x;\n\n"
+      << "constraint forall(r in 1..n_cons)(\n"
+      << "  sum(k in row_start[r]..row_start[r+1]-1)(coef[k] * x[col[k]]) <= rhs[r]);\n\n"
+      << "solve maximize sum(i in 1..n_vars)(obj[i] * x[i]);\n\n"
+      << "output [\"objective = \", show(sum(i in 1..n_vars)(obj[i] * x[i])), \"\\n\"];\n";
+  }
+
+  /// Size variables (default 100) in 1..maxValue (default 10), with width
+  /// clauses (default 4*size) of arity (default 3) literals x = v or
+  /// x != v, and as many implications between two clauses, all of which
+  /// are reified through exists and forall
+  void reif(ostream& model, DataWriter& data, Random& rnd, const Options& o) {
+    long long int n = orDefault(o.size, 100);
+    long long int dom = orDefault(o.maxValue, 10);
+    long long int m = orDefault(o.width, 4*n);
+    long long int k = orDefault(o.arity, 3);
+    if (n < 1 || dom < 2 || k < 1)
+      throw GenError("reification model needs a variable, two values and a literal per clause");
+    vector<long long int> solution(n);
+    for (long long int i=0; i<n; i++)
+      solution[i] = rnd.range(1, dom);
+    vector<long long int> var(m*k);
+    vector<long long int> val(m*k);
+    vector<bool> pos(m*k);
+    for (long long int c=0; c<m; c++) {
+      long long int sat = rnd.range(0, k-1);
+      for (long long int l=0; l<k; l++) {
+        long long int i = c*k+l;
+        var[i] = rnd.range(1, n);
+        pos[i] = rnd.percent(50);
+        val[i] = rnd.range(1, dom);
+        if (l==sat) {
+          // The planted solution satisfies this literal
+          if (pos[i])
+            val[i] = solution[var[i]-1];
+          else if (val[i]==solution[var[i]-1])
+            val[i] = val[i] % dom + 1;
+        }
+      }
+    }
+    // Implications: if all literals of clause impl[c] hold, then the
+    // variables forbid_var[c,..] must not take the values forbid_val[c,..],
+    // none of which the planted solution uses
+    vector<long long int> impl(m);
+    for (long long int c=0; c<m; c++)
+      impl[c] = rnd.range(1, m);
+    vector<long long int> bvar(m*k);
+    vector<long long int> bval(m*k);
+    for (long long int i=0; i<m*k; i++) {
+      bvar[i] = rnd.range(1, n);
+      bval[i] = rnd.percent(50) ? solution[bvar[i]-1] : rnd.range(1, dom);
+    }
+    for (long long int i=0; i<m*k; i++)
+      if (bval[i]==solution[bvar[i]-1])
+        bval[i] = bval[i] % dom + 1;
+    data.param("n_vars", n);
+    data.param("dom", dom);
+    data.param("n_clauses", m);
+    data.param("clause_size", k);
+    data.array2d("var_of", var, m, k);
+    data.array2d("val_of", val, m, k);
+    data.array2d("pos", pos, m, k);
+    data.array("impl", impl);
+    data.array2d("forbid_var", bvar, m, k);
+    data.array2d("forbid_val", bval, m, k);
+
+    model
+      << "int: n_vars;\n"
+      << "int: dom;\n"
+      << "int: n_clauses;\n"
+      << "int: clause_size;\n"
+      << "set of int: CLAUSE = 1..n_clauses;\n"
+      << "set of int: LIT = 1..clause_size;\n"
+      << "array[CLAUSE,LIT] of 1..n_vars: var_of;\n"
+      << "array[CLAUSE,LIT] of 1..dom: val_of;\n"
+      << "array[CLAUSE,LIT] of bool: pos;\n"
+      << "array[CLAUSE] of CLAUSE: impl;\n"
+      << "array[CLAUSE,LIT] of 1..n_vars: forbid_var;\n"
+      << "array[CLAUSE,LIT] of 1..dom: forbid_val;\n\n"
+      << "array[1..n_vars] of var 1..dom: x;\n\n"
+      << "predicate lit(int: c, int: l) =\n"
+      << "  if pos[c,l] then x[var_of[c,l]] = val_of[c,l] else x[var_of[c,l]] != val_of[c,l] endif;\n\n"
+      << "constraint forall(c in CLAUSE)(exists(l in LIT)(lit(c,l)));\n"
+      << "constraint forall(c in CLAUSE)(\n"
+      << "  forall(l in LIT)(lit(impl[c],l)) ->\n"
+      << "    forall(l in LIT)(x[forbid_var[c,l]] != forbid_val[c,l]));\n\n"
+      << "solve satisfy;\n\n"
+      << "output [\"x = \", show(x), \"\\n\"];\n";
+  }
+
+  struct Family {
+    const char* name;
+    void (*generate)(ostream&, DataWriter&, Random&, const Options&);
+  };
+
+  const Family families[] = {
+    { "sudoku", sudoku },
+    { "jobshop", jobshop },
+    { "binpacking", binpacking },
+    { "linear", linear },
+    { "reif", reif }
+  };
+
+  void printHelp(ostream& os) {
+    os << "MiniZinc synthetic model generator.\n"
+       << "Usage: mzn-gen [<options>] <family>\n"
+       << "Writes a model of <family> to <base>.mzn and generated data to <base>.dzn\n"
+       << "(or <base>.json). The same options and seed give the same instance.\n"
+       << "Families and the meaning of the size options:\n"
+       << "  sudoku      order --size (3), --holes (60) percent of the cells empty\n"
+       << "  jobshop     --size jobs (10) on --width machines (5), durations up to --max (99)\n"
+       << "  binpacking  --size items (50), bin capacity --max (100)\n"
+       << "  linear      --size variables (1000) in 0..--max (100), --width constraints\n"
+       << "              (size/2) over --arity (10) variables each\n"
+       << "  reif        --size variables (100) in 1..--max (10), --width clauses (4*size)\n"
+       << "              of --arity (3) literals, and as many reified implications\n"
+       << "Options:" << std::endl
+       << "  --help, -h\n    Print this help message." << std::endl
+       << "  -n <n>, --size <n>\n    Main size of the instance." << std::endl
+       << "  -m <n>, --width <n>\n    Second size of the instance." << std::endl
+       << "  --max <n>\n    Largest value of the instance data." << std::endl
+       << "  --holes <percent>\n    Percentage of empty cells." << std::endl
+       << "  -k <n>, --arity <n>\n    Number of variables per constraint." << std::endl
+       << "  --seed <n>\n    Seed of the random numbers (default 1)." << std::endl
+       << "  -o <base>, --output <base>\n    Base name of the output files (default <family>)." << std::endl
+       << "  --json\n    Write the data as JSON instead of .dzn." << std::endl;
+  }
+
+}
+
+int main(int argc, const char** argv) {
+  Options o;
+  string output;
+  string family;
+  bool fJSON = false;
+
+  for (int i=1; i<argc; ++i) {
+    CLOParser cop( i, argc, argv );
+    if ( cop.getOption( "-h --help" ) ) {
+      printHelp(cout);
+      return EXIT_SUCCESS;
+    } else if ( cop.getOption( "-n --size", &o.size ) ) {
+    } else if ( cop.getOption( "-m --width", &o.width ) ) {
+    } else if ( cop.getOption( "--max", &o.maxValue ) ) {
+    } else if ( cop.getOption( "--holes", &o.holes ) ) {
+    } else if ( cop.getOption( "-k --arity", &o.arity ) ) {
+    } else if ( cop.getOption( "--seed", &o.seed ) ) {
+    } else if ( cop.getOption( "-o --output", &output ) ) {
+    } else if ( cop.getOption( "--json" ) ) {
+      fJSON = true;
+    } else if (family.empty() && argv[i][0]!='-') {
+      family = argv[i];
+    } else {
+      cerr << "mzn-gen: Unrecognized option or bad format `" << argv[i] << "'" << endl;
+      printHelp(cerr);
+      return EXIT_FAILURE;
+    }
+  }
+  const Family* f = NULL;
+  for (unsigned int i=0; i<sizeof(families)/sizeof(families[0]); i++)
+    if (family==families[i].name)
+      f = &families[i];
+  if (f==NULL) {
+    if (!family.empty())
+      cerr << "mzn-gen: unknown family `" << family << "'" << endl;
+    printHelp(cerr);
+    return EXIT_FAILURE;
+  }
+  if (output.empty())
+    output = family;
+
+  try {
+    // Generate the data first, the model does not depend on it
+    Random rnd(o.seed);
+    string dataFile = output + (fJSON ? ".json" : ".dzn");
+    ofstream ds(dataFile.c_str());
+    checkIOStatus (ds.good(), " I/O error: cannot open data file. ");
+    ostringstream ms;
+    ms << "% Generated by mzn-gen " << family << " with seed " << o.seed << "\n\n";
+    DataWriter dw(ds, fJSON);
+    if (!fJSON)
+      ds << "% Generated by mzn-gen " << family << " with seed " << o.seed << "\n";
+    f->generate(ms, dw, rnd, o);
+    dw.close();
+    checkIOStatus (ds.good(), " I/O error: cannot write data file. ");
+
+    string modelFile = output + ".mzn";
+    ofstream os(modelFile.c_str());
+    checkIOStatus (os.good(), " I/O error: cannot open model file. ");
+    os << ms.str();
+    checkIOStatus (os.good(), " I/O error: cannot write model file. ");
+  } catch (const Exception& e) {
+    cerr << e.what() << ": " << e.msg() << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
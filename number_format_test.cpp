@@ -0,0 +1,208 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Guido Tack <guido.tack@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Round-trip test and benchmark of NumberFormat.
+ *
+ * Formats random doubles (arbitrary bit patterns, uniform values scaled by
+ * powers of ten, and subnormals) and checks that each one reads back exactly
+ * through strtod, and that one significant digit less would not. Integers
+ * are compared against printf. Then reports the formatting throughput next
+ * to that of an ostringstream. Exits with 1 if any check fails.
+ */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <minizinc/number_format.hh>
+#include <minizinc/timer.hh>
+
+using namespace std;
+using namespace MiniZinc;
+
+namespace {
+
+  int nErrors = 0;
+
+  void fail(const string& what, const string& value, const string& got) {
+    if (++nErrors <= 20)
+      cerr << "number_format_test: " << what << " " << value << ": got " << got << endl;
+  }
+
+  string exact(double d) {
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%.17g", d);
+    return buf;
+  }
+
+  /// Number of significant digits of a %g-style number
+  int significantDigits(const char* s) {
+    string digits;
+    for (; *s && *s != 'e'; s++)
+      if (*s >= '0' && *s <= '9' && (*s != '0' || !digits.empty()))
+        digits += *s;
+    size_t last = digits.find_last_not_of('0');
+    return last == string::npos ? 0 : static_cast<int>(last+1);
+  }
+
+  void checkDouble(double d) {
+    char buf[NumberFormat::BUFSIZE];
+    int n = NumberFormat::doubleToChars(buf, d);
+    if (n != static_cast<int>(strlen(buf))) {
+      fail("length for", exact(d), buf);
+      return;
+    }
+    double r = strtod(buf, NULL);
+    if (r != d || signbit(r) != signbit(d)) {
+      fail("no round trip for", exact(d), buf);
+      return;
+    }
+    int digits = significantDigits(buf);
+    if (digits > 1) {
+      char shorter[40];
+      snprintf(shorter, sizeof(shorter), "%.*g", digits-1, d);
+      if (strtod(shorter, NULL) == d)
+        fail("not shortest for", exact(d), string(buf) + " instead of " + shorter);
+    }
+  }
+
+  void checkInt(long long int i) {
+    char buf[NumberFormat::BUFSIZE];
+    int n = NumberFormat::intToChars(buf, i);
+    char ref[32];
+    snprintf(ref, sizeof(ref), "%lld", i);
+    if (string(buf, n) != ref)
+      fail("wrong digits for", ref, string(buf, n));
+  }
+
+  double mbPerSec(size_t bytes, double ms) {
+    return ms > 0.0 ? bytes / 1e3 / ms : 0.0;
+  }
+
+  void benchmark(const vector<double>& values, const string& name) {
+    Timer t;
+    string s;
+    s.reserve(values.size()*24);
+    for (size_t i=0; i<values.size(); i++) {
+      NumberFormat::append(s, values[i], true);
+      s += ' ';
+    }
+    double msFormat = t.ms();
+    size_t bytes = s.size();
+    t.reset();
+    ostringstream oss;
+    oss << setprecision(17);
+    for (size_t i=0; i<values.size(); i++)
+      oss << values[i] << ' ';
+    double msStream = t.ms();
+    cout << "  " << setw(24) << left << name << right << fixed << setprecision(1)
+         << setw(8) << mbPerSec(bytes, msFormat) << " MB/s, ostringstream "
+         << setw(8) << mbPerSec(oss.str().size(), msStream) << " MB/s" << endl;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  long long int n = 200000;
+  unsigned long long int seed = 1;
+  for (int i=1; i<argc; i++) {
+    string arg(argv[i]);
+    if ((arg == "-n" || arg == "--count") && i+1 < argc) {
+      n = atoll(argv[++i]);
+    } else if (arg == "--seed" && i+1 < argc) {
+      seed = strtoull(argv[++i], NULL, 10);
+    } else {
+      cerr << "Usage: " << argv[0] << " [-n <count>] [--seed <n>]" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  mt19937_64 rnd(seed);
+
+  const double special[] = { 0.0, -0.0, 1.0, -1.0, 0.1, 0.2, 0.3, 1.0/3.0, 2.0/3.0,
+    0.1+0.2, 100.0, 1e15, 1e16, 1e17, 1e21, 1e22, 1e23, 5e-324, -5e-324,
+    DBL_MIN, DBL_MAX, -DBL_MAX, DBL_EPSILON, 9007199254740993.0, 123456789012345678.0,
+    2.2250738585072009e-308, 4.9406564584124654e-324, 1.7976931348623157e308 };
+  for (unsigned int i=0; i<sizeof(special)/sizeof(special[0]); i++)
+    checkDouble(special[i]);
+  const long long int specialInts[] = { 0, 1, -1, 9, 10, -10, 99, 100,
+    LLONG_MAX, LLONG_MIN, LLONG_MIN+1, 1000000000000000000LL };
+  for (unsigned int i=0; i<sizeof(specialInts)/sizeof(specialInts[0]); i++)
+    checkInt(specialInts[i]);
+
+  vector<double> bits, uniform, shortDecimals;
+  uniform_real_distribution<double> unit(0.0, 1.0);
+  uniform_int_distribution<int> exponent(-30, 30);
+  for (long long int i=0; i<n; i++) {
+    // arbitrary bit patterns, skipping infinities and NaNs
+    unsigned long long int b = rnd();
+    double d;
+    memcpy(&d, &b, sizeof(d));
+    if (std::isfinite(d)) {
+      checkDouble(d);
+      bits.push_back(d);
+    }
+    // uniform values over a range of magnitudes
+    d = unit(rnd) * pow(10.0, exponent(rnd));
+    checkDouble(d);
+    uniform.push_back(d);
+    // subnormals
+    b = rnd() & ((1ULL << 52) - 1);
+    memcpy(&d, &b, sizeof(d));
+    checkDouble(d);
+    // decimals with few digits, as in most models
+    d = static_cast<double>(static_cast<long long int>(rnd() % 200000) - 100000) / 100.0;
+    checkDouble(d);
+    shortDecimals.push_back(d);
+    checkInt(static_cast<long long int>(rnd()));
+    checkInt(static_cast<long long int>(rnd() % 2000001) - 1000000);
+  }
+
+  cout << "number_format_test: " << 4*n << " doubles and " << 2*n << " integers, "
+       << nErrors << " errors" << endl;
+  if (nErrors)
+    return EXIT_FAILURE;
+
+  benchmark(bits, "random bit patterns");
+  benchmark(uniform, "uniform");
+  benchmark(shortDecimals, "k/100");
+  vector<long long int> ints;
+  for (long long int i=0; i<n; i++)
+    ints.push_back(static_cast<long long int>(rnd() % 2000001) - 1000000);
+  Timer t;
+  string s;
+  for (size_t i=0; i<ints.size(); i++) {
+    NumberFormat::append(s, ints[i]);
+    s += ' ';
+  }
+  double msFormat = t.ms();
+  t.reset();
+  ostringstream oss;
+  for (size_t i=0; i<ints.size(); i++)
+    oss << ints[i] << ' ';
+  double msStream = t.ms();
+  cout << "  " << setw(24) << left << "integers" << right << fixed << setprecision(1)
+       << setw(8) << mbPerSec(s.size(), msFormat) << " MB/s, ostringstream "
+       << setw(8) << mbPerSec(oss.str().size(), msStream) << " MB/s" << endl;
+  return EXIT_SUCCESS;
+}
@@ -29,6 +29,7 @@
 // #include <minizinc/timer.hh>
 
 #include <minizinc/solns2out.hh>
+#include <minizinc/fzn_binary.hh>
 
 using namespace MiniZinc;
 using namespace std;
@@ -53,7 +54,7 @@ namespace MiniZinc {
       std::string executable_name(argv[0]);
       executable_name = executable_name.substr(executable_name.find_last_of("/\\") + 1);
       os << "Usage: " << executable_name
-            << " [<options>] <model>.ozn" << std::endl
+            << " [<options>] <model>.ozn|<model>.fzb" << std::endl
             << std::endl
             << "General options:" << std::endl
             << "  --help, -h\n    Print this help message." << std::endl
@@ -83,7 +84,8 @@ namespace MiniZinc {
         } else {
           filename = argv[i];
           if (filename.length()<=4 ||
-              filename.substr(filename.length()-4,string::npos) != ".ozn") {
+              (filename.substr(filename.length()-4,string::npos) != ".ozn" &&
+               filename.substr(filename.length()-4,string::npos) != ".fzb")) {
             std::cerr << "Invalid .ozn file " << filename << "." << std::endl;
             goto NotFound;
           }
@@ -152,8 +154,16 @@ namespace MiniZinc {
 
       {
         pEnv = new Env();
-        if (pOutput = parse(*pEnv, filenames, std::vector<std::string>(), includePaths, false, false, false,
-                                  std::cerr)) {
+        if (fileOzn.substr(fileOzn.length()-4,string::npos) == ".fzb") {
+          // Binary FlatZinc carries the output model as text
+          std::vector<SyntaxError> se;
+          pOutput = parseFromString(FznBinaryFile(fileOzn).output(), fileOzn, includePaths,
+                                    false, false, false, std::cerr, se);
+        } else {
+          pOutput = parse(*pEnv, filenames, std::vector<std::string>(), includePaths, false, false, false,
+                          std::cerr);
+        }
+        if (pOutput) {
           std::vector<TypeError> typeErrors;
           pEnv->model(pOutput);
           MZN_ASSERT_HARD_MSG( pEnv, "solns2out: could not allocate Env" );
@@ -45,6 +45,11 @@ string MIP_WrapperFactory::getVersion( ) {
   return v;
 }
 
+bool MIP_WrapperFactory::isForkSafe( ) {
+  // The CPLEX environment may hold threads and a license connection
+  return false;
+}
+
 void MIP_WrapperFactory::printHelp(ostream& os) {
   os
   << "IBM ILOG CPLEX  MIP wrapper options:" << std::endl
@@ -238,6 +243,41 @@ void MIP_cplex_wrapper::addRow
   }
 }
 
+void MIP_cplex_wrapper::doAddRows(const RowBuffer& rb)
+{
+  /// Rows with user cut / lazy flags go one by one, the rest in a single call
+  vector<int> rmatbeg, rmatind;
+  vector<double> rmatval, rhs;
+  vector<char> ssense;
+  vector<string> names;
+  const bool fNames = !sExportModel.empty();   // names only needed in the exported model
+  for (int i=0; i<rb.size(); ++i) {
+    if (MaskConsType_Normal != rb.mask[i]) {
+      vector<int> ind(rb.rmatind.begin()+rb.rowStarts[i], rb.rmatind.begin()+rb.rowStarts[i+1]);
+      vector<double> val(rb.rmatval.begin()+rb.rowStarts[i], rb.rmatval.begin()+rb.rowStarts[i+1]);
+      addRow(ind.size(), ind.data(), val.data(), rb.sense[i], rb.rhs[i],
+             rb.mask[i], rb.rowName(i));
+      continue;
+    }
+    rmatbeg.push_back(rmatind.size());
+    rmatind.insert(rmatind.end(), rb.rmatind.begin()+rb.rowStarts[i], rb.rmatind.begin()+rb.rowStarts[i+1]);
+    rmatval.insert(rmatval.end(), rb.rmatval.begin()+rb.rowStarts[i], rb.rmatval.begin()+rb.rowStarts[i+1]);
+    rhs.push_back(rb.rhs[i]);
+    ssense.push_back(getCPLEXConstrSense(rb.sense[i]));
+    if (fNames)
+      names.push_back(rb.rowName(i));
+  }
+  if (rhs.empty())
+    return;
+  vector<char*> pRNames;
+  for (auto& nm: names)
+    pRNames.push_back((char*)nm.c_str());
+  status = CPXaddrows (env, lp, 0, rhs.size(), rmatind.size(), rhs.data(),
+      ssense.data(), rmatbeg.data(), rmatind.data(), rmatval.data(),
+      NULL, fNames ? pRNames.data() : NULL);
+  wrap_assert( !status,  "Failed to add constraints." );
+}
+
 
 /// SolutionCallback ------------------------------------------------------------------------
 /// CPLEX ensures thread-safety
@@ -690,6 +730,15 @@ void MIP_cplex_wrapper::solve() {  // Move into ancestor?
      wrap_assert(!status, "Failed to write CPLEX parameters.", false);
     }
     
+   if ( mipStart.cols.size() ) {
+     int beg = 0;
+     int effort = CPX_MIPSTART_AUTO;
+     status = CPXaddmipstarts (env, lp, 1, mipStart.cols.size(), &beg,
+                               mipStart.cols.data(), mipStart.vals.data(), &effort, NULL);
+     wrap_assert(!status, "Failed to add the MIP start.", false);
+     mipStart.status = status ? MIPStart::REJECTED : MIPStart::PASSED;
+   }
+
    status = CPXgettime (env, &output.dCPUTime);
    wrap_assert(!status, "Failed to get time stamp.", false);
 
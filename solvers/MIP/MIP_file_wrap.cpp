@@ -0,0 +1,360 @@
+// * -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Gleb Belov <gleb.belov@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <chrono>
+#include <stdexcept>
+
+using namespace std;
+
+#include <minizinc/solvers/MIP/MIP_file_wrap.hh>
+#include <minizinc/utils.hh>
+
+/// Linking this module provides these functions:
+MIP_wrapper* MIP_WrapperFactory::GetDefaultMIPWrapper() {
+  return new MIP_file_wrapper;
+}
+
+string MIP_WrapperFactory::getVersion( ) {
+  string v = "  MIP wrapper writing MPS/LP files, no solver";
+  v += "  Compiled  " __DATE__ "  " __TIME__;
+  return v;
+}
+
+bool MIP_WrapperFactory::isForkSafe( ) {
+  return true;
+}
+
+void MIP_WrapperFactory::printHelp(ostream& os) {
+  os
+  << "MIP file writer options:" << std::endl
+  << "--writeModel <file>   write model to <file>: CPLEX LP format if it ends with .lp,\n"
+     "      otherwise free MPS. \"-\" writes MPS to stdout, without a status line. No solving is done." << std::endl
+  << std::endl;
+}
+
+ static   string sExportModel;
+
+bool MIP_WrapperFactory::processOption(int& i, int argc, const char** argv) {
+  MiniZinc::CLOParser cop( i, argc, argv );
+  if ( string(argv[i])=="-a"
+      || string(argv[i])=="--all"
+      || string(argv[i])=="--all-solutions" ) {
+  } else if (string(argv[i])=="-f") {
+  } else if ( cop.get( "--writeModel", &sExportModel ) ) {
+  } else
+    return false;
+  return true;
+}
+
+namespace {
+  /// Collects output in a large buffer and writes it in big chunks
+  class BufferedWriter {
+    FILE* f;
+    string buf;
+    long nLineStart = 0;     // position of the current line in buf, can be before it
+    static const size_t nChunk = 1<<20;
+  public:
+    BufferedWriter(FILE* f0) : f(f0) { buf.reserve(nChunk + 1024); }
+    void flush() {
+      if (buf.size() && buf.size()!=fwrite(buf.data(), 1, buf.size(), f))
+        throw runtime_error("  MIP_file_wrapper: failed writing the model");
+      nLineStart -= buf.size();
+      buf.clear();
+    }
+    BufferedWriter& operator<<(const string& s) {
+      buf += s;
+      if (buf.size() >= nChunk)
+        flush();
+      return *this;
+    }
+    BufferedWriter& operator<<(const char* s) {
+      buf += s;
+      if (buf.size() >= nChunk)
+        flush();
+      return *this;
+    }
+    /// shortest of %.15g / %.17g which reads back exactly; no "-0"
+    BufferedWriter& operator<<(double v) {
+      if (0.0 == v)
+        v = 0.0;
+      char s[32];
+      snprintf(s, sizeof(s), "%.15g", v);
+      if (strtod(s, 0) != v)
+        snprintf(s, sizeof(s), "%.17g", v);
+      return *this << (const char*)s;
+    }
+    void newLine() {
+      buf += '\n';
+      nLineStart = buf.size();
+    }
+    long lineLength() const { return long(buf.size()) - nLineStart; }
+  };
+
+  /// Make a name acceptable for MPS and LP: no spaces or operators,
+  /// not starting with a digit or a period
+  string sanitizeName(const string& nm, const char* prefix, int idx) {
+    if (nm.empty()) {
+      ostringstream oss;
+      oss << prefix << idx;
+      return oss.str();
+    }
+    string res = nm;
+    for (auto& c: res)
+      if (!isalnum((unsigned char)c) && '_'!=c && '.'!=c)
+        c = '_';
+    if (isdigit((unsigned char)res[0]) || '.'==res[0])
+      res.insert(0, "_");
+    return res;
+  }
+}
+
+string MIP_file_wrapper::colName(int j) const {
+  return sanitizeName(colNames[j], "x", j);
+}
+
+string MIP_file_wrapper::rowName(int i) const {
+  return sanitizeName(rowNames[i], "r", i);
+}
+
+void MIP_file_wrapper::addRow
+  (int nnz, int* rmatind, double* rmatval, MIP_wrapper::LinConType sense,
+   double rhs, int mask, string rowName)
+{
+  // User cuts and lazy constraints are valid for the model, so written as normal rows
+  rowStarts.push_back(columns.size());
+  columns.insert(columns.end(), rmatind, rmatind + nnz);
+  element.insert(element.end(), rmatval, rmatval + nnz);
+  rowSense.push_back(sense);
+  rowRHS.push_back(rhs);
+  rowNames.push_back(rowName);
+}
+
+void MIP_file_wrapper::doAddRows(const RowBuffer& rb)
+{
+  const int nnz0 = columns.size();
+  for (int i=0; i<rb.size(); ++i) {
+    rowStarts.push_back(nnz0 + rb.rowStarts[i]);
+    rowNames.push_back(rb.rowName(i));
+  }
+  columns.insert(columns.end(), rb.rmatind.begin(), rb.rmatind.end());
+  element.insert(element.end(), rb.rmatval.begin(), rb.rmatval.end());
+  rowSense.insert(rowSense.end(), rb.sense.begin(), rb.sense.end());
+  rowRHS.insert(rowRHS.end(), rb.rhs.begin(), rb.rhs.end());
+}
+
+void MIP_file_wrapper::solve() {
+  if (sExportModel.empty())
+    throw runtime_error("  MIP_file_wrapper: no output file given, use --writeModel <file>");
+  auto t0 = std::chrono::steady_clock::now();
+  const bool fLP = sExportModel.size()>=3 &&
+    0==sExportModel.compare(sExportModel.size()-3, 3, ".lp");
+  const bool fStdout = ("-"==sExportModel);
+  FILE* f = fStdout ? stdout : fopen(sExportModel.c_str(), "wb");
+  if (0==f)
+    throw runtime_error("  MIP_file_wrapper: cannot open '" + sExportModel + "' for writing");
+  rowStarts.push_back(columns.size());    // end of the last row
+  try {
+    if (fLP)
+      writeLP(f);
+    else
+      writeMPS(f);
+  } catch (...) {
+    rowStarts.pop_back();
+    if (!fStdout)
+      fclose(f);
+    throw;
+  }
+  rowStarts.pop_back();
+  if (fStdout)
+    fflush(f);
+  else if (fclose(f))
+    throw runtime_error("  MIP_file_wrapper: failed writing '" + sExportModel + "'");
+  output.dCPUTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  if (fVerbose)
+    cerr << "  MIP_file_wrapper: written " << getNRows() << " rows, " << getNCols()
+      << " columns, " << columns.size() << " nonzeros to '" << sExportModel
+      << "' in " << output.dCPUTime << " sec" << endl;
+  output.status = UNKNOWN;
+  output.statusName = "Model written, not solved";
+  output.fModelOnStdout = fStdout;
+  output.nCols = colObj.size();
+}
+
+void MIP_file_wrapper::writeMPS(FILE* f)
+{
+  const int nRows = getNRows(), nCols = getNCols();
+  const double dInf = getInfBound();
+  /// The COLUMNS section is column-wise, so transpose the rows first
+  vector<int> colStarts(nCols+1, 0);
+  for (auto j: columns)
+    ++colStarts[j+1];
+  for (int j=0; j<nCols; ++j)
+    colStarts[j+1] += colStarts[j];
+  vector<int> rowIdx(columns.size());
+  vector<double> colElement(columns.size());
+  {
+    vector<int> pos(colStarts.begin(), colStarts.end()-1);
+    for (int i=0; i<nRows; ++i)
+      for (int k=rowStarts[i]; k<rowStarts[i+1]; ++k) {
+        int p = pos[columns[k]]++;
+        rowIdx[p] = i;
+        colElement[p] = element[k];
+      }
+  }
+  vector<string> rNames(nRows);
+  for (int i=0; i<nRows; ++i)
+    rNames[i] = rowName(i);
+
+  BufferedWriter w(f);
+  w << "NAME MINIZINC\n";
+  if (objSense > 0 && nProbType)
+    w << "OBJSENSE\n    MAX\n";
+  w << "ROWS\n N  obj\n";
+  for (int i=0; i<nRows; ++i)
+    w << (LQ==rowSense[i] ? " L  " : GQ==rowSense[i] ? " G  " : " E  ") << rNames[i] << "\n";
+  w << "COLUMNS\n";
+  bool fIntBlock = false;
+  for (int j=0; j<nCols; ++j) {
+    const bool fInt = (REAL!=colTypes[j]);
+    if (fInt != fIntBlock) {
+      w << (fInt ? "    MARKER  'MARKER'  'INTORG'\n" : "    MARKER  'MARKER'  'INTEND'\n");
+      fIntBlock = fInt;
+    }
+    const string cn = colName(j);
+    /// Every column is mentioned at least once, so its type is known
+    if ((nProbType && 0.0!=colObj[j]) || colStarts[j]==colStarts[j+1])
+      w << "    " << cn << "  obj  " << (nProbType ? colObj[j] : 0.0) << "\n";
+    for (int k=colStarts[j]; k<colStarts[j+1]; ++k)
+      w << "    " << cn << "  " << rNames[rowIdx[k]] << "  " << colElement[k] << "\n";
+  }
+  if (fIntBlock)
+    w << "    MARKER  'MARKER'  'INTEND'\n";
+  w << "RHS\n";
+  for (int i=0; i<nRows; ++i)
+    if (0.0 != rowRHS[i])
+      w << "    RHS  " << rNames[i] << "  " << rowRHS[i] << "\n";
+  w << "BOUNDS\n";
+  for (int j=0; j<nCols; ++j) {
+    const string cn = colName(j);
+    const double lb = colLB[j], ub = colUB[j];
+    if (lb == ub) {
+      w << " FX BND  " << cn << "  " << lb << "\n";
+    } else if (lb <= -dInf && ub >= dInf) {
+      w << " FR BND  " << cn << "\n";
+    } else {
+      /// Integer columns get both bounds explicitly: readers differ in the defaults
+      if (lb <= -dInf)
+        w << " MI BND  " << cn << "\n";
+      else if (0.0 != lb || REAL!=colTypes[j])
+        w << " LO BND  " << cn << "  " << lb << "\n";
+      if (ub < dInf)
+        w << " UP BND  " << cn << "  " << ub << "\n";
+      else if (REAL!=colTypes[j])
+        w << " PL BND  " << cn << "\n";
+    }
+  }
+  w << "ENDATA\n";
+  w.flush();
+}
+
+void MIP_file_wrapper::writeLP(FILE* f)
+{
+  const int nRows = getNRows(), nCols = getNCols();
+  const double dInf = getInfBound();
+  /// CPLEX limits LP lines to 510 characters
+  const long nMaxLine = 200;
+  BufferedWriter w(f);
+  auto writeTerm = [&](double c, int j) {
+    if (w.lineLength() > nMaxLine) {
+      w.newLine();
+      w << "  ";
+    }
+    if (c < 0.0)
+      w << " - " << -c;
+    else
+      w << " + " << c;
+    w << " " << colName(j);
+  };
+  w << "\\ Written by the MiniZinc MIP file writer\n";
+  w << (objSense > 0 && nProbType ? "Maximize\n" : "Minimize\n");
+  w << " obj:";
+  bool fEmpty = true;
+  if (nProbType)
+    for (int j=0; j<nCols; ++j)
+      if (0.0 != colObj[j]) {
+        writeTerm(colObj[j], j);
+        fEmpty = false;
+      }
+  if (fEmpty && nCols)
+    w << " 0 " << colName(0);
+  w.newLine();
+  w << "Subject To\n";
+  for (int i=0; i<nRows; ++i) {
+    w << " " << rowName(i) << ":";
+    for (int k=rowStarts[i]; k<rowStarts[i+1]; ++k)
+      writeTerm(element[k], columns[k]);
+    if (rowStarts[i]==rowStarts[i+1] && nCols)
+      w << " 0 " << colName(0);
+    w << (LQ==rowSense[i] ? " <= " : GQ==rowSense[i] ? " >= " : " = ") << rowRHS[i];
+    w.newLine();
+  }
+  w << "Bounds\n";
+  for (int j=0; j<nCols; ++j) {
+    const string cn = colName(j);
+    const double lb = colLB[j], ub = colUB[j];
+    if (lb == ub)
+      w << " " << cn << " = " << lb << "\n";
+    else if (lb <= -dInf && ub >= dInf)
+      w << " " << cn << " free\n";
+    else {
+      w << " ";
+      if (lb <= -dInf)
+        w << "-inf";
+      else
+        w << lb;
+      w << " <= " << cn << " <= ";
+      if (ub >= dInf)
+        w << "+inf";
+      else
+        w << ub;
+      w << "\n";
+    }
+  }
+  for (int t=INT; t<=BINARY; ++t) {
+    bool fHeader = false;
+    for (int j=0; j<nCols; ++j)
+      if (t==colTypes[j]) {
+        if (!fHeader) {
+          w << (INT==t ? "Generals" : "Binaries");
+          w.newLine();
+          fHeader = true;
+        }
+        if (w.lineLength() > nMaxLine)
+          w.newLine();
+        w << " " << colName(j);
+      }
+    if (fHeader)
+      w.newLine();
+  }
+  w << "End\n";
+  w.flush();
+}
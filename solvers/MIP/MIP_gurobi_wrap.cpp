@@ -54,6 +54,11 @@ string MIP_WrapperFactory::getVersion( ) {
   return oss.str();
 }
 
+bool MIP_WrapperFactory::isForkSafe( ) {
+  // The Gurobi environment may hold threads and a license connection
+  return false;
+}
+
 void MIP_WrapperFactory::printHelp(ostream& os) {
   os
   << "GUROBI MIP wrapper options:" << std::endl
@@ -180,6 +185,7 @@ void MIP_gurobi_wrapper::openGUROBI()
   }
   
   *(void**)(&dll_GRBaddconstr) = dll_sym(gurobi_dll, "GRBaddconstr");
+  *(void**)(&dll_GRBaddconstrs) = dll_sym(gurobi_dll, "GRBaddconstrs");
   *(void**)(&dll_GRBaddvars) = dll_sym(gurobi_dll, "GRBaddvars");
   *(void**)(&dll_GRBcbcut) = dll_sym(gurobi_dll, "GRBcbcut");
   *(void**)(&dll_GRBcbget) = dll_sym(gurobi_dll, "GRBcbget");
@@ -199,6 +205,7 @@ void MIP_gurobi_wrapper::openGUROBI()
   *(void**)(&dll_GRBsetdblparam) = dll_sym(gurobi_dll, "GRBsetdblparam");
   *(void**)(&dll_GRBsetintattr) = dll_sym(gurobi_dll, "GRBsetintattr");
   *(void**)(&dll_GRBsetintattrlist) = dll_sym(gurobi_dll, "GRBsetintattrlist");
+  *(void**)(&dll_GRBsetdblattrlist) = dll_sym(gurobi_dll, "GRBsetdblattrlist");
   *(void**)(&dll_GRBsetintparam) = dll_sym(gurobi_dll, "GRBsetintparam");
   *(void**)(&dll_GRBsetstrparam) = dll_sym(gurobi_dll, "GRBsetstrparam");
   *(void**)(&dll_GRBupdatemodel) = dll_sym(gurobi_dll, "GRBupdatemodel");
@@ -208,6 +215,7 @@ void MIP_gurobi_wrapper::openGUROBI()
 #else
 
   dll_GRBaddconstr = GRBaddconstr;
+  dll_GRBaddconstrs = GRBaddconstrs;
   dll_GRBaddvars = GRBaddvars;
   dll_GRBcbcut = GRBcbcut;
   dll_GRBcbget = GRBcbget;
@@ -227,6 +235,7 @@ void MIP_gurobi_wrapper::openGUROBI()
   dll_GRBsetdblparam = GRBsetdblparam;
   dll_GRBsetintattr = GRBsetintattr;
   dll_GRBsetintattrlist = GRBsetintattrlist;
+  dll_GRBsetdblattrlist = GRBsetdblattrlist;
   dll_GRBsetintparam = GRBsetintparam;
   dll_GRBsetstrparam = GRBsetstrparam;
   dll_GRBupdatemodel = GRBupdatemodel;
@@ -323,6 +332,36 @@ void MIP_gurobi_wrapper::addRow
   const char * pRName = rowName.c_str();
   error = dll_GRBaddconstr(model, nnz, rmatind, rmatval, ssense, rhs, pRName);
   wrap_assert( !error,  "Failed to add constraint." );
+  markLazy(nRows-1, mask);
+}
+
+void MIP_gurobi_wrapper::doAddRows(const RowBuffer& rb)
+{
+  vector<char> ssense(rb.size());
+  for (int i=0; i<rb.size(); ++i)
+    ssense[i] = getGRBSense(rb.sense[i]);
+  /// Names are only needed in the exported model
+  vector<string> names;
+  vector<const char*> pRNames;
+  if (sExportModel.size()) {
+    names.reserve(rb.size());
+    for (int i=0; i<rb.size(); ++i) {
+      names.push_back(rb.rowName(i));
+      pRNames.push_back(names.back().c_str());
+    }
+  }
+  error = dll_GRBaddconstrs(model, rb.size(), rb.rmatind.size(),
+                            (int*)rb.rowStarts.data(), (int*)rb.rmatind.data(), (double*)rb.rmatval.data(),
+                            ssense.data(), (double*)rb.rhs.data(),
+                            pRNames.empty() ? NULL : pRNames.data());
+  wrap_assert( !error,  "Failed to add constraints." );
+  for (int i=0; i<rb.size(); ++i)
+    markLazy(nRows+i, rb.mask[i]);
+  nRows += rb.size();
+}
+
+void MIP_gurobi_wrapper::markLazy(int iRow, int mask)
+{
   int nLazyAttr=0;
   const bool fUser = (MaskConsType_Usercut & mask);
   const bool fLazy = (MaskConsType_Lazy & mask);
@@ -336,7 +375,7 @@ void MIP_gurobi_wrapper::addRow
     if (fLazy)
       nLazyAttr = 1;  // very lazy
   if (nLazyAttr) {
-    nLazyIdx.push_back( nRows-1 );
+    nLazyIdx.push_back( iRow );
     nLazyValue.push_back( nLazyAttr );
   }
 }
@@ -501,6 +540,14 @@ void MIP_gurobi_wrapper::solve() {  // Move into ancestor?
       wrap_assert( !error,  "Failed to update model after modifying some constraint attr." );
    }
 
+   /// MIP start, the values not given are left undefined
+   if ( mipStart.cols.size() ) {
+      error = dll_GRBsetdblattrlist(model, GRB_DBL_ATTR_START, mipStart.cols.size(),
+                                    mipStart.cols.data(), mipStart.vals.data());
+      wrap_assert( !error,  "Failed to set the MIP start.", false );
+      mipStart.status = error ? MIPStart::REJECTED : MIPStart::PASSED;
+   }
+
   /////////////// Last-minute solver options //////////////////
   /* Turn on output to file */
    error = dll_GRBsetstrparam(dll_GRBgetenv(model), "LogFile", "");  // FAILS to switch off in Ubuntu 15.04
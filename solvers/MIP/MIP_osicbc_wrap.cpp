@@ -51,6 +51,10 @@ string MIP_WrapperFactory::getVersion( ) {
   return v;
 }
 
+bool MIP_WrapperFactory::isForkSafe( ) {
+  return true;
+}
+
 void MIP_WrapperFactory::printHelp(ostream& os) {
   os
   << "OSICBC MIP wrapper options:" << std::endl
@@ -154,13 +158,9 @@ void MIP_osicbc_wrapper::doAddVars
 //   wrap_assert( !status,  "Failed to declare variables." );
 }
 
-void MIP_osicbc_wrapper::addRow
-  (int nnz, int* rmatind, double* rmatval, MIP_wrapper::LinConType sense,
-   double rhs, int mask, string rowName)
+void MIP_osicbc_wrapper::addRowBounds(MIP_wrapper::LinConType sense, double rhs)
 {
-  /// Convert var types:
   double rlb=rhs, rub=rhs;
-  char ssense=0;
     switch (sense) {
       case LQ:
         rlb = -osi.getInfinity();
@@ -173,6 +173,14 @@ void MIP_osicbc_wrapper::addRow
       default:
         throw runtime_error("  MIP_wrapper: unknown constraint type");
     }
+  rowlb.push_back(rlb);
+  rowub.push_back(rub);
+}
+
+void MIP_osicbc_wrapper::addRow
+  (int nnz, int* rmatind, double* rmatval, MIP_wrapper::LinConType sense,
+   double rhs, int mask, string rowName)
+{
   // ignoring mask for now.  TODO
   // 1-by-1 too slow:
 //   try {
@@ -182,13 +190,25 @@ void MIP_osicbc_wrapper::addRow
 //     cerr << "  COIN-OR Error: " << err.message() << endl;
 //     throw runtime_error(err.message());
 //   }
-  /// Segfault:
-//   rowStarts.push_back(columns.size());
-//   columns.insert(columns.end(), rmatind, rmatind + nnz);
-//   element.insert(element.end(), rmatval, rmatval + nnz);
-  rows.push_back(CoinPackedVector(nnz, rmatind, rmatval));
-  rowlb.push_back(rlb);
-  rowub.push_back(rub);
+  addRowBounds(sense, rhs);
+  rowStarts.push_back(columns.size());
+  columns.insert(columns.end(), rmatind, rmatind + nnz);
+  element.insert(element.end(), rmatval, rmatval + nnz);
+}
+
+void MIP_osicbc_wrapper::doAddRows(const RowBuffer& rb)
+{
+  // ignoring mask and names, as in addRow()
+  const int nnz0 = columns.size();
+  rowStarts.reserve(rowStarts.size() + rb.size());
+  rowlb.reserve(rowlb.size() + rb.size());
+  rowub.reserve(rowub.size() + rb.size());
+  for (int i=0; i<rb.size(); ++i) {
+    addRowBounds(rb.sense[i], rb.rhs[i]);
+    rowStarts.push_back(nnz0 + rb.rowStarts[i]);
+  }
+  columns.insert(columns.end(), rb.rmatind.begin(), rb.rmatind.end());
+  element.insert(element.end(), rb.rmatval.begin(), rb.rmatval.end());
 }
 
 
@@ -295,6 +315,8 @@ extern "C" {
 struct EventUserInfo {
   MIP_wrapper::CBUserInfo* pCbui=0;
   CglPreProcess* pPP=0; 
+  /// Pass the solutions to solcbfn, otherwise to incumbentfn
+  bool fAllSolutions = false;
 };
 
 extern CglPreProcess * cbcPreProcessPointer;
@@ -403,6 +425,21 @@ MyEventHandler3::event(CbcEvent whichEvent)
       signal(SIGINT, saveSignal);
       statusOfCbc=2;
     }
+    if ((whichEvent==node||whichEvent==treeStatus) && ui.pCbui->objcutfn) {
+      double objExt;
+      if ((*(ui.pCbui->objcutfn))(objExt, ui.pCbui->ppp)) {
+        // Back to Cbc's minimization form, the inverse of objVal below
+        double objOffset=0;
+        model_->solver()->getDblParam(OsiObjOffset, objOffset);
+        double objSense = model_->getObjSense();
+        if ( 0!=cbcPreProcessPointer )
+          if ( OsiSolverInterface* cbcPreOrig = cbcPreProcessPointer->originalModel() )
+            objSense = cbcPreOrig->getObjSense();
+        const double cutoff = objExt * objSense + objOffset;
+        if ( cutoff < model_->getCutoff() )
+          model_->setCutoff( cutoff );
+      }
+    }
     if (whichEvent==solution||whichEvent==heuristicSolution) {
 #ifdef STOP_EARLY
       return stop; // say finished
@@ -486,8 +523,10 @@ MyEventHandler3::event(CbcEvent whichEvent)
       ui.pCbui->pOutput->nOpenNodes = -1; // model_->getNodeCount2();
 
       /// Call the user function:
-      if (ui.pCbui->solcbfn)
+      if (ui.fAllSolutions && ui.pCbui->solcbfn)
           (*(ui.pCbui->solcbfn))(*(ui.pCbui->pOutput), ui.pCbui->ppp);
+      else if (ui.pCbui->incumbentfn)
+          (*(ui.pCbui->incumbentfn))(*(ui.pCbui->pOutput), ui.pCbui->ppp);
 #endif
       return noAction; // carry on
 #endif
@@ -660,23 +699,18 @@ void MIP_osicbc_wrapper::solve() {  // Move into ancestor?
   if ( flag_all_solutions && 0==nProbType )
     cerr << "WARNING. --all-solutions for SAT problems not implemented." << endl;
   try {
-    /// Not using CoinPackedMatrix any more, so need to add all constraints at once:
-    /// But this gives segf:
-//     osi.addRows(rowStarts.size(), rowStarts.data(),
-//                 columns.data(), element.data(), rowlb.data(), rowub.data());
-    /// So:
     MIP_wrapper::addPhase1Vars();         // only now
     if (fVerbose)
       cerr << "  MIP_osicbc_wrapper: adding constraints physically..." << flush;
-    vector<CoinPackedVectorBase*> pRows(rowlb.size());
-    for (int i=0; i<rowlb.size(); ++i)
-      pRows[i] = &rows[i];
-    osi.addRows(rowlb.size(), pRows.data(), rowlb.data(), rowub.data());
-//     rowStarts.clear();
-//     columns.clear();
-//     element.clear();
-    pRows.clear();
-    rows.clear();
+    /// Not using CoinPackedMatrix any more, so need to add all constraints at once.
+    /// The row starts need the end of the last row as well:
+    const int nRowsNew = rowlb.size();
+    rowStarts.push_back(columns.size());
+    osi.addRows(nRowsNew, rowStarts.data(),
+                columns.data(), element.data(), rowlb.data(), rowub.data());
+    rowStarts.clear();
+    columns.clear();
+    element.clear();
     rowlb.clear();
     rowub.clear();
     if (fVerbose)
@@ -742,6 +776,14 @@ void MIP_osicbc_wrapper::solve() {  // Move into ancestor?
       model.setAllowableFractionGap( relGap );
     if ( intTol>=0.0 )
       model.setIntegerTolerance( intTol );
+    /// MIP start, by column names as CbcMain1 matches them
+    if ( mipStart.cols.size() ) {
+      std::vector< std::pair< std::string, double > > mips;
+      for ( size_t k=0; k<mipStart.cols.size(); ++k )
+        mips.push_back( std::make_pair( osi.getColName( mipStart.cols[k] ), mipStart.vals[k] ) );
+      model.setMIPStart( mips );
+      mipStart.status = MIPStart::PASSED;
+    }
 //     model.setCutoffIncrement( objDiff );
     
     CoinMessageHandler msgStderr(stderr);
@@ -793,10 +835,11 @@ void MIP_osicbc_wrapper::solve() {  // Move into ancestor?
 //    output.x = &x[0];
 
 #ifdef WANT_SOLUTION
-   if (flag_all_solutions && cbui.solcbfn) {
+   if ((flag_all_solutions && cbui.solcbfn) || cbui.incumbentfn || cbui.objcutfn) {
      // Event handler. Should be after CbcMain0()?
      EventUserInfo ui;
      ui.pCbui = &cbui;
+     ui.fAllSolutions = flag_all_solutions;
 //      ui.pPP = 0;
      MyEventHandler3 eventHandler(&model, ui);
      model.passInEventHandler(&eventHandler);
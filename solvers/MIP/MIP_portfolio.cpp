@@ -0,0 +1,418 @@
+// * -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+
+/*
+ *  Main authors:
+ *     Gleb Belov <gleb.belov@monash.edu>
+ */
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/select.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+using namespace std;
+
+#include <minizinc/solvers/MIP/MIP_portfolio.hh>
+
+namespace {
+  /// Split a configuration string into arguments. Single and double quotes group words
+  vector<string> splitArgs(const string& s) {
+    vector<string> args;
+    string arg;
+    bool fArg = false;
+    char quote = 0;
+    for (char c : s) {
+      if (quote) {
+        if (c == quote)
+          quote = 0;
+        else
+          arg += c;
+      } else if (c == '\'' || c == '"') {
+        quote = c;
+        fArg = true;
+      } else if (isspace(static_cast<unsigned char>(c))) {
+        if (fArg)
+          args.push_back(arg);
+        arg.clear();
+        fArg = false;
+      } else {
+        arg += c;
+        fArg = true;
+      }
+    }
+    if (fArg)
+      args.push_back(arg);
+    return args;
+  }
+
+#ifndef _WIN32
+  /// Message from a member to the parent: this header, nCols doubles, nName chars.
+  /// MSG_SOLUTION goes to the solution callback, MSG_INCUMBENT is only shared
+  enum MsgType { MSG_SOLUTION, MSG_INCUMBENT, MSG_FINISHED };
+  struct MsgHeader {
+    int type;
+    int status;
+    double objVal, bestBound, dCPUTime;
+    int nNodes, nOpenNodes;
+    int nCols, nName;
+  };
+
+  bool writeAll(int fd, const void* buf, size_t n) {
+    const char* p = static_cast<const char*>(buf);
+    while (n) {
+      ssize_t k = write(fd, p, n);
+      if (k < 0) {
+        if (EINTR == errno)
+          continue;
+        return false;
+      }
+      p += k;
+      n -= k;
+    }
+    return true;
+  }
+  /// Returns false on end of file or error
+  bool readAll(int fd, void* buf, size_t n) {
+    char* p = static_cast<char*>(buf);
+    while (n) {
+      ssize_t k = read(fd, p, n);
+      if (k < 0 && EINTR == errno)
+        continue;
+      if (k <= 0)
+        return false;
+      p += k;
+      n -= k;
+    }
+    return true;
+  }
+
+  bool sendOutput(int fd, MsgType type, const MIP_wrapper::Output& out, int nCols) {
+    MsgHeader h;
+    h.type = type;
+    h.status = out.status;
+    h.objVal = out.objVal;
+    h.bestBound = out.bestBound;
+    h.dCPUTime = out.dCPUTime;
+    h.nNodes = out.nNodes;
+    h.nOpenNodes = out.nOpenNodes;
+    h.nCols = out.x ? nCols : 0;
+    h.nName = out.statusName.size();
+    return writeAll(fd, &h, sizeof(h))
+      && writeAll(fd, out.x, h.nCols * sizeof(double))
+      && writeAll(fd, out.statusName.data(), h.nName);
+  }
+
+  /// The member's ends of its pipes, its number of columns and objective sense
+  int fdMember = -1, fdMemberIn = -1;
+  int nColsMember = 0;
+  int nProbTypeMember = 0;
+  /// Solution callback in a member: pass the solution on to the parent
+  void memberSolutionCallback(const MIP_wrapper::Output& out, void* ) {
+    sendOutput(fdMember, MSG_SOLUTION, out, nColsMember);
+  }
+  void memberIncumbentCallback(const MIP_wrapper::Output& out, void* ) {
+    sendOutput(fdMember, MSG_INCUMBENT, out, nColsMember);
+  }
+  /// Objective cutoff in a member: the best of the values the parent has sent
+  /// since the last call, which are objective values of the other members' incumbents
+  bool memberObjCutoff(double& objVal, void* ) {
+    bool fNew = false;
+    double d;
+    while (sizeof(d) == read(fdMemberIn, &d, sizeof(d))) {
+      if ( !fNew || ( nProbTypeMember > 0 ? d > objVal : d < objVal ) )
+        objVal = d;
+      fNew = true;
+    }
+    return fNew;
+  }
+#endif
+}
+
+void MIP_portfolio::applyConfig(int iCfg) {
+  vector<string> args = splitArgs(aConfigs[iCfg]);
+  vector<const char*> argv(1, "portfolio");
+  for (const auto& a : args)
+    argv.push_back(a.c_str());
+  const int argc = argv.size();
+  for (int i=1; i<argc; ++i) {
+    if (!MIP_WrapperFactory::processOption(i, argc, argv.data()))
+      cerr << "  MIP_portfolio: configuration " << (iCfg+1)
+        << ": unrecognized option or bad format `" << argv[i] << "'" << endl;
+  }
+}
+
+#ifdef _WIN32
+
+void MIP_portfolio::runMember(int , int , int ) { }
+
+bool MIP_portfolio::solve() {
+  return false;
+}
+
+#else
+
+void MIP_portfolio::runMember(int iCfg, int fd, int fdIn) {
+  dup2(2, 1);                      // stdout carries the solutions of the parent only
+  iMember = iCfg;
+  applyConfig(iCfg);
+  if (pMIP->fVerbose)
+    cerr << "  MIP_portfolio: configuration " << (iCfg+1) << " started, options '"
+      << aConfigs[iCfg] << "'" << endl;
+  fdMember = fd;
+  fdMemberIn = fdIn;
+  fcntl(fdIn, F_SETFL, fcntl(fdIn, F_GETFL) | O_NONBLOCK);
+  nColsMember = pMIP->colObj.size();
+  nProbTypeMember = pMIP->nProbType;
+  pMIP->cbui.pOutput = &pMIP->output;
+  if (pMIP->cbui.solcbfn)
+    pMIP->cbui.solcbfn = memberSolutionCallback;
+  pMIP->cbui.incumbentfn = memberIncumbentCallback;
+  if (nProbTypeMember)
+    pMIP->cbui.objcutfn = memberObjCutoff;
+  try {
+    pMIP->solve();
+  } catch (const exception& e) {
+    pMIP->output.status = MIP_wrapper::__ERROR;
+    pMIP->output.statusName = e.what();
+  }
+  sendOutput(fd, MSG_FINISHED, pMIP->output, nColsMember);
+  cerr.flush();
+  cout.flush();
+}
+
+bool MIP_portfolio::solve() {
+  if (!MIP_WrapperFactory::isForkSafe())
+    return false;
+  const int n = aConfigs.size();
+  const int nProbType = pMIP->nProbType;
+  MIP_wrapper::Output& out = pMIP->output;
+  vector<pid_t> aPid(n, -1);
+  vector<int> aFd(n, -1);            // from the members
+  vector<int> aFdOut(n, -1);         // to the members: incumbent values of the others
+  vector<bool> aCutoffSent(n, false);
+  cout.flush();
+  cerr.flush();
+  fflush(stdout);
+  fflush(stderr);
+  for (int k=0; k<n; ++k) {
+    int fds[2], fdsOut[2];
+    pid_t pid = -1;
+    if (0==pipe(fds)) {
+      if (0==pipe(fdsOut)) {
+        pid = fork();
+        if (0==pid) {
+          close(fds[0]);
+          close(fdsOut[1]);
+          for (int j=0; j<k; ++j) {
+            if (aFd[j] >= 0)
+              close(aFd[j]);
+            if (aFdOut[j] >= 0)
+              close(aFdOut[j]);
+          }
+          runMember(k, fds[1], fdsOut[0]);
+          _exit(0);
+        }
+        close(fdsOut[0]);
+        if (pid < 0)
+          close(fdsOut[1]);
+        else {
+          // A member which does not poll must not block the parent
+          fcntl(fdsOut[1], F_SETFL, fcntl(fdsOut[1], F_GETFL) | O_NONBLOCK);
+          aFdOut[k] = fdsOut[1];
+        }
+      }
+      close(fds[1]);
+      if (pid < 0)
+        close(fds[0]);
+      else
+        aFd[k] = fds[0];
+    }
+    if (pid < 0)
+      cerr << "  MIP_portfolio: could not start configuration " << (k+1)
+        << ": " << strerror(errno) << endl;
+    aPid[k] = pid;
+  }
+  // Writing to a member which has just exited must not kill the parent
+  void (*sigpipeSaved)(int) = signal(SIGPIPE, SIG_IGN);
+
+  /// Is a better than b in the objective sense? Satisfaction: never
+  auto fBetter = [nProbType](double a, double b) {
+    return nProbType > 0 ? a > b : ( nProbType < 0 && a < b );
+  };
+  bool fIncumbent = false, fBound = false, fStop = false;
+  int iIncumbent = -1;
+  double dBound = 0.0;
+  MIP_wrapper::Output outLast;
+  outLast.status = MIP_wrapper::UNKNOWN;
+  vector<double> x;
+  string name;
+  int nRunning = 0;
+  for (int k=0; k<n; ++k)
+    if (aFd[k] >= 0)
+      ++nRunning;
+  while (nRunning && !fStop) {
+    fd_set fdset;
+    FD_ZERO(&fdset);
+    int fdMax = -1;
+    for (int k=0; k<n; ++k)
+      if (aFd[k] >= 0) {
+        FD_SET(aFd[k], &fdset);
+        fdMax = max(fdMax, aFd[k]);
+      }
+    if (select(fdMax+1, &fdset, NULL, NULL, NULL) < 0) {
+      if (EINTR == errno)
+        continue;
+      cerr << "  MIP_portfolio: select() failed: " << strerror(errno) << endl;
+      break;
+    }
+    for (int k=0; k<n && !fStop; ++k) {
+      if (aFd[k] < 0 || !FD_ISSET(aFd[k], &fdset))
+        continue;
+      MsgHeader h;
+      bool fOk = readAll(aFd[k], &h, sizeof(h));
+      if (fOk) {
+        x.resize(h.nCols);
+        name.resize(h.nName);
+        fOk = readAll(aFd[k], x.data(), h.nCols * sizeof(double))
+          && readAll(aFd[k], &name[0], h.nName);
+      }
+      if (!fOk) {                          // the member died without reporting
+        cerr << "  MIP_portfolio: configuration " << (k+1) << " terminated unexpectedly" << endl;
+        close(aFd[k]);
+        aFd[k] = -1;
+        close(aFdOut[k]);
+        aFdOut[k] = -1;
+        --nRunning;
+        ++nFinished;
+        continue;
+      }
+      const MIP_wrapper::Status st = static_cast<MIP_wrapper::Status>(h.status);
+      const bool fSolution = h.nCols
+        && ( MSG_FINISHED != h.type || MIP_wrapper::OPT==st || MIP_wrapper::SAT==st );
+      // Share the bound
+      double bnd = ( MIP_wrapper::OPT==st && fSolution ) ? h.objVal : h.bestBound;
+      if ( nProbType && std::fabs(bnd) < 1e300
+           && ( MIP_wrapper::OPT==st || MIP_wrapper::SAT==st ) ) {
+        if ( !fBound || fBetter(dBound, bnd) )
+          dBound = bnd;
+        fBound = true;
+      }
+      // Share the incumbent, also with the other members as their cutoff
+      const bool fImproves = fSolution && ( !fIncumbent || fBetter(h.objVal, out.objVal) );
+      if (fImproves) {
+        xBest = x;
+        fIncumbent = true;
+        iIncumbent = k;
+        out.x = xBest.data();
+        out.objVal = h.objVal;
+        out.status = MIP_wrapper::SAT;
+        out.statusName = name;
+        out.nNodes = h.nNodes;
+        out.nOpenNodes = h.nOpenNodes;
+        out.dCPUTime = h.dCPUTime;
+        if (nProbType)
+          for (int j=0; j<n; ++j)
+            if (j != k && aFdOut[j] >= 0
+                && sizeof(h.objVal) == write(aFdOut[j], &h.objVal, sizeof(h.objVal)))
+              aCutoffSent[j] = true;
+      }
+      if (fBound)
+        out.bestBound = dBound;
+      if (MSG_SOLUTION == h.type) {
+        if (fImproves && pMIP->cbui.solcbfn)
+          (*pMIP->cbui.solcbfn)(out, pMIP->cbui.ppp);
+      } else if (MSG_FINISHED == h.type) {
+        close(aFd[k]);
+        aFd[k] = -1;
+        close(aFdOut[k]);
+        aFdOut[k] = -1;
+        --nRunning;
+        ++nFinished;
+        if (pMIP->fVerbose)
+          cerr << "  MIP_portfolio: configuration " << (k+1) << " finished: " << name << endl;
+        outLast.status = st;
+        outLast.statusName = name;
+        if ( aCutoffSent[k] && fIncumbent && !fSolution
+             && ( MIP_wrapper::UNSAT==st || MIP_wrapper::UNSATorUNBND==st ) ) {
+          // Nothing better than the cutoff from the others: the incumbent is optimal
+          iWinner = iIncumbent;
+          fStop = true;
+          out.status = MIP_wrapper::OPT;
+          out.statusName = "Optimal, configuration " + to_string(k+1)
+            + " found nothing better";
+        } else if ( MIP_wrapper::OPT==st || MIP_wrapper::UNSAT==st || MIP_wrapper::UNBND==st
+             || MIP_wrapper::UNSATorUNBND==st || ( 0==nProbType && MIP_wrapper::SAT==st ) ) {
+          iWinner = k;
+          fStop = true;
+          if (fSolution) {
+            xBest = x;
+            out.x = xBest.data();
+            out.objVal = h.objVal;
+          }
+          out.status = st;
+          out.statusName = name;
+          out.bestBound = h.bestBound;
+          out.nNodes = h.nNodes;
+          out.nOpenNodes = h.nOpenNodes;
+          out.dCPUTime = h.dCPUTime;
+        }
+      }
+      // The best bound may prove the best incumbent optimal
+      if ( !fStop && fIncumbent && fBound
+           && !fBetter(dBound, out.objVal + (nProbType>0 ? 1.0 : -1.0)
+                                * 1e-9 * max(1.0, std::fabs(out.objVal))) ) {
+        iWinner = iIncumbent;
+        fStop = true;
+        out.status = MIP_wrapper::OPT;
+        out.statusName = "Optimal by the best bound of all configurations";
+      }
+    }
+  }
+  if (!fStop) {
+    if (fIncumbent)
+      iWinner = iIncumbent;
+    else {
+      out.status = outLast.status;
+      out.statusName = outLast.statusName;
+    }
+  }
+  for (int k=0; k<n; ++k) {
+    if (aFd[k] >= 0) {
+      kill(aPid[k], SIGKILL);
+      close(aFd[k]);
+      close(aFdOut[k]);
+    }
+    if (aPid[k] > 0)
+      waitpid(aPid[k], NULL, 0);
+  }
+  signal(SIGPIPE, sigpipeSaved);
+  fDone = true;
+  if (pMIP->fVerbose && iWinner >= 0)
+    cerr << "  MIP_portfolio: result of configuration " << (iWinner+1)
+      << " of " << n << ", options '" << aConfigs[iWinner] << "'" << endl;
+  return true;
+}
+
+#endif
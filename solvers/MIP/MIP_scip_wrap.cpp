@@ -45,6 +45,10 @@ string MIP_WrapperFactory::getVersion( ) {
   return oss.str();
 }
 
+bool MIP_WrapperFactory::isForkSafe( ) {
+  return true;
+}
+
 void MIP_WrapperFactory::printHelp(ostream& os) {
   os
   << "SCIP  MIP wrapper options:" << std::endl
@@ -474,6 +478,23 @@ SCIP_RETCODE MIP_scip_wrapper::solve_SCIP() {  // Move into ancestor?
    output.dCPUTime = clock();
 
    /* Optimize the problem and obtain solution. */
+   /// MIP start. SCIP checks it when presolving starts, a partial one is completed
+   if ( mipStart.cols.size() ) {
+     SCIP_SOL* sol = 0;
+     SCIP_Bool stored = FALSE;
+     const bool fComplete = mipStart.isComplete(cur_numcols);
+     if (fComplete)
+       SCIP_CALL( SCIPcreateOrigSol(scip, &sol, NULL) );
+     else
+       SCIP_CALL( SCIPcreatePartialSol(scip, &sol, NULL) );
+     for (size_t k=0; k<mipStart.cols.size(); ++k)
+       SCIP_CALL( SCIPsetSolVal(scip, sol, scipVars[mipStart.cols[k]], mipStart.vals[k]) );
+     if (fComplete)
+       mipStart.objVal = SCIPgetSolOrigObj(scip, sol);
+     SCIP_CALL( SCIPaddSolFree(scip, &sol, &stored) );
+     mipStart.status = stored ? MIPStart::PASSED : MIPStart::REJECTED;
+   }
+
    SCIP_CALL( SCIPsolve (scip) );
 //    wrap_assert( !retcode,  "Failed to optimize MIP." );
 
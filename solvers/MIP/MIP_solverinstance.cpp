@@ -23,10 +23,17 @@
 #include <string>
 #include <memory>
 #include <chrono>
+#include <map>
+#include <algorithm>
+#include <thread>
+#include <cmath>
 
 using namespace std;
 
 #include <minizinc/solvers/MIP/MIP_solverinstance.hh>
+#include <minizinc/parser.hh>
+#include <minizinc/json_parser.hh>
+#include <minizinc/file_utils.hh>
 
 using namespace MiniZinc;
 
@@ -34,6 +41,53 @@ SolverFactory* MiniZinc::SolverFactory::createF_MIP() {
   return new MIP_SolverFactory;
 }
 
+/// Presolve of the linear rows before passing them to the solver
+static bool fRowPresolve = true;
+/// Option sets of a portfolio run, see MIP_portfolio
+static vector<string> aPortfolioConfigs;
+/// Solution file (dzn or json) to start from
+static string sWarmStart;
+/// Number of threads for the cut generators in a callback
+static int nCutThreads = 1;
+/// With -a: print every n-th incumbent (0: none, only the final solution)
+/// and at most one per interval (seconds)
+static int nSolutionEvery = 1;
+static double dSolutionInterval = 0.0;
+
+bool MIP_SolverFactory::processOption(int& i, int argc, const char** argv) {
+  MiniZinc::CLOParser cop( i, argc, argv );
+  string sConfig;
+  if (string(argv[i])=="--no-row-presolve") {
+    fRowPresolve = false;
+    return true;
+  } else if ( cop.get( "--portfolio", &sConfig ) ) {
+    aPortfolioConfigs.push_back(sConfig);
+    return true;
+  } else if ( cop.get( "--warm-start", &sWarmStart ) ) {
+    return true;
+  } else if ( cop.get( "--cut-threads", &nCutThreads ) ) {
+    return true;
+  } else if ( cop.get( "--solution-every", &nSolutionEvery ) ) {
+    return true;
+  } else if ( cop.get( "--solution-interval", &dSolutionInterval ) ) {
+    return true;
+  }
+  return MIP_WrapperFactory::processOption(i, argc, argv);
+}
+
+void MIP_SolverFactory::printHelp(ostream& os) {
+  os
+  << "MIP solver plugin options:" << std::endl
+  << "--no-row-presolve     do not presolve the linear constraints before passing them to the solver" << std::endl
+  << "--portfolio \"<options>\"\n"
+     "      add a configuration of solver options, e.g. \"--cbcArgs '-cuts off'\". With this option\n"
+     "      the model is built once and solved under all configurations in parallel processes;\n"
+     "      the first one to finish with a proof wins. Not available on Windows, nor with\n"
+     "      CPLEX or Gurobi, whose environments cannot be forked" << std::endl
+  << std::endl;
+  MIP_WrapperFactory::printHelp(os);
+}
+
 string MIP_SolverFactory::getVersion()
 {
   string v = "  MIP solver plugin, compiled  " __DATE__ ", using: "
@@ -165,10 +219,8 @@ namespace SCIPConstraints {
       }
     } else {
       // See if the solver adds indexation itself: no.
-      std::stringstream ss;
-      ss << "p_lin_" << (gi.getMIPWrapper()->nAddedRows++);
-      gi.getMIPWrapper()->addRow(coefs.size(), &vars[0], &coefs[0], lt, rhs,
-                                GetMaskConsType(call), ss.str());
+      gi.getMIPWrapper()->bufferRow(coefs.size(), &vars[0], &coefs[0], lt, rhs,
+                                GetMaskConsType(call), "p_lin_");
     }
   }
 
@@ -215,10 +267,8 @@ namespace SCIPConstraints {
               << endl;
         }
       } else {
-        std::stringstream ss;
-        ss << "p_eq_" << (gi.getMIPWrapper()->nAddedRows++);
-        gi.getMIPWrapper()->addRow(vars.size(), &vars[0], &coefs[0], nCmp, rhs,
-                                GetMaskConsType(call), ss.str());
+        gi.getMIPWrapper()->bufferRow(vars.size(), &vars[0], &coefs[0], nCmp, rhs,
+                                GetMaskConsType(call), "p_eq_");
       }
     }
    void p_eq(SolverInstanceBase& si, const Call* call) {
@@ -279,6 +329,49 @@ void MIP_solverinstance::printStatistics(ostream& os, bool fLegend)
       oldState.copyfmt(std::cout);
       os.precision(12);
       os << "  % MIP Status: " << mip_wrap->getStatusName() << endl;
+      if (presolveStats.nRowsBefore)
+        os << "  % MIP row presolve: " << presolveStats.nRowsBefore << " -> "
+          << presolveStats.nRowsAfter << " rows ("
+          << presolveStats.nEmpty << " empty, "
+          << presolveStats.nSingleton << " singleton, "
+          << presolveStats.nDuplicate << " duplicate, "
+          << presolveStats.nRedundant << " redundant, "
+          << presolveStats.nDominated << " dominated), "
+          << presolveStats.nFixedTerms << " fixed terms, "
+          << presolveStats.nBounds << " bounds tightened" << endl;
+      const MIP_wrapper::MIPStart& ms = mip_wrap->mipStart;
+      if (ms.cols.size()) {
+        static const char* aStartStatus[] = { "ignored by the solver",
+          "passed to the solver", "accepted by the solver", "rejected by the solver" };
+        os << "  % MIP warm start: " << ms.cols.size() << " of " << mip_wrap->getNCols()
+          << " columns, " << aStartStatus[ms.status];
+        if (ms.objVal < 1e300)
+          os << ", objective " << ms.objVal;
+        os << endl;
+      }
+      if (incumbents.nPushed)
+        os << "  % MIP incumbents: " << incumbents.nPushed << " found, "
+          << nRendered << " printed, " << dRenderTime << " sec in output" << endl;
+      /// Callbacks may still update the counters
+      std::unique_lock<std::mutex> lockCuts( cutPool.getMutex() );
+      for ( const auto& pCG : cutGenerators )
+        os << "  % MIP cuts " << pCG->getName() << ": " << pCG->stats.nCalls << " calls, "
+          << pCG->stats.nCuts << " generated, " << pCG->stats.nAdded << " added, "
+          << pCG->stats.dTime << " sec" << endl;
+      if (cutGenerators.size())
+        os << "  % MIP cut pool: " << cutPool.nDuplicate << " duplicate, "
+          << cutPool.nNotViolated << " not violated" << endl;
+      lockCuts.unlock();
+      if (portfolio && portfolio->fDone) {
+        os << "  % MIP portfolio: ";
+        if (portfolio->iWinner >= 0)
+          os << "configuration " << (portfolio->iWinner+1) << " of "
+            << portfolio->getConfigs().size() << " won, options '"
+            << portfolio->getConfigs()[portfolio->iWinner] << "'";
+        else
+          os << "no configuration of " << portfolio->getConfigs().size() << " found a solution";
+        os << ", " << portfolio->nFinished << " finished" << endl;
+      }
       if (fLegend)
         os << "  % obj, bound, CPU_time, nodes (left): ";
       os << mip_wrap->getObjValue() << ",  ";
@@ -305,13 +398,58 @@ void MIP_solverinstance::printStatistics(ostream& os, bool fLegend)
 }
 
 
+void IncumbentRing::push( const double* x, int nc, double obj ) {
+  if ( nCols != nc ) {
+    nCols = nc;
+    aX.assign( size_t(nCap)*nCols, 0.0 );
+    aObj.assign( nCap, 0.0 );
+    nSize = 0;
+  }
+  std::copy( x, x+nCols, &aX[ size_t(iHead)*nCols ] );
+  aObj[ iHead ] = obj;
+  iHead = ( iHead+1 ) % nCap;
+  nSize = min( nSize+1, nCap );
+  ++nPushed;
+}
+
+bool MIP_solverinstance::fRenderIncumbent() {
+  if ( nSolutionEvery<=0 || 0 != incumbents.nPushed % nSolutionEvery )
+    return false;
+  return dSolutionInterval<=0.0 || 0==nRendered
+    || std::chrono::duration<double>( std::chrono::steady_clock::now() - tLastRender ).count()
+         >= dSolutionInterval;
+}
+
+void MIP_solverinstance::printSolution() {
+  auto t0 = std::chrono::steady_clock::now();
+  assignSolutionToOutput();
+  if ( 0==pS2Out ) {
+    getEnv()->evalOutput(std::cout);               // deprecated
+    std::cout << "----------" << std::endl;
+  }
+  else
+    getSolns2Out()->evalOutput();
+  tLastRender = std::chrono::steady_clock::now();
+  dRenderTime += std::chrono::duration<double>( tLastRender - t0 ).count();
+  ++nRendered;
+  if ( getOptions().getBoolParam(constants().opts.statistics.str()) )
+    printStatistics(std::cout, 1);
+}
+
 void HandleSolutionCallback(const MIP_wrapper::Output& out, void* pp) {
-  // multi-threading? TODO
   MIP_solverinstance* pSI = (MIP_solverinstance*)( pp );
   assert(pSI);
+  /// Solvers may call back from several threads
+  std::lock_guard<std::mutex> lock( pSI->mtxIncumbents );
   /// Not for -a:
 //   if (fabs(pSI->lastIncumbent - out.objVal) > 1e-12*(1.0 + fabs(out.objVal))) {
     pSI->lastIncumbent = out.objVal;
+  pSI->incumbents.push(out.x, pSI->getMIPWrapper()->colObj.size(), out.objVal);
+  /// The warm start was accepted if the first incumbent agrees with it
+  if ( 1==pSI->incumbents.nPushed )
+    pSI->getMIPWrapper()->mipStart.checkSolution( out.x, out.objVal );
+  if (!pSI->fRenderIncumbent())
+    return;
   
   try {     /// Sometimes the intermediate output is wrong, especially in SCIP
     pSI->printSolution();            // The solution in [out] is not used  TODO 
@@ -342,6 +480,144 @@ void HandleCutCallback(const MIP_wrapper::Output& out, MIP_wrapper::CutInput& in
 
 
 
+namespace {
+  /// Numbers of a literal value from a solution: ints, floats, bools, arrays of them
+  bool collectStartValues(Expression* e, vector<double>& vals) {
+    if (IntLit* il = e->dyn_cast<IntLit>()) {
+      vals.push_back(il->v().toInt());
+    } else if (FloatLit* fl = e->dyn_cast<FloatLit>()) {
+      vals.push_back(fl->v().toDouble());
+    } else if (BoolLit* bl = e->dyn_cast<BoolLit>()) {
+      vals.push_back(bl->v());
+    } else if (UnOp* uo = e->dyn_cast<UnOp>()) {
+      if (UOT_MINUS != uo->op() || !collectStartValues(uo->e(), vals))
+        return false;
+      vals.back() = -vals.back();
+    } else if (ArrayLit* al = e->dyn_cast<ArrayLit>()) {
+      for (unsigned int i=0; i<al->v().size(); ++i)
+        if (!collectStartValues(al->v()[i], vals))
+          return false;
+    } else if (Call* c = e->dyn_cast<Call>()) {      // arrayNd(..., [...])
+      if (0==c->args().size() || !collectStartValues(c->args()[c->args().size()-1], vals))
+        return false;
+    } else
+      return false;
+    return true;
+  }
+}
+
+void MIP_solverinstance::setWarmStart(const string& sFile) {
+  MIP_wrapper::MIPStart& ms = getMIPWrapper()->mipStart;
+  GCLock lock;
+  unique_ptr<Model> sm;
+  if (sFile.size()>5 && 0==sFile.compare(sFile.size()-5, 5, ".json")) {
+    sm.reset(new Model);
+    JSONParser jp(getEnv()->envi());
+    jp.parse(sm.get(), sFile);
+  } else {
+    ifstream is(sFile.c_str(), ios::binary);
+    if (!FileUtils::file_exists(sFile) || !is.is_open())
+      throw runtime_error("  MIP_solverinstance: cannot open warm start file '" + sFile + "'");
+    /// If this is output of a previous run, take its last solution
+    string sText, sSol, sLine;
+    while (getline(is, sLine)) {
+      if (0==sLine.compare(0, 10, "----------")) {
+        sText.swap(sSol);
+        sSol.clear();
+      } else if (0!=sLine.compare(0, 10, "==========")
+                 && 0!=sLine.compare(0, 5, "=====")) {
+        sSol += sLine;
+        sSol += '\n';
+      }
+    }
+    if (sText.empty())
+      sText.swap(sSol);
+    vector<string> includePaths;
+    vector<SyntaxError> se;
+    sm.reset(parseFromString(sText, sFile, includePaths, true, false, false, cerr, se));
+    if (!sm)
+      throw runtime_error("  MIP_solverinstance: cannot parse warm start file '" + sFile + "'");
+  }
+  /// Output variables of the flat model by name
+  UNORDERED_NAMESPACE::unordered_map<string, VarDecl*> outVars;
+  for (VarDeclIterator it = getEnv()->flat()->begin_vardecls(); it != getEnv()->flat()->end_vardecls(); ++it) {
+    VarDecl* vd = it->e();
+    if (!it->removed() && !vd->ann().isEmpty()
+        && (vd->ann().containsCall(constants().ann.output_array.aststr())
+            || vd->ann().contains(constants().ann.output_var)))
+      outVars[vd->id()->str().str()] = vd;
+  }
+  /// Column values, the last one given for a column counts
+  map<VarId, double> colVals;
+  int nUnknown = 0;
+  for (unsigned int i=0; i<sm->size(); ++i) {
+    AssignI* ai = (*sm)[i]->dyn_cast<AssignI>();
+    if (!ai)
+      continue;
+    auto itVar = outVars.find(ai->id().str());
+    vector<double> vals;
+    if (outVars.end()==itVar || !collectStartValues(ai->e(), vals)) {
+      if (mip_wrap->fVerbose)
+        cerr << "  MIP_solverinstance: warm start: ignoring the value of '" << ai->id() << "'" << endl;
+      ++nUnknown;
+      continue;
+    }
+    VarDecl* vd = itVar->second;
+    vector<Expression*> elems;
+    if (ArrayLit* al = Expression::dyn_cast<ArrayLit>(vd->e())) {
+      for (unsigned int j=0; j<al->v().size(); ++j)
+        elems.push_back(al->v()[j]);
+    } else
+      elems.push_back(vd->id());
+    if (elems.size() != vals.size()) {
+      cerr << "  MIP_solverinstance: warm start: '" << ai->id() << "' has "
+        << vals.size() << " values instead of " << elems.size() << ", ignored" << endl;
+      ++nUnknown;
+      continue;
+    }
+    for (unsigned int j=0; j<elems.size(); ++j) {
+      Id* id = Expression::dyn_cast<Id>(elems[j]);
+      if (!id)                                          // a fixed value
+        continue;
+      id = id->decl()->id();
+      if (!id->type().isvar())
+        continue;
+      auto itCol = _variableMap.find(id);
+      if (_variableMap.end() == itCol)
+        continue;
+      const VarId col = itCol->second;
+      double val = vals[j];
+      if (MIP_wrapper::REAL != mip_wrap->colTypes[col])
+        val = round(val);
+      colVals[col] = val;
+    }
+  }
+  ms.cols.clear();
+  ms.vals.clear();
+  ms.objVal = 1e308;
+  for (const auto& cv : colVals) {
+    ms.cols.push_back(cv.first);
+    ms.vals.push_back(cv.second);
+  }
+  int nOutside = 0;
+  for (size_t k=0; k<ms.cols.size(); ++k) {
+    const VarId col = ms.cols[k];
+    if (ms.vals[k] < mip_wrap->colLB[col] - 1e-6 || ms.vals[k] > mip_wrap->colUB[col] + 1e-6)
+      ++nOutside;
+  }
+  if (ms.isComplete(mip_wrap->getNCols())) {
+    ms.objVal = 0.0;
+    for (size_t k=0; k<ms.cols.size(); ++k)
+      ms.objVal += mip_wrap->colObj[ms.cols[k]] * ms.vals[k];
+  }
+  if (nOutside)
+    cerr << "  MIP_solverinstance: warm start: " << nOutside
+      << " values are outside of the variable bounds" << endl;
+  if (mip_wrap->fVerbose)
+    cerr << "  MIP_solverinstance: warm start: " << ms.cols.size() << " of "
+      << mip_wrap->getNCols() << " columns given, " << nUnknown << " assignments ignored" << endl;
+}
+
 SolverInstance::Status MIP_solverinstance::solve(void) {
   SolveI* solveItem = getEnv()->flat()->solveItem();
   if (solveItem->st() != SolveI::SolveType::ST_SAT) {
@@ -375,9 +651,33 @@ SolverInstance::Status MIP_solverinstance::solve(void) {
     getMIPWrapper()->provideSolutionCallback(HandleSolutionCallback, this);
     if ( cutGenerators.size() )  // only then, can modify presolve
       getMIPWrapper()->provideCutCallback(HandleCutCallback, this);
-    getMIPWrapper()->solve();
+    if ( sWarmStart.size() )
+      setWarmStart(sWarmStart);
+    if ( aPortfolioConfigs.size() ) {
+      portfolio.reset( new MIP_portfolio( getMIPWrapper(), aPortfolioConfigs ) );
+      if ( !portfolio->solve() ) {
+        cerr << "  MIP_solverinstance: --portfolio is not supported on this platform"
+          " or with this MIP library, solving with the plain options." << endl;
+        portfolio.reset();
+        getMIPWrapper()->solve();
+      }
+    } else
+      getMIPWrapper()->solve();
   //   printStatistics(cout, 1);   MznSolver does this (if it wants)
     sw = getMIPWrapper()->getStatus();
+    /// Without -a the backends call no solution callback: check the final solution
+    if ( ( MIP_wrapper::Status::OPT == sw || MIP_wrapper::Status::SAT == sw )
+         && 0==incumbents.nPushed && getMIPWrapper()->getValues() )
+      getMIPWrapper()->mipStart.checkSolution( getMIPWrapper()->getValues(),
+                                               getMIPWrapper()->getObjValue() );
+    if ( getMIPWrapper()->output.fModelOnStdout )
+      getSolns2Out()->fStatusPrinted = true;     // stdout holds the model only
+    /// No values from the solver, e.g., when interrupted: take the last incumbent
+    if ( ( MIP_wrapper::Status::OPT == sw || MIP_wrapper::Status::SAT == sw )
+         && !getMIPWrapper()->getValues() && incumbents.size() ) {
+      getMIPWrapper()->output.x = incumbents.getX();
+      getMIPWrapper()->output.objVal = incumbents.getObj();
+    }
   } else {
     if ( mip_wrap->fVerbose )
       cerr << "  MIP_solverinstance: no constraints - skipping actual solution phase." << endl;
@@ -513,8 +813,6 @@ void MIP_solverinstance::processFlatZinc(void) {
     cerr << "  MIP_solverinstance: during Phase 1,  "
       << mip_wrap->nLitVars << " literals with "
       << mip_wrap-> sLitValues.size() << " values used." << endl;
-  if (! getMIPWrapper()->fPhase1Over)
-    getMIPWrapper()->addPhase1Vars(); 
 
   if (mip_wrap->fVerbose)
     cerr << "  MIP_solverinstance: adding constraints..." << flush;
@@ -528,7 +826,19 @@ void MIP_solverinstance::processFlatZinc(void) {
   }
 
   if (mip_wrap->fVerbose)
-    cerr << " done, " << mip_wrap->getNRows() << " rows && "
+    cerr << " done." << endl;
+  /// Linear rows are buffered. Presolve them while the columns can still change
+  if (fRowPresolve && !getMIPWrapper()->fPhase1Over) {
+    if (!mip_wrap->presolveRows(presolveStats))
+      _status = SolverInstance::UNSAT;
+  }
+  if (! getMIPWrapper()->fPhase1Over)
+    getMIPWrapper()->addPhase1Vars(); 
+  /// and passed to the solver in one go
+  mip_wrap->flushRows();
+
+  if (mip_wrap->fVerbose)
+    cerr << "  MIP_solverinstance: " << mip_wrap->getNRows() << " rows && "
     << mip_wrap->getNCols() << " columns in total." << endl;
   if (mip_wrap->fVerbose && mip_wrap->sLitValues.size())
     cerr << "  MIP_solverinstance: overall,  "
@@ -553,16 +863,159 @@ Expression* MIP_solverinstance::getSolutionValue(Id* id) {
   }
 }
 
+size_t CutPool::KeyHash::operator()( const vector<long long>& k ) const {
+  size_t h = k.size();
+  for ( long long v : k )
+    h ^= std::hash<long long>()( v ) + 0x9e3779b9 + ( h<<6 ) + ( h>>2 );
+  return h;
+}
+
+/// Sorted indexes and coefficients of a GQ row scaled to max |coef| 1,
+/// rounded to 1e-9, then rhs and the mask
+vector<long long> CutPool::normalize( const MIP_wrapper::CutDef& cut ) {
+  vector< pair<int, double> > row;
+  for ( size_t i=0; i<cut.rmatind.size(); ++i )
+    row.push_back( make_pair( cut.rmatind[i], cut.rmatval[i] ) );
+  sort( row.begin(), row.end() );
+  size_t n = 0;
+  for ( size_t i=0; i<row.size(); ++i ) {         // merge repeated indexes
+    if ( n && row[n-1].first == row[i].first )
+      row[n-1].second += row[i].second;
+    else
+      row[n++] = row[i];
+  }
+  row.resize( n );
+  double dMax = 0.0;
+  for ( const auto& t : row )
+    dMax = max( dMax, fabs( t.second ) );
+  if ( 0.0 == dMax )
+    dMax = 1.0;
+  double dScale = ( MIP_wrapper::LQ == cut.sense ? -1.0 : 1.0 ) / dMax;
+  vector<long long> key;
+  key.reserve( 2*row.size() + 3 );
+  for ( const auto& t : row ) {
+    const long long c = llround( t.second * dScale * 1e9 );
+    if ( c ) {
+      key.push_back( t.first );
+      key.push_back( c );
+    }
+  }
+  key.push_back( llround( cut.rhs * dScale * 1e9 ) );
+  key.push_back( MIP_wrapper::EQ == cut.sense );
+  key.push_back( cut.mask );
+  return key;
+}
+
+void CutPool::add( CutGen* pCG, const MIP_wrapper::CutInput& cuts, double dTime,
+                   const MIP_wrapper::Output& slvOut, KeySet& keysCall,
+                   MIP_wrapper::CutInput& cutsOut ) {
+  /// Normalize and check outside of the lock
+  vector< vector<long long> > aKey( cuts.size() );
+  vector<char> aViolated( cuts.size() );
+  for ( size_t i=0; i<cuts.size(); ++i ) {
+    aViolated[i] = cuts[i].computeViol( slvOut.x, slvOut.nCols ) > dMinViol;
+    if ( aViolated[i] )
+      aKey[i] = normalize( cuts[i] );
+  }
+  std::lock_guard<std::mutex> lock( mtx );
+  ++pCG->stats.nCalls;
+  pCG->stats.nCuts += cuts.size();
+  pCG->stats.dTime += dTime;
+  for ( size_t i=0; i<cuts.size(); ++i ) {
+    if ( !aViolated[i] ) {
+      ++nNotViolated;
+      continue;
+    }
+    if ( keysCall.count( aKey[i] )
+         || ( 0==(cuts[i].mask & MIP_wrapper::MaskConsType_Lazy)
+              && !userCuts.insert( aKey[i] ).second ) ) {
+      ++nDuplicate;
+      continue;
+    }
+    keysCall.insert( move( aKey[i] ) );
+    cutsOut.push_back( cuts[i] );
+    ++pCG->stats.nAdded;
+  }
+}
+
+CutThreadPool::~CutThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock( mtx );
+    fStop = true;
+  }
+  cvStart.notify_all();
+  for ( auto& thr : aWorkers )
+    thr.join();
+}
+
+void CutThreadPool::run( int nThreads, int nT, const std::function<void(int)>& job ) {
+  std::unique_lock<std::mutex> lockRun( mtxRun, std::try_to_lock );
+  nThreads = min( nThreads, nT );
+  if ( nThreads <= 1 || !lockRun.owns_lock() ) {
+    for ( int i=0; i<nT; ++i )
+      job( i );
+    return;
+  }
+  /// New workers start at the current round, only written under mtxRun
+  while ( int(aWorkers.size()) < nThreads-1 )
+    aWorkers.emplace_back( &CutThreadPool::work, this, iRound );
+  {
+    std::lock_guard<std::mutex> lock( mtx );
+    pJob = &job;
+    nTasks = nT;
+    iNext = 0;
+    nBusy = aWorkers.size();
+    ++iRound;
+  }
+  cvStart.notify_all();
+  runTasks();
+  std::unique_lock<std::mutex> lock( mtx );
+  cvDone.wait( lock, [this]() { return 0==nBusy; } );
+  pJob = 0;
+}
+
+void CutThreadPool::runTasks() {
+  for ( int i; ( i = iNext++ ) < nTasks; )
+    (*pJob)( i );
+}
+
+void CutThreadPool::work( long iDone ) {
+  std::unique_lock<std::mutex> lock( mtx );
+  for ( ;; ) {
+    cvStart.wait( lock, [&]() { return fStop || iRound != iDone; } );
+    if ( fStop )
+      return;
+    iDone = iRound;
+    lock.unlock();
+    runTasks();
+    lock.lock();
+    if ( 0 == --nBusy )
+      cvDone.notify_one();
+  }
+}
+
 void MIP_solverinstance::genCuts(const MIP_wrapper::Output& slvOut,
                                  MIP_wrapper::CutInput& cutsIn, bool fMIPSol) {
+  vector<CutGen*> aCG;
   for ( auto& pCG : cutGenerators ) {
     if ( !fMIPSol || pCG->getMask()&MIP_wrapper::MaskConsType_Lazy )
-      pCG->generate( slvOut, cutsIn );
+      aCG.push_back( pCG.get() );
   }
-  /// Select some most violated? TODO
+  /// Each generator fills its own buffer
+  vector<MIP_wrapper::CutInput> aCuts( aCG.size() );
+  vector<double> aTime( aCG.size() );
+  cutThreads.run( nCutThreads, aCG.size(), [&]( int i ) {
+    auto t0 = std::chrono::steady_clock::now();
+    aCG[i]->generate( slvOut, aCuts[i] );
+    aTime[i] = std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+  } );
+  /// Merge in the order of the generators
+  CutPool::KeySet keysCall;
+  for ( size_t i=0; i<aCG.size(); ++i )
+    cutPool.add( aCG[i], aCuts[i], aTime[i], slvOut, keysCall, cutsIn );
 }
 
-void XBZCutGen::generate(const MIP_wrapper::Output& slvOut, MIP_wrapper::CutInput& cutsIn) {
+void XBZCutGen::generate(const MIP_wrapper::Output& slvOut, MIP_wrapper::CutInput& cutsIn) const {
   assert( pMIP );
   const int n = varX.size();
   assert( n==varB.size() );
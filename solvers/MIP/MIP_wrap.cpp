@@ -19,8 +19,361 @@
 #include <iomanip>
 #include <string>
 #include <stdexcept>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <functional>
 
 using namespace std;
 
 #include <minizinc/solvers/MIP/MIP_wrap.hh>
 
+void MIP_wrapper::flushRows() {
+  if (0==rowBuffer.size())
+    return;
+  auto t0 = std::chrono::steady_clock::now();
+  doAddRows(rowBuffer);
+  if (fVerbose) {
+    double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    cerr << "  MIP_wrapper: passed " << rowBuffer.size() << " rows with "
+      << rowBuffer.rmatind.size() << " nonzeros to the solver in " << dt << " sec";
+    if (dt > 0.0)
+      cerr << " (" << rowBuffer.size() / dt << " rows/sec)";
+    cerr << endl;
+  }
+  rowBuffer.clear();
+}
+
+void MIP_wrapper::doAddRows(const RowBuffer& rb) {
+  /// addRow() takes non-const arrays
+  vector<int> ind;
+  vector<double> val;
+  for (int i=0; i<rb.size(); ++i) {
+    ind.assign(rb.rmatind.begin()+rb.rowStarts[i], rb.rmatind.begin()+rb.rowStarts[i+1]);
+    val.assign(rb.rmatval.begin()+rb.rowStarts[i], rb.rmatval.begin()+rb.rowStarts[i+1]);
+    addRow(ind.size(), ind.data(), val.data(), rb.sense[i], rb.rhs[i],
+           rb.mask[i], rb.rowName(i));
+  }
+}
+
+namespace {
+  /// Tolerances of the row presolve
+  const double dFeasTol = 1e-6;     // deciding infeasibility
+  const double dRedTol = 1e-9;      // deciding redundancy, so stricter
+  /// Bounds beyond this are infinite, whatever the solver thinks
+  const double dInfPresolve = 1e20;
+  inline double relTol(double tol, double v) { return tol*(1.0+fabs(v)); }
+}
+
+bool MIP_wrapper::presolveRows(PresolveStats& stats) {
+  auto t0 = std::chrono::steady_clock::now();
+  RowBuffer& rb = rowBuffer;
+  const int nRows = rb.size();
+  stats.nRowsBefore = nRows;
+  const double dInf = std::min(getInfBound(), dInfPresolve);
+  vector<int> len(nRows);
+  for (int i=0; i<nRows; ++i)
+    len[i] = rb.nnz(i);
+  vector<char> fRemoved(nRows, 0);
+  bool fFeasible = true;
+
+  /// Tighten a column bound to v, rounded for integer columns
+  auto tightenLB = [&](int j, double v) {
+    if (REAL != colTypes[j])
+      v = ceil(v - dFeasTol);
+    if (v > colLB[j] + relTol(dRedTol, v)) {
+      colLB[j] = v;
+      ++stats.nBounds;
+      return true;
+    }
+    return false;
+  };
+  auto tightenUB = [&](int j, double v) {
+    if (REAL != colTypes[j])
+      v = floor(v + dFeasTol);
+    if (v < colUB[j] - relTol(dRedTol, v)) {
+      colUB[j] = v;
+      ++stats.nBounds;
+      return true;
+    }
+    return false;
+  };
+
+  bool fChanged = true;
+  for (stats.nRounds=0; fChanged && fFeasible && stats.nRounds<10; ++stats.nRounds) {
+    fChanged = false;
+    for (int i=0; i<nRows && fFeasible; ++i) {
+      if (fRemoved[i] || MaskConsType_Normal != rb.mask[i])
+        continue;
+      /// Move fixed columns to the rhs, drop zeros
+      const int k0 = rb.rowStarts[i];
+      int w = k0;
+      for (int k=k0; k<k0+len[i]; ++k) {
+        const int j = rb.rmatind[k];
+        const double a = rb.rmatval[k];
+        if (0.0 == a)
+          continue;
+        if (colLB[j] == colUB[j]) {
+          rb.rhs[i] -= a*colLB[j];
+          ++stats.nFixedTerms;
+          continue;
+        }
+        rb.rmatind[w] = j;
+        rb.rmatval[w] = a;
+        ++w;
+      }
+      len[i] = w-k0;
+      const double rhs = rb.rhs[i];
+      const LinConType sense = rb.sense[i];
+      if (0 == len[i]) {
+        if ((LQ!=sense && rhs > relTol(dFeasTol, rhs)) ||
+            (GQ!=sense && rhs < -relTol(dFeasTol, rhs)))
+          fFeasible = false;
+        fRemoved[i] = 1;
+        ++stats.nEmpty;
+      } else if (1 == len[i]) {
+        const int j = rb.rmatind[k0];
+        const double a = rb.rmatval[k0];
+        const double v = rhs/a;
+        const bool fUB = (EQ==sense || (LQ==sense) == (a>0.0));
+        const bool fLB = (EQ==sense || (GQ==sense) == (a>0.0));
+        if (fUB)
+          fChanged |= tightenUB(j, v);
+        if (fLB)
+          fChanged |= tightenLB(j, v);
+        if (colLB[j] > colUB[j] + relTol(dFeasTol, colUB[j]))
+          fFeasible = false;
+        else if (colLB[j] > colUB[j])
+          colLB[j] = colUB[j];
+        fRemoved[i] = 1;
+        ++stats.nSingleton;
+      } else {
+        /// Activity bounds from column bounds
+        double minAct=0.0, maxAct=0.0;
+        bool fMinInf=false, fMaxInf=false;
+        for (int k=k0; k<k0+len[i]; ++k) {
+          const int j = rb.rmatind[k];
+          const double a = rb.rmatval[k];
+          const double lo = a>0.0 ? colLB[j] : colUB[j];
+          const double up = a>0.0 ? colUB[j] : colLB[j];
+          if (fabs(lo) >= dInf)
+            fMinInf = true;
+          else
+            minAct += a*lo;
+          if (fabs(up) >= dInf)
+            fMaxInf = true;
+          else
+            maxAct += a*up;
+        }
+        if ((GQ!=sense && !fMinInf && minAct > rhs + relTol(dFeasTol, rhs)) ||
+            (LQ!=sense && !fMaxInf && maxAct < rhs - relTol(dFeasTol, rhs))) {
+          fFeasible = false;
+        } else if ((LQ==sense && !fMaxInf && maxAct <= rhs + relTol(dRedTol, rhs)) ||
+                   (GQ==sense && !fMinInf && minAct >= rhs - relTol(dRedTol, rhs)) ||
+                   (EQ==sense && !fMinInf && !fMaxInf
+                    && fabs(maxAct-rhs) <= relTol(dRedTol, rhs)
+                    && fabs(minAct-rhs) <= relTol(dRedTol, rhs))) {
+          fRemoved[i] = 1;
+          ++stats.nRedundant;
+        }
+      }
+    }
+  }
+
+  /// Duplicate rows: same columns and coefficients. Sort the terms to compare
+  if (fFeasible) {
+    vector<pair<int,double> > terms;
+    for (int i=0; i<nRows; ++i) {
+      if (fRemoved[i] || MaskConsType_Normal != rb.mask[i])
+        continue;
+      const int k0 = rb.rowStarts[i];
+      terms.clear();
+      for (int k=k0; k<k0+len[i]; ++k)
+        terms.push_back(make_pair(rb.rmatind[k], rb.rmatval[k]));
+      sort(terms.begin(), terms.end());
+      /// and the sign, so that a*x <= b and -a*x <= -b are found equal
+      const double sgn = terms[0].second < 0.0 ? -1.0 : 1.0;
+      for (int k=0; k<len[i]; ++k) {
+        rb.rmatind[k0+k] = terms[k].first;
+        rb.rmatval[k0+k] = sgn*terms[k].second;
+      }
+      if (sgn < 0.0) {
+        rb.rhs[i] = -rb.rhs[i];
+        rb.sense[i] = (LinConType)(-(int)rb.sense[i]);
+      }
+    }
+    auto rowHash = [&](int i) {
+      size_t h = len[i];
+      for (int k=rb.rowStarts[i]; k<rb.rowStarts[i]+len[i]; ++k) {
+        h = h*31 + std::hash<int>()(rb.rmatind[k]);
+        h = h*31 + std::hash<double>()(rb.rmatval[k]);
+      }
+      return h;
+    };
+    auto rowEq = [&](int i1, int i2) {
+      return len[i1]==len[i2]
+        && equal(rb.rmatind.begin()+rb.rowStarts[i1], rb.rmatind.begin()+rb.rowStarts[i1]+len[i1],
+                 rb.rmatind.begin()+rb.rowStarts[i2])
+        && equal(rb.rmatval.begin()+rb.rowStarts[i1], rb.rmatval.begin()+rb.rowStarts[i1]+len[i1],
+                 rb.rmatval.begin()+rb.rowStarts[i2]);
+    };
+    /// The kept rows of each sense among duplicates
+    struct DupRows { int iLQ=-1, iGQ=-1, iEQ=-1; };
+    unordered_map<int, DupRows, decltype(rowHash), decltype(rowEq)>
+      dupRows(nRows, rowHash, rowEq);
+    auto removeDup = [&](int i) {
+      fRemoved[i] = 1;
+      ++stats.nDuplicate;
+    };
+    for (int i=0; i<nRows && fFeasible; ++i) {
+      if (fRemoved[i] || MaskConsType_Normal != rb.mask[i])
+        continue;
+      DupRows& dr = dupRows[i];
+      const double rhs = rb.rhs[i];
+      if (dr.iEQ >= 0) {
+        const double rhsEQ = rb.rhs[dr.iEQ];
+        if ((LQ!=rb.sense[i] && rhsEQ < rhs - relTol(dFeasTol, rhs)) ||
+            (GQ!=rb.sense[i] && rhsEQ > rhs + relTol(dFeasTol, rhs)))
+          fFeasible = false;
+        removeDup(i);
+        continue;
+      }
+      if (EQ == rb.sense[i]) {
+        if ((dr.iLQ>=0 && rhs > rb.rhs[dr.iLQ] + relTol(dFeasTol, rhs)) ||
+            (dr.iGQ>=0 && rhs < rb.rhs[dr.iGQ] - relTol(dFeasTol, rhs)))
+          fFeasible = false;
+        if (dr.iLQ>=0)
+          removeDup(dr.iLQ);
+        if (dr.iGQ>=0)
+          removeDup(dr.iGQ);
+        dr.iLQ = dr.iGQ = -1;
+        dr.iEQ = i;
+        continue;
+      }
+      int& iSame = (LQ == rb.sense[i]) ? dr.iLQ : dr.iGQ;
+      if (iSame >= 0) {
+        rb.rhs[iSame] = (LQ == rb.sense[i]) ?
+          std::min(rb.rhs[iSame], rhs) : std::max(rb.rhs[iSame], rhs);
+        removeDup(i);
+      } else
+        iSame = i;
+      if (dr.iLQ>=0 && dr.iGQ>=0) {
+        const double rhsLQ = rb.rhs[dr.iLQ], rhsGQ = rb.rhs[dr.iGQ];
+        if (rhsLQ < rhsGQ - relTol(dFeasTol, rhsGQ))
+          fFeasible = false;
+        else if (rhsLQ <= rhsGQ + relTol(dRedTol, rhsGQ)) {
+          /// lhs <= a and lhs >= a: an equality
+          rb.sense[dr.iLQ] = EQ;
+          removeDup(dr.iGQ);
+          dr.iEQ = dr.iLQ;
+          dr.iLQ = dr.iGQ = -1;
+        }
+      }
+    }
+  }
+
+  /// Dominated rows: inequality s is implied by row r and the column bounds if
+  /// supp(r) is part of supp(s) and max (sgn_s*c_s - sgn_r*c_r)x <= sgn_s*b_s - sgn_r*b_r,
+  /// where sgn is +1 for <= and -1 for >=. Terms are sorted by column from above.
+  /// Candidates for s share the rarest column of r; the search stops after a
+  /// number of term visits proportional to the nonzeros
+  if (fFeasible) {
+    const int nCols = colObj.size();
+    vector<vector<int> > colRows(nCols);
+    vector<char> fCandidate(nRows, 0);
+    for (int i=0; i<nRows; ++i) {
+      if (fRemoved[i] || MaskConsType_Normal != rb.mask[i] || 0 == len[i])
+        continue;
+      const int k0 = rb.rowStarts[i];
+      bool fDistinct = true;
+      for (int k=k0+1; k<k0+len[i]; ++k)
+        fDistinct &= (rb.rmatind[k] != rb.rmatind[k-1]);
+      if (!fDistinct)
+        continue;
+      fCandidate[i] = 1;
+      for (int k=k0; k<k0+len[i]; ++k)
+        colRows[rb.rmatind[k]].push_back(i);
+    }
+    vector<double> coefR(nCols, 0.0);
+    vector<int> markR(nCols, -1);
+    const long long nWorkMax = 20LL*(long long)rb.rmatind.size() + 100000;
+    long long nWork = 0;
+    for (int r=0; r<nRows && nWork<nWorkMax; ++r) {
+      if (!fCandidate[r] || fRemoved[r])
+        continue;
+      const int k0 = rb.rowStarts[r];
+      int jRare = rb.rmatind[k0];
+      for (int k=k0; k<k0+len[r]; ++k) {
+        const int j = rb.rmatind[k];
+        coefR[j] = rb.rmatval[k];
+        markR[j] = r;
+        if (colRows[j].size() < colRows[jRare].size())
+          jRare = j;
+      }
+      const vector<int>& cands = colRows[jRare];
+      for (size_t c=0; c<cands.size() && nWork<nWorkMax; ++c) {
+        const int s = cands[c];
+        if (s==r || fRemoved[s] || EQ==rb.sense[s] || len[s]<len[r])
+          continue;
+        const int l0 = rb.rowStarts[s];
+        nWork += len[s];
+        int nCommon = 0;
+        for (int k=l0; k<l0+len[s]; ++k)
+          nCommon += (markR[rb.rmatind[k]] == r);
+        if (nCommon < len[r])
+          continue;
+        const double sgnS = (LQ==rb.sense[s]) ? 1.0 : -1.0;
+        /// An equality can be used with either sign
+        const double aSgnR[2] = { sgnS, -sgnS };
+        for (int t=0; t<2 && !fRemoved[s]; ++t) {
+          const double sgnR = aSgnR[t];
+          if (EQ!=rb.sense[r] && sgnR != ((LQ==rb.sense[r]) ? 1.0 : -1.0))
+            continue;
+          double maxAct = 0.0;
+          bool fMaxInf = false;
+          for (int k=l0; k<l0+len[s] && !fMaxInf; ++k) {
+            const int j = rb.rmatind[k];
+            const double d = sgnS*rb.rmatval[k] - (markR[j]==r ? sgnR*coefR[j] : 0.0);
+            if (0.0 == d)
+              continue;
+            const double bnd = d>0.0 ? colUB[j] : colLB[j];
+            if (fabs(bnd) >= dInf)
+              fMaxInf = true;
+            else
+              maxAct += d*bnd;
+          }
+          const double diffRhs = sgnS*rb.rhs[s] - sgnR*rb.rhs[r];
+          if (!fMaxInf && maxAct <= diffRhs + relTol(dRedTol, diffRhs)) {
+            fRemoved[s] = 1;
+            ++stats.nDominated;
+          }
+        }
+      }
+    }
+  }
+
+  /// Compact the buffer
+  RowBuffer rbNew;
+  for (int i=0; i<nRows; ++i) {
+    if (fRemoved[i])
+      continue;
+    const int k0 = rb.rowStarts[i];
+    rbNew.rmatind.insert(rbNew.rmatind.end(), rb.rmatind.begin()+k0, rb.rmatind.begin()+k0+len[i]);
+    rbNew.rmatval.insert(rbNew.rmatval.end(), rb.rmatval.begin()+k0, rb.rmatval.begin()+k0+len[i]);
+    rbNew.rowStarts.push_back(rbNew.rmatind.size());
+    rbNew.sense.push_back(rb.sense[i]);
+    rbNew.rhs.push_back(rb.rhs[i]);
+    rbNew.mask.push_back(rb.mask[i]);
+    rbNew.namePrefix.push_back(rb.namePrefix[i]);
+    rbNew.nameNum.push_back(rb.nameNum[i]);
+  }
+  rowBuffer = std::move(rbNew);
+  stats.nRowsAfter = rowBuffer.size();
+  stats.dTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  if (fVerbose)
+    cerr << "  MIP_wrapper: presolve removed " << (stats.nRowsBefore-stats.nRowsAfter)
+      << " of " << stats.nRowsBefore << " rows, tightened " << stats.nBounds
+      << " bounds in " << stats.nRounds << " rounds, "
+      << stats.dTime << " sec" << (fFeasible ? "" : ": INFEASIBLE") << endl;
+  return fFeasible;
+}
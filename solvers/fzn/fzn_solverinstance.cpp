@@ -17,10 +17,15 @@
 #define NOMINMAX     // Need this before all (implicit) include's of Windows.h
 #endif
 
-#include "minizinc/solvers/fzn_solverinstance.hh"
-const auto SolverInstance__ERROR = MiniZinc::SolverInstance::ERROR;  // before windows.h
+// Standard headers first: SafeInt, included by the MiniZinc headers, may
+// define nullptr as a macro, which breaks <thread> and <mutex>
 #include <cstdio>
 #include <fstream>
+#include <thread>
+#include <mutex>
+
+#include "minizinc/solvers/fzn_solverinstance.hh"
+const auto SolverInstance__ERROR = MiniZinc::SolverInstance::ERROR;  // before windows.h
 
 #include <minizinc/timer.hh>
 #include <minizinc/prettyprinter.hh>
@@ -41,8 +46,6 @@ const auto SolverInstance__ERROR = MiniZinc::SolverInstance::ERROR;  // before w
 #endif
 #include <sys/types.h>
 #include <signal.h>
-#include <thread>
-#include <mutex>
 
 using namespace std;
 
@@ -212,7 +215,7 @@ namespace MiniZinc {
           MoveFile(fznFile.c_str(), (fznFile + ".fzn").c_str());
           fznFile += ".fzn";
           std::ofstream os(fznFile);
-          Printer p(os, 0, true);
+          FznPrinter p(os, false);
           p.print(_flat);
         }
 
@@ -267,14 +270,14 @@ namespace MiniZinc {
 
         if (_canPipe) {
           DWORD dwWritten;
+          FznPrinter p;
           for (Model::iterator it = _flat->begin(); it != _flat->end(); ++it) {
-            if(!(*it)->removed()) {
-              std::stringstream ss;
-              Item* item = *it;
-              ss << *item;
-              std::string str = ss.str();
+            p.print(*it);
+            std::string& str = p.buffer();
+            if (str.size() >= (1<<16) || it+1 == _flat->end()) {
               bSuccess = WriteFile(g_hChildStd_IN_Wr, str.c_str(),
                   str.size(), &dwWritten, NULL);
+              str.clear();
             }
           }
         }
@@ -311,12 +314,8 @@ namespace MiniZinc {
           mkstemps(tmpfile, 4);
           fznFile = tmpfile;
           std::ofstream os(tmpfile);
-          for (Model::iterator it = _flat->begin(); it != _flat->end(); ++it) {
-            if(!(*it)->removed()) {
-              Item* item = *it;
-              os << *item;
-            }
-          }
+          FznPrinter p(os, false);
+          p.print(_flat);
         }
 
         // Make sure to reap child processes to avoid creating zombies
@@ -327,13 +326,13 @@ namespace MiniZinc {
           close(pipes[1][1]);
           close(pipes[2][1]);
           if (_canPipe) {
+            FznPrinter p;
             for (Model::iterator it = _flat->begin(); it != _flat->end(); ++it) {
-              if(!(*it)->removed()) {
-                std::stringstream ss;
-                Item* item = *it;
-                ss << *item;
-                std::string str = ss.str();
+              p.print(*it);
+              std::string& str = p.buffer();
+              if (str.size() >= (1<<16) || it+1 == _flat->end()) {
                 write(pipes[0][1], str.c_str(), str.size());
+                str.clear();
               }
             }
           }
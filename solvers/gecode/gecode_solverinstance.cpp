@@ -9,9 +9,13 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <thread>
+#include <algorithm>
+
 #include <minizinc/exception.hh>
 #include <minizinc/ast.hh>
 #include <minizinc/eval_par.hh>
+#include <minizinc/lns.hh>
 
 #include <minizinc/solvers/gecode_solverinstance.hh>
 #include <minizinc/solvers/gecode/gecode_constraints.hh>
@@ -72,6 +76,72 @@ namespace MiniZinc {
       int time = atoi(argv[i]);
       if(time >= 0)
         _options.setIntParam(std::string("time"), time);
+    } else if (string(argv[i])=="-p" || string(argv[i])=="--parallel") {
+      if (++i==argc) return false;
+      int threads = atoi(argv[i]);
+      if(threads >= 0)
+        _options.setIntParam(std::string("threads"), threads);
+    } else if (string(argv[i])=="--restart") {
+      if (++i==argc) return false;
+      string restart = argv[i];
+      if (restart=="none" || restart=="constant" || restart=="linear"
+          || restart=="luby" || restart=="geometric")
+        _options.setStringParam(std::string("restart"), restart);
+      else
+        std::cerr << "  Gecode: unknown restart strategy `" << restart << "', ignored" << std::endl;
+    } else if (string(argv[i])=="--restart-scale") {
+      if (++i==argc) return false;
+      int scale = atoi(argv[i]);
+      if(scale > 0)
+        _options.setIntParam(std::string("restart_scale"), scale);
+    } else if (string(argv[i])=="--restart-base") {
+      if (++i==argc) return false;
+      double base = atof(argv[i]);
+      if(base > 1.0)
+        _options.setFloatParam(std::string("restart_base"), base);
+    } else if (string(argv[i])=="--nogoods-limit") {
+      if (++i==argc) return false;
+      int limit = atoi(argv[i]);
+      if(limit >= 0)
+        _options.setIntParam(std::string("nogoods_limit"), limit);
+    } else if (string(argv[i])=="--lns") {
+      _options.setBoolParam(std::string("lns"), true);
+    } else if (string(argv[i])=="--lns-iterations") {
+      if (++i==argc) return false;
+      int iterations = atoi(argv[i]);
+      if(iterations >= 0)
+        _options.setIntParam(std::string("lns_iterations"), iterations);
+      _options.setBoolParam(std::string("lns"), true);
+    } else if (string(argv[i])=="--lns-time") {
+      if (++i==argc) return false;
+      int time = atoi(argv[i]);
+      if(time >= 0)
+        _options.setIntParam(std::string("lns_time"), time);
+      _options.setBoolParam(std::string("lns"), true);
+    } else if (string(argv[i])=="--lns-nodes") {
+      if (++i==argc) return false;
+      int nodes = atoi(argv[i]);
+      if(nodes >= 0)
+        _options.setIntParam(std::string("lns_nodes"), nodes);
+      _options.setBoolParam(std::string("lns"), true);
+    } else if (string(argv[i])=="--lns-iteration-time") {
+      if (++i==argc) return false;
+      int time = atoi(argv[i]);
+      if(time >= 0)
+        _options.setIntParam(std::string("lns_iteration_time"), time);
+      _options.setBoolParam(std::string("lns"), true);
+    } else if (string(argv[i])=="--lns-fix") {
+      if (++i==argc) return false;
+      int fix = atoi(argv[i]);
+      if(fix >= 0 && fix <= 100)
+        _options.setIntParam(std::string("lns_fix"), fix);
+      _options.setBoolParam(std::string("lns"), true);
+    } else if (string(argv[i])=="--lns-adapt") {
+      if (++i==argc) return false;
+      int adapt = atoi(argv[i]);
+      if(adapt >= 0 && adapt <= 100)
+        _options.setIntParam(std::string("lns_adapt"), adapt);
+      _options.setBoolParam(std::string("lns"), true);
     }
     return true;
   }
@@ -94,6 +164,31 @@ namespace MiniZinc {
     << "    failure cutoff (0 = none, solution mode)" << std::endl
     << "  --time <ms>" << std::endl
     << "    time (in ms) cutoff (0 = none, solution mode)" << std::endl
+    << "  -p <n>, --parallel <n>" << std::endl
+    << "    number of search threads (default 1, 0 = all cores); also used for sac/shaving" << std::endl
+    << "  --restart <type>" << std::endl
+    << "    restart-based search: none, constant, linear, luby, geometric (default none)" << std::endl
+    << "  --restart-scale <n>" << std::endl
+    << "    failures before the first restart, scaled by the sequence (default 250)" << std::endl
+    << "  --restart-base <f>" << std::endl
+    << "    growth factor of geometric restarts (default 1.5)" << std::endl
+    << "  --nogoods-limit <n>" << std::endl
+    << "    depth limit for no-goods recorded at restarts (0 = none, default)" << std::endl
+    << "  --lns" << std::endl
+    << "    large neighbourhood search for optimisation problems, also implied by the options below" << std::endl
+    << "  --lns-iterations <n>" << std::endl
+    << "    number of LNS iterations (0 = no limit, default)" << std::endl
+    << "  --lns-time <ms>" << std::endl
+    << "    total LNS time (0 = no limit, default)" << std::endl
+    << "  --lns-nodes <n>" << std::endl
+    << "    node limit per LNS iteration (default 1000, 0 = none)" << std::endl
+    << "  --lns-iteration-time <ms>" << std::endl
+    << "    time limit per LNS iteration (0 = none, default)" << std::endl
+    << "  --lns-fix <p>" << std::endl
+    << "    initial percentage of variables fixed to the incumbent (default 70," << std::endl
+    << "    or the percentage of a relax_and_reconstruct annotation)" << std::endl
+    << "  --lns-adapt <p>" << std::endl
+    << "    change of that percentage after an iteration without improvement (default 5)" << std::endl
     << std::endl;
   }
 
@@ -117,14 +212,16 @@ namespace MiniZinc {
   };
 
      GecodeSolverInstance::GecodeSolverInstance(Env& env, const Options& options)
-       : SolverInstanceImpl<GecodeSolver>(env,options), _current_space(NULL),
-       _solution(NULL), engine(NULL) {
+       : SolverInstanceImpl<GecodeSolver>(env,options), _branchers_posted(false),
+       _lns_printed(false), _interrupted(false), _current_space(NULL), _solution(NULL), _root_space(NULL),
+       engine(NULL) {
        registerConstraints();
        _flat = env.flat();
      }
 
     GecodeSolverInstance::~GecodeSolverInstance(void) {
       delete engine;
+      delete _root_space;
       //delete _current_space;
       // delete _solution; // TODO: is this necessary?
     }
@@ -921,6 +1018,7 @@ namespace MiniZinc {
   GecodeSolverInstance::next(void) {
     prepareEngine();
     
+    if (_solution) delete _solution;
     _solution = engine->next();
     
     if (_solution) {
@@ -935,7 +1033,58 @@ namespace MiniZinc {
 
   void
   GecodeSolverInstance::resetSolver(void) {
-    assert(false); // TODO: implement
+    delete engine;
+    engine = NULL;
+    delete engine_options.stop;
+    engine_options.stop = NULL;
+    postBranchers();
+    if (_root_space == NULL) {
+      // the first reset keeps the current space, which is still the root
+      if (_current_space->status() != SS_FAILED)
+        _root_space = static_cast<FznSpace*>(_current_space->clone());
+    } else if (_root_space->status() == SS_FAILED) {
+      // e.g. an objective bound which cannot be met
+      _current_space->fail();
+    } else {
+      delete _current_space;
+      _current_space = static_cast<FznSpace*>(_root_space->clone());
+    }
+  }
+
+  void
+  GecodeSolverInstance::resetWithConstraints(Model::iterator begin, Model::iterator end) {
+    resetSolver();
+    GCLock lock;
+    for (Model::iterator it = begin; it != end; ++it) {
+      if (ConstraintI* ci = (*it)->dyn_cast<ConstraintI>())
+        if (!ci->removed())
+          if (Call* c = ci->e()->dyn_cast<Call>())
+            _constraintRegistry.post(c);
+    }
+  }
+
+  void
+  GecodeSolverInstance::processPermanentConstraints(Model::iterator begin, Model::iterator end) {
+    // Post on the root copy, which the next reset starts from. Before the first
+    // reset the current space is the root.
+    FznSpace* current = _current_space;
+    if (_root_space != NULL)
+      _current_space = _root_space;
+    GCLock lock;
+    for (Model::iterator it = begin; it != end; ++it) {
+      if (ConstraintI* ci = (*it)->dyn_cast<ConstraintI>())
+        if (!ci->removed())
+          if (Call* c = ci->e()->dyn_cast<Call>())
+            _constraintRegistry.post(c);
+    }
+    _current_space = current;
+  }
+
+  void
+  GecodeSolverInstance::printSolution(void) {
+    // LNS prints each improving solution when it finds it
+    if (!_lns_printed)
+      SolverInstanceBase2::printSolution();
   }
 
   Expression*
@@ -961,9 +1110,8 @@ namespace MiniZinc {
   }
 
   void
-  GecodeSolverInstance::prepareEngine(void) {
-    if (engine==NULL) {
-      // TODO: check what we need to do options-wise
+  GecodeSolverInstance::postBranchers(void) {
+    if (!_branchers_posted) {
       std::vector<Expression*> branch_vars;
       std::vector<Expression*> solve_args;
       Expression* solveExpr = _flat->solveItem()->e();
@@ -1004,17 +1152,68 @@ namespace MiniZinc {
                       seed, decay,
                       false, /* ignoreUnknown */
                       std::cerr);
-      
+      _branchers_posted = true;
+    }
+  }
+
+  /// Stops the search when the solver instance has been interrupted, and
+  /// otherwise when one of the limits is reached
+  class InterruptStop : public Search::Stop {
+  public:
+    Driver::CombinedStop* limits;
+    const std::atomic<bool>& interrupted;
+    InterruptStop(Driver::CombinedStop* limits0, const std::atomic<bool>& interrupted0)
+      : limits(limits0), interrupted(interrupted0) {}
+    ~InterruptStop(void) { delete limits; }
+    virtual bool stop(const Search::Statistics& s, const Search::Options& o) {
+      return interrupted.load(std::memory_order_relaxed) ||
+        (limits != NULL && limits->stop(s, o));
+    }
+  };
+
+  void
+  GecodeSolverInstance::interrupt(void) {
+    _interrupted = true;
+  }
+
+  void
+  GecodeSolverInstance::prepareEngine(void) {
+    if (engine==NULL) {
+      // TODO: check what we need to do options-wise
+      postBranchers();
+
       int nodeStop = _options.getIntParam("nodes", 0);
       int failStop = _options.getIntParam("fails", 0);
       int timeStop = _options.getIntParam("time", 0);
 
-      engine_options.stop = Driver::CombinedStop::create(nodeStop,
-                                            failStop,
-                                            timeStop,
-                                            false);
-      // TODO: add presolving part
-      if(_current_space->_solveType == MiniZinc::SolveI::SolveType::ST_SAT) {
+      engine_options.stop = new InterruptStop(Driver::CombinedStop::create(nodeStop,
+                                                                           failStop,
+                                                                           timeStop,
+                                                                           false),
+                                              _interrupted);
+      engine_options.threads = _options.getIntParam("threads", 1);
+
+      std::string restart = _options.getStringParam("restart", "none");
+      unsigned int restartScale = _options.getIntParam("restart_scale", 250);
+      double restartBase = _options.getFloatParam("restart_base", 1.5);
+      if (restart == "constant")
+        engine_options.cutoff = Search::Cutoff::constant(restartScale);
+      else if (restart == "linear")
+        engine_options.cutoff = Search::Cutoff::linear(restartScale);
+      else if (restart == "luby")
+        engine_options.cutoff = Search::Cutoff::luby(restartScale);
+      else if (restart == "geometric")
+        engine_options.cutoff = Search::Cutoff::geometric(restartScale, restartBase);
+
+      if (engine_options.cutoff != NULL) {
+        // no-goods are only recorded by restart-based search
+        engine_options.nogoods_limit = _options.getIntParam("nogoods_limit", 0);
+        if(_current_space->_solveType == MiniZinc::SolveI::SolveType::ST_SAT) {
+          engine = new MetaEngine<DFS, RBS>(this->_current_space,engine_options);
+        } else {
+          engine = new MetaEngine<BAB, RBS>(this->_current_space,engine_options);
+        }
+      } else if(_current_space->_solveType == MiniZinc::SolveI::SolveType::ST_SAT) {
         engine = new MetaEngine<DFS, Driver::EngineToMeta>(this->_current_space,engine_options);
       } else {
         engine = new MetaEngine<BAB, Driver::EngineToMeta>(this->_current_space,engine_options);
@@ -1040,12 +1239,25 @@ namespace MiniZinc {
   SolverInstanceBase::Status
   GecodeSolverInstance::solve(void) {
 
-    prepareEngine();
-
+    // The engine copies the space when it is created, so presolve first
     if(_run_sac || _run_shave) {
       presolve();
     }
 
+    if (_options.getBoolParam("lns", false)
+        && _current_space->_solveType != MiniZinc::SolveI::SolveType::ST_SAT) {
+      LNS lns(*this);
+      _status = lns.run();
+      _lns_printed = lns.nSolutions > 0;
+      if (_print_stats) {
+        lns.printStatistics(std::cerr);
+        print_stats();
+      }
+      return _status;
+    }
+
+    prepareEngine();
+
     if (_current_space->_solveType == MiniZinc::SolveI::SolveType::ST_SAT) {
       _solution = engine->next();
     } else {
@@ -1061,10 +1273,13 @@ namespace MiniZinc {
         _status = SolverInstance::SAT;
       } else {
         if (engine->stopped()) {
-          Gecode::Search::Statistics stat = engine->statistics();
-          Driver::CombinedStop* cs = static_cast<Driver::CombinedStop*>(engine_options.stop);
-          int r = cs->reason(stat, engine_options);
-          if (r & Driver::CombinedStop::SR_INT)
+          Driver::CombinedStop* cs = static_cast<InterruptStop*>(engine_options.stop)->limits;
+          int r = 0;
+          if (!_interrupted && cs != NULL) {
+            Gecode::Search::Statistics stat = engine->statistics();
+            r = cs->reason(stat, engine_options);
+          }
+          if (_interrupted || cs == NULL || (r & Driver::CombinedStop::SR_INT))
             std::cerr << "user interrupt " << std::endl;
           else {
             if (r & Driver::CombinedStop::SR_NODE)
@@ -1111,6 +1326,51 @@ namespace MiniZinc {
       void init(const IntVar& x) {Int::IntVarImpBwd(x.varimp());}
   };
 
+  /// Collects in \a nq the values of bool variable \a idx of \a s which fail when probed
+  static void probeBoolVar(FznSpace& s, unsigned int idx, std::vector<int>& nq) {
+    BoolVar bvar = s.bv[idx];
+    for (int val = bvar.min(); val <= bvar.max(); ++val) {
+      FznSpace* f = static_cast<FznSpace*>(s.clone());
+      rel(*f, f->bv[idx], IRT_EQ, val);
+      if(f->status() == SS_FAILED)
+        nq.push_back(val);
+      delete f;
+    }
+  }
+
+  /// Collects in \a nq the values of int variable \a idx of \a s which fail when probed.
+  /// With \a shaving, only the bounds are probed
+  static void probeIntVar(FznSpace& s, unsigned int idx, bool shaving, std::vector<int>& nq) {
+    IntVar ivar = s.iv[idx];
+    bool tight = false;
+    int fwd_min = ivar.max()+1;
+    for (IntVarValues vv(ivar); vv() && !tight; ++vv) {
+      FznSpace* f = static_cast<FznSpace*>(s.clone());
+      rel(*f, f->iv[idx], IRT_EQ, vv.val());
+      if (f->status() == SS_FAILED) {
+        nq.push_back(vv.val());
+      } else {
+        fwd_min = vv.val();
+        tight = shaving;
+      }
+      delete f;
+    }
+    if(shaving) {
+      tight = false;
+      for (IntVarRangesBwd vr(ivar); vr() && !tight; ++vr) {
+        for (int i=vr.max(); i>=vr.min() && i>=fwd_min; i--) {
+          FznSpace* f = static_cast<FznSpace*>(s.clone());
+          rel(*f, f->iv[idx], IRT_EQ, i);
+          if (f->status() == SS_FAILED)
+            nq.push_back(i);
+          else
+            tight = true;
+          delete f;
+        }
+      }
+    }
+  }
+
   bool GecodeSolverInstance::sac(bool toFixedPoint = false, bool shaving = false) {
     if(_current_space->status() == SS_FAILED) return false;
     bool modified;
@@ -1120,61 +1380,76 @@ namespace MiniZinc {
     IntVarComp ivc(_current_space->iv);
     sort(sorted_iv.begin(), sorted_iv.end(), ivc);
 
+    // Probes are independent, so with several threads each one probes a share of
+    // the variables on its own copy of the space. Removals are applied after all
+    // threads are done; the next pass sees them.
+    unsigned int nThreads = _options.getIntParam("threads", 1);
+    if (nThreads == 0)
+      nThreads = std::max(1u, std::thread::hardware_concurrency());
+
     do {
       modified = false;
-      for (unsigned int idx = 0; idx < _current_space->bv.size(); idx++) {
-        BoolVar bvar = _current_space->bv[idx];
-        if(!bvar.assigned()) {
-          for (int val = bvar.min(); val <= bvar.max(); ++val) {
-            FznSpace* f = static_cast<FznSpace*>(_current_space->clone());
-            rel(*f, f->bv[idx], IRT_EQ, val);
-            if(f->status() == SS_FAILED) {
-              rel(*_current_space, bvar, IRT_NQ, val);
-              modified = true;
-              if(_current_space->status() == SS_FAILED)
-                return false;
-            }
-            delete f;
-          }
-        }
-      }
-
-      for (unsigned int i=0; i<sorted_iv.size(); i++) {
-        unsigned int idx = sorted_iv[i];
-        IntVar ivar = _current_space->iv[idx];
-        bool tight = false;
-        unsigned int nnq = 0;
-        int fwd_min;
-        IntArgs nq(ivar.size());
-        for (IntVarValues vv(ivar); vv() && !tight; ++vv) {
-          FznSpace* f = static_cast<FznSpace*>(_current_space->clone());
-          rel(*f, f->iv[idx], IRT_EQ, vv.val());
-          if (f->status() == SS_FAILED) {
-            nq[nnq++] = vv.val();
+      std::vector<unsigned int> bvars;
+      for (unsigned int idx = 0; idx < _current_space->bv.size(); idx++)
+        if(!_current_space->bv[idx].assigned())
+          bvars.push_back(idx);
+      std::vector<unsigned int> ivars;
+      for (unsigned int i=0; i<sorted_iv.size(); i++)
+        if(!_current_space->iv[sorted_iv[i]].assigned())
+          ivars.push_back(sorted_iv[i]);
+      const unsigned int nVars = bvars.size() + ivars.size();
+
+      if (nThreads <= 1 || nVars <= 1) {
+        for (unsigned int k=0; k<nVars; k++) {
+          std::vector<int> nq;
+          if (k < bvars.size()) {
+            probeBoolVar(*_current_space, bvars[k], nq);
+            for (int val : nq)
+              rel(*_current_space, _current_space->bv[bvars[k]], IRT_NQ, val);
           } else {
-            fwd_min = vv.val();
-            tight = shaving;
+            probeIntVar(*_current_space, ivars[k-bvars.size()], shaving, nq);
+            for (int val : nq)
+              rel(*_current_space, _current_space->iv[ivars[k-bvars.size()]], IRT_NQ, val);
+          }
+          if(!nq.empty()) {
+            modified = true;
+            if(_current_space->status() == SS_FAILED)
+              return false;
           }
-          delete f;
         }
-        if(shaving) {
-          tight = false;
-          for (IntVarRangesBwd vr(ivar); vr() && !tight; ++vr) {
-            for (int i=vr.max(); i>=vr.min() && i>=fwd_min; i--) {
-              FznSpace* f = static_cast<FznSpace*>(_current_space->clone());
-              rel(*f, f->iv[idx], IRT_EQ, i);
-              if (f->status() == SS_FAILED)
-                nq[nnq++] = i;
+      } else {
+        const unsigned int nWorkers = std::min(nThreads, nVars);
+        // Copies are made here: cloning one space from several threads is not safe
+        std::vector<FznSpace*> copies(nWorkers);
+        for (unsigned int w=0; w<nWorkers; w++)
+          copies[w] = static_cast<FznSpace*>(_current_space->clone(false));
+        std::vector<std::vector<int> > nq(nVars);
+        std::vector<std::thread> workers;
+        for (unsigned int w=0; w<nWorkers; w++) {
+          workers.push_back(std::thread([&, w]() {
+            for (unsigned int k=w; k<nVars; k+=nWorkers) {
+              if (k < bvars.size())
+                probeBoolVar(*copies[w], bvars[k], nq[k]);
               else
-                tight = true;
-              delete f;
+                probeIntVar(*copies[w], ivars[k-bvars.size()], shaving, nq[k]);
             }
+          }));
+        }
+        for (auto& t : workers)
+          t.join();
+        for (unsigned int w=0; w<nWorkers; w++)
+          delete copies[w];
+
+        for (unsigned int k=0; k<nVars; k++) {
+          for (int val : nq[k]) {
+            modified = true;
+            if (k < bvars.size())
+              rel(*_current_space, _current_space->bv[bvars[k]], IRT_NQ, val);
+            else
+              rel(*_current_space, _current_space->iv[ivars[k-bvars.size()]], IRT_NQ, val);
           }
         }
-        if(nnq) modified = true;
-        while (nnq--)
-          rel(*_current_space, ivar, IRT_NQ, nq[nnq]);
-        if (_current_space->status() == SS_FAILED)
+        if(_current_space->status() == SS_FAILED)
           return false;
       }
     } while(toFixedPoint && modified);
@@ -4,5 +4,13 @@ export PATH="$(pwd)/..":"$(pwd)/scripts":"$PATH"
 export MZN_STDLIB_DIR="$(pwd)/../share/minizinc"
 run-tests mzn20_fd .mzn unit examples
 run-tests mzn-fzn_fd .mzn unit examples
+run-tests mzn-mip-file_mps .mzn unit
+run-tests mzn-mip-file_lp .mzn unit
+run-tests mzn-mip-file_fzb .mzn unit
+run-tests mzn-mip-file_presolve .fzn unit
+run-tests solns2out_canon_spill .mzn unit
 #run-tests mzn20_fd_linear .mzn unit examples
+#run-tests mzn-cbc_portfolio .mzn unit
+#run-tests mzn-cbc_warmstart .mzn unit
+#run-tests mzn-gecode .mzn unit
 #exec run-tests mzn20_mip .mzn unit examples
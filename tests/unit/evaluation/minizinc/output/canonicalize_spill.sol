@@ -0,0 +1,901 @@
+x = 60;
+y = 2;
+----------
+x = 34;
+y = 4;
+----------
+x = 6;
+y = 2;
+----------
+x = 57;
+y = 3;
+----------
+x = 53;
+y = 7;
+----------
+x = 98;
+y = 7;
+----------
+x = 36;
+y = 9;
+----------
+x = 67;
+y = 3;
+----------
+x = 92;
+y = 7;
+----------
+x = 7;
+y = 0;
+----------
+x = 38;
+y = 8;
+----------
+x = 18;
+y = 8;
+----------
+x = 77;
+y = 8;
+----------
+x = 94;
+y = 2;
+----------
+x = 40;
+y = 3;
+----------
+x = 72;
+y = 7;
+----------
+x = 90;
+y = 1;
+----------
+x = 39;
+y = 0;
+----------
+x = 72;
+y = 7;
+----------
+x = 12;
+y = 3;
+----------
+x = 28;
+y = 1;
+----------
+x = 3;
+y = 5;
+----------
+x = 91;
+y = 7;
+----------
+x = 82;
+y = 8;
+----------
+x = 6;
+y = 6;
+----------
+x = 51;
+y = 8;
+----------
+x = 78;
+y = 0;
+----------
+x = 15;
+y = 2;
+----------
+x = 13;
+y = 5;
+----------
+x = 63;
+y = 1;
+----------
+x = 94;
+y = 1;
+----------
+x = 95;
+y = 6;
+----------
+x = 76;
+y = 9;
+----------
+x = 88;
+y = 0;
+----------
+x = 73;
+y = 7;
+----------
+x = 86;
+y = 3;
+----------
+x = 79;
+y = 7;
+----------
+x = 23;
+y = 1;
+----------
+x = 52;
+y = 9;
+----------
+x = 33;
+y = 6;
+----------
+x = 75;
+y = 9;
+----------
+x = 60;
+y = 2;
+----------
+x = 65;
+y = 2;
+----------
+x = 28;
+y = 3;
+----------
+x = 72;
+y = 8;
+----------
+x = 62;
+y = 8;
+----------
+x = 40;
+y = 9;
+----------
+x = 62;
+y = 2;
+----------
+x = 8;
+y = 7;
+----------
+x = 54;
+y = 0;
+----------
+x = 74;
+y = 5;
+----------
+x = 82;
+y = 5;
+----------
+x = 44;
+y = 3;
+----------
+x = 51;
+y = 8;
+----------
+x = 89;
+y = 2;
+----------
+x = 13;
+y = 9;
+----------
+x = 5;
+y = 4;
+----------
+x = 50;
+y = 7;
+----------
+x = 64;
+y = 7;
+----------
+x = 48;
+y = 2;
+----------
+x = 97;
+y = 9;
+----------
+x = 62;
+y = 3;
+----------
+x = 85;
+y = 0;
+----------
+x = 80;
+y = 1;
+----------
+x = 15;
+y = 9;
+----------
+x = 15;
+y = 6;
+----------
+x = 76;
+y = 6;
+----------
+x = 4;
+y = 0;
+----------
+x = 80;
+y = 9;
+----------
+x = 62;
+y = 4;
+----------
+x = 36;
+y = 3;
+----------
+x = 77;
+y = 4;
+----------
+x = 80;
+y = 1;
+----------
+x = 18;
+y = 9;
+----------
+x = 33;
+y = 7;
+----------
+x = 62;
+y = 3;
+----------
+x = 31;
+y = 3;
+----------
+x = 59;
+y = 6;
+----------
+x = 59;
+y = 7;
+----------
+x = 41;
+y = 5;
+----------
+x = 6;
+y = 6;
+----------
+x = 52;
+y = 2;
+----------
+x = 74;
+y = 2;
+----------
+x = 58;
+y = 5;
+----------
+x = 74;
+y = 6;
+----------
+x = 15;
+y = 6;
+----------
+x = 63;
+y = 1;
+----------
+x = 10;
+y = 9;
+----------
+x = 38;
+y = 9;
+----------
+x = 87;
+y = 8;
+----------
+x = 45;
+y = 1;
+----------
+x = 87;
+y = 8;
+----------
+x = 73;
+y = 3;
+----------
+x = 32;
+y = 7;
+----------
+x = 45;
+y = 1;
+----------
+x = 98;
+y = 2;
+----------
+x = 11;
+y = 2;
+----------
+x = 3;
+y = 5;
+----------
+x = 64;
+y = 7;
+----------
+x = 79;
+y = 1;
+----------
+x = 66;
+y = 5;
+----------
+x = 83;
+y = 9;
+----------
+x = 84;
+y = 4;
+----------
+x = 89;
+y = 4;
+----------
+x = 72;
+y = 1;
+----------
+x = 34;
+y = 3;
+----------
+x = 53;
+y = 7;
+----------
+x = 94;
+y = 1;
+----------
+x = 90;
+y = 8;
+----------
+x = 7;
+y = 6;
+----------
+x = 13;
+y = 9;
+----------
+x = 31;
+y = 9;
+----------
+x = 50;
+y = 1;
+----------
+x = 23;
+y = 1;
+----------
+x = 11;
+y = 8;
+----------
+x = 95;
+y = 8;
+----------
+x = 36;
+y = 3;
+----------
+x = 40;
+y = 1;
+----------
+x = 3;
+y = 1;
+----------
+x = 17;
+y = 8;
+----------
+x = 96;
+y = 2;
+----------
+x = 96;
+y = 9;
+----------
+x = 68;
+y = 9;
+----------
+x = 10;
+y = 9;
+----------
+x = 72;
+y = 2;
+----------
+x = 30;
+y = 0;
+----------
+x = 67;
+y = 3;
+----------
+x = 85;
+y = 1;
+----------
+x = 6;
+y = 7;
+----------
+x = 39;
+y = 8;
+----------
+x = 0;
+y = 1;
+----------
+x = 5;
+y = 5;
+----------
+x = 67;
+y = 6;
+----------
+x = 11;
+y = 7;
+----------
+x = 30;
+y = 2;
+----------
+x = 45;
+y = 4;
+----------
+x = 85;
+y = 2;
+----------
+x = 27;
+y = 8;
+----------
+x = 49;
+y = 0;
+----------
+x = 10;
+y = 3;
+----------
+x = 55;
+y = 0;
+----------
+x = 89;
+y = 7;
+----------
+x = 40;
+y = 7;
+----------
+x = 20;
+y = 2;
+----------
+x = 66;
+y = 6;
+----------
+x = 63;
+y = 4;
+----------
+x = 37;
+y = 4;
+----------
+x = 93;
+y = 0;
+----------
+x = 9;
+y = 5;
+----------
+x = 89;
+y = 4;
+----------
+x = 38;
+y = 8;
+----------
+x = 60;
+y = 0;
+----------
+x = 3;
+y = 1;
+----------
+x = 98;
+y = 4;
+----------
+x = 4;
+y = 1;
+----------
+x = 36;
+y = 9;
+----------
+x = 18;
+y = 9;
+----------
+x = 73;
+y = 7;
+----------
+x = 0;
+y = 3;
+----------
+x = 40;
+y = 7;
+----------
+x = 7;
+y = 7;
+----------
+x = 69;
+y = 2;
+----------
+x = 96;
+y = 2;
+----------
+x = 56;
+y = 1;
+----------
+x = 54;
+y = 0;
+----------
+x = 55;
+y = 0;
+----------
+x = 47;
+y = 6;
+----------
+x = 85;
+y = 0;
+----------
+x = 77;
+y = 8;
+----------
+x = 37;
+y = 4;
+----------
+x = 79;
+y = 9;
+----------
+x = 73;
+y = 0;
+----------
+x = 77;
+y = 9;
+----------
+x = 17;
+y = 5;
+----------
+x = 24;
+y = 7;
+----------
+x = 31;
+y = 3;
+----------
+x = 82;
+y = 8;
+----------
+x = 32;
+y = 2;
+----------
+x = 20;
+y = 3;
+----------
+x = 9;
+y = 5;
+----------
+x = 38;
+y = 6;
+----------
+x = 37;
+y = 7;
+----------
+x = 98;
+y = 4;
+----------
+x = 25;
+y = 3;
+----------
+x = 90;
+y = 4;
+----------
+x = 12;
+y = 3;
+----------
+x = 4;
+y = 7;
+----------
+x = 39;
+y = 2;
+----------
+x = 20;
+y = 8;
+----------
+x = 75;
+y = 9;
+----------
+x = 18;
+y = 7;
+----------
+x = 25;
+y = 3;
+----------
+x = 31;
+y = 9;
+----------
+x = 13;
+y = 8;
+----------
+x = 84;
+y = 8;
+----------
+x = 85;
+y = 1;
+----------
+x = 47;
+y = 0;
+----------
+x = 96;
+y = 9;
+----------
+x = 94;
+y = 2;
+----------
+x = 49;
+y = 0;
+----------
+x = 28;
+y = 1;
+----------
+x = 13;
+y = 8;
+----------
+x = 18;
+y = 7;
+----------
+x = 47;
+y = 1;
+----------
+x = 36;
+y = 5;
+----------
+x = 52;
+y = 8;
+----------
+x = 59;
+y = 6;
+----------
+x = 36;
+y = 5;
+----------
+x = 11;
+y = 1;
+----------
+x = 40;
+y = 3;
+----------
+x = 20;
+y = 8;
+----------
+x = 34;
+y = 3;
+----------
+x = 24;
+y = 0;
+----------
+x = 58;
+y = 8;
+----------
+x = 3;
+y = 2;
+----------
+x = 79;
+y = 4;
+----------
+x = 65;
+y = 2;
+----------
+x = 56;
+y = 9;
+----------
+x = 15;
+y = 5;
+----------
+x = 90;
+y = 4;
+----------
+x = 98;
+y = 1;
+----------
+x = 55;
+y = 7;
+----------
+x = 18;
+y = 2;
+----------
+x = 33;
+y = 9;
+----------
+x = 33;
+y = 9;
+----------
+x = 4;
+y = 1;
+----------
+x = 58;
+y = 2;
+----------
+x = 64;
+y = 9;
+----------
+x = 60;
+y = 0;
+----------
+x = 67;
+y = 7;
+----------
+x = 41;
+y = 5;
+----------
+x = 19;
+y = 4;
+----------
+x = 73;
+y = 0;
+----------
+x = 81;
+y = 1;
+----------
+x = 82;
+y = 1;
+----------
+x = 3;
+y = 2;
+----------
+x = 30;
+y = 8;
+----------
+x = 6;
+y = 2;
+----------
+x = 40;
+y = 1;
+----------
+x = 39;
+y = 0;
+----------
+x = 40;
+y = 0;
+----------
+x = 11;
+y = 8;
+----------
+x = 58;
+y = 2;
+----------
+x = 29;
+y = 0;
+----------
+x = 79;
+y = 4;
+----------
+x = 38;
+y = 9;
+----------
+x = 5;
+y = 8;
+----------
+x = 84;
+y = 4;
+----------
+x = 50;
+y = 1;
+----------
+x = 23;
+y = 4;
+----------
+x = 60;
+y = 9;
+----------
+x = 76;
+y = 6;
+----------
+x = 39;
+y = 8;
+----------
+x = 20;
+y = 3;
+----------
+x = 47;
+y = 6;
+----------
+x = 48;
+y = 2;
+----------
+x = 45;
+y = 4;
+----------
+x = 40;
+y = 0;
+----------
+x = 90;
+y = 9;
+----------
+x = 2;
+y = 3;
+----------
+x = 72;
+y = 2;
+----------
+x = 82;
+y = 5;
+----------
+x = 62;
+y = 8;
+----------
+x = 34;
+y = 4;
+----------
+x = 67;
+y = 1;
+----------
+x = 76;
+y = 7;
+----------
+x = 4;
+y = 0;
+----------
+x = 95;
+y = 8;
+----------
+x = 2;
+y = 3;
+----------
+x = 65;
+y = 4;
+----------
+x = 54;
+y = 2;
+----------
+x = 79;
+y = 3;
+----------
+x = 27;
+y = 8;
+----------
+x = 74;
+y = 2;
+----------
+x = 58;
+y = 8;
+----------
+x = 7;
+y = 8;
+----------
+x = 60;
+y = 9;
+----------
+x = 87;
+y = 7;
+----------
+x = 19;
+y = 4;
+----------
+x = 83;
+y = 1;
+----------
+x = 25;
+y = 4;
+----------
+x = 34;
+y = 5;
+----------
+x = 7;
+y = 0;
+----------
+x = 15;
+y = 5;
+----------
+x = 41;
+y = 3;
+----------
+x = 5;
+y = 8;
+----------
+x = 71;
+y = 3;
+----------
+x = 71;
+y = 3;
+----------
+x = 28;
+y = 6;
+----------
+x = 39;
+y = 3;
+----------
+x = 7;
+y = 6;
+----------
+x = 93;
+y = 0;
+----------
+x = 98;
+y = 7;
+----------
+x = 86;
+y = 3;
+----------
+x = 15;
+y = 9;
+----------
+x = 66;
+y = 5;
+----------
+x = 90;
+y = 9;
+----------
+x = 30;
+y = 0;
+----------
+x = 32;
+y = 1;
+----------
+x = 55;
+y = 5;
+----------
+==========